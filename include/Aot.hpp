@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "BlockCache.hpp"
+#include "Decoder.hpp"
+#include "PerfCounters.hpp"
+#include "Quirks.hpp"
+
+namespace chip8
+{
+    class Chip8;
+
+    /**
+     * @struct AotContext
+     * @brief Machine state handed to ahead-of-time compiled blocks.
+     * Registers are accessed in place; everything else (drawing, keys,
+     * timers, memory writes) goes through the handler tables of the chip.
+     */
+    struct AotContext
+    {
+        Chip8 *chip = nullptr;
+        std::uint8_t *V = nullptr;
+        std::uint16_t *I = nullptr;
+        std::uint16_t *pc = nullptr;
+        std::uint64_t *cycles = nullptr;
+        const MicroHandler *handlers = nullptr;     ///< Handlers advancing pc, for the last instruction.
+        const MicroHandler *bodyHandlers = nullptr; ///< Handlers leaving pc alone, for the others.
+    };
+
+    /**
+     * @brief Compiled basic block.
+     * Runs every instruction of the block, leaves pc at the next one and
+     * adds the instructions to the cycle count.
+     */
+    using AotFunction = void (*)(AotContext &);
+
+    /**
+     * @struct AotBlock
+     * @brief Basic block of a ROM compiled to a C++ function by chip8_aot.
+     * Blocks end where the translated blocks of BlockCache end.
+     */
+    struct AotBlock
+    {
+        AotFunction function;
+        std::uint16_t start;  ///< Guest address of the first instruction.
+        std::uint16_t end;    ///< Guest address after the last instruction.
+        std::uint16_t length; ///< Number of instructions.
+        const FamilyCount *families;
+        std::uint8_t familyCount;
+    };
+
+    /**
+     * @struct AotProgram
+     * @brief All blocks compiled from one ROM for one profile.
+     * Generated sources register their program at static initialisation.
+     */
+    struct AotProgram
+    {
+        const char *name;          ///< ROM file name.
+        Profile profile;           ///< Quirks the native code was generated for.
+        std::uint64_t romHash;     ///< HashRom of the ROM.
+        const std::uint8_t *rom;   ///< ROM contents the blocks were compiled from.
+        std::uint16_t romSize;
+        const AotBlock *blocks;
+        std::uint16_t blockCount;
+    };
+
+    /**
+     * @brief Registers a compiled program with Engine::Aot.
+     * @param program Program, must outlive every chip (generated programs are static).
+     * @return true, so generated code can register from a static initialiser.
+     */
+    bool RegisterAotProgram(const AotProgram &program);
+
+    /**
+     * @brief Returns the program compiled from a ROM for a profile.
+     * @param romHash HashRom of the loaded ROM.
+     * @param profile Quirk profile of the chip.
+     * @return Program or nullptr.
+     */
+    const AotProgram *FindAotProgram(std::uint64_t romHash, Profile profile);
+
+    /**
+     * @brief Returns the number of registered programs.
+     */
+    std::size_t GetAotProgramCount();
+
+    /**
+     * @brief Runs an instruction through the handler that leaves pc alone.
+     * Called by generated code for everything it doesn't inline.
+     */
+    inline void AotCall(AotContext &context, const Instruction &instruction)
+    {
+        context.bodyHandlers[static_cast<std::size_t>(instruction.op)](*context.chip, instruction);
+    }
+
+    /**
+     * @brief Runs the last instruction of a block through the handler that updates pc.
+     */
+    inline void AotStep(AotContext &context, const Instruction &instruction)
+    {
+        context.handlers[static_cast<std::size_t>(instruction.op)](*context.chip, instruction);
+    }
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Decoder.hpp"
+#include "FrameBuffer.hpp"
+
+namespace chip8
+{
+    class Chip8;
+
+    /**
+     * @struct BatchStats
+     * @brief Lane utilisation of a batch.
+     * A step executes one instruction for every lane in the group sharing
+     * the scheduled pc; the other lanes idle during that step.
+     */
+    struct BatchStats
+    {
+        std::uint64_t steps = 0;        ///< Instructions issued (one per lane group).
+        std::uint64_t laneCycles = 0;   ///< Instructions retired, summed over lanes.
+        std::uint64_t denseSteps = 0;   ///< Steps run by the full-width vector kernels.
+        std::uint64_t scalarSteps = 0;  ///< Steps run lane by lane.
+
+        /**
+         * @brief Returns the mean fraction of lanes active per step.
+         * @param lanes Number of lanes in the batch.
+         */
+        double Occupancy(std::size_t lanes) const
+        {
+            return steps == 0 ? 0.0 : static_cast<double>(laneCycles) / (static_cast<double>(steps) * lanes);
+        }
+    };
+
+    /**
+     * @class BatchChip8
+     * @brief Runs many copies of one ROM in lockstep.
+     * Machine state is stored as struct-of-arrays (register x of every lane
+     * is contiguous, and so are pc, I, timers and every framebuffer row),
+     * so an instruction shared by many lanes runs as one vectorizable loop.
+     * Each step issues the instruction at the lowest pc among runnable lanes
+     * to all lanes at that pc; lanes behind a branch therefore catch up and
+     * reconverge. Small groups, and operations touching memory, the stack or
+     * the screen, run lane by lane. Semantics match Chip8::emulateCycle
+     * with Profile::Modern, including memory accesses wrapping at 4 KB;
+     * lanes that would throw there, or overflow or underflow the stack, are
+     * stopped with a fault instead and the rest of the batch continues.
+     */
+    class BatchChip8
+    {
+    public:
+        /**
+         * @brief Groups smaller than lanes / SCALAR_RATIO run lane by lane.
+         */
+        static constexpr std::size_t SCALAR_RATIO = 8;
+
+        /**
+         * @brief Constructor for the BatchChip8 class.
+         * @param lanes Number of machines, must be positive.
+         */
+        explicit BatchChip8(std::size_t lanes);
+
+        /**
+         * @brief Resets every lane to the power-on state of Chip8.
+         */
+        void reset();
+
+        /**
+         * @brief Resets every lane and loads the same ROM into all of them.
+         * @param data ROM bytes.
+         * @param size Number of bytes, at most 4096 - 512.
+         */
+        void loadROM(const std::uint8_t *data, std::size_t size);
+
+        /**
+         * @brief Runs every lane that has not faulted for count more cycles.
+         * @param count Cycles per lane.
+         * @return Number of instructions retired, summed over lanes.
+         */
+        std::uint64_t emulateCycles(std::uint64_t count);
+
+        /**
+         * @brief Sets the emulated CPU clock of all lanes, see IChip::SetClockRate.
+         * @param instructionsPerSecond Clock rate, must be positive.
+         */
+        void SetClockRate(std::uint32_t instructionsPerSecond);
+
+        /**
+         * @brief Seeds the random generator of a lane, see IChip::SetSeed.
+         * @param lane Lane index.
+         * @param seed Any value; lanes start with DEFAULT_SEED.
+         */
+        void SetLaneSeed(std::size_t lane, std::uint64_t seed);
+
+        /**
+         * @brief Sets the keys held on a lane, bit k for key k.
+         */
+        void SetLaneKeys(std::size_t lane, std::uint16_t keys);
+
+        /**
+         * @brief Returns the number of lanes.
+         */
+        std::size_t GetLaneCount() const;
+
+        /**
+         * @brief Returns register x of a lane.
+         */
+        std::uint8_t GetRegister(std::size_t lane, std::uint8_t x) const;
+
+        /**
+         * @brief Returns the address register of a lane.
+         */
+        std::uint16_t GetI(std::size_t lane) const;
+
+        /**
+         * @brief Returns the program counter of a lane.
+         */
+        std::uint16_t GetPC(std::size_t lane) const;
+
+        /**
+         * @brief Returns the number of cycles a lane executed since the last reset.
+         */
+        std::uint64_t GetCycleCount(std::size_t lane) const;
+
+        /**
+         * @brief Returns the 4 kB memory of a lane.
+         */
+        const std::uint8_t *GetMemory(std::size_t lane) const;
+
+        /**
+         * @brief Copies the screen of a lane.
+         * @param lane Lane index.
+         * @param frame Receives the packed rows.
+         */
+        void CopyGfx(std::size_t lane, FrameBuffer &frame) const;
+
+        /**
+         * @brief Returns the error that stopped a lane, empty while it runs.
+         */
+        const std::string &GetFault(std::size_t lane) const;
+
+        /**
+         * @brief Returns the number of lanes stopped by a fault.
+         */
+        std::size_t GetFaultCount() const;
+
+        /**
+         * @brief Returns the utilisation counters since construction.
+         */
+        const BatchStats &GetStats() const;
+
+    private:
+        static constexpr std::size_t MEMORY_SIZE = 4096;
+
+        /**
+         * @brief Copies the state of a single machine into every lane.
+         */
+        void assign(const Chip8 &prototype);
+
+        /**
+         * @brief Selects the lanes at the lowest runnable pc.
+         * @return false when no lane is runnable.
+         */
+        bool schedule();
+
+        /**
+         * @brief Executes one instruction for the scheduled lanes.
+         */
+        void execute(const Instruction &in);
+
+        /**
+         * @brief Runs body(lane) for each scheduled lane.
+         */
+        template <typename Body>
+        void forScheduled(Body body);
+
+        /**
+         * @brief Runs body(lane, active) over all lanes when the group is
+         * large, where the loop is branch-free and vectorizable, and over the
+         * scheduled lanes only otherwise.
+         */
+        template <typename Body>
+        void forLanes(Body body);
+
+        void fault(std::size_t lane, const std::string &message);
+        void writeMemory(std::size_t lane, std::uint32_t address, std::uint8_t value);
+        std::uint64_t timerTicks(std::size_t lane) const;
+        std::uint8_t timerValue(std::size_t lane, std::uint8_t value, std::uint64_t setAt) const;
+
+        std::size_t lanes;
+        std::uint32_t clockRate;
+
+        std::vector<std::uint8_t> memory;   ///< Lane-major, MEMORY_SIZE bytes per lane.
+        std::vector<std::uint8_t> V;        ///< V[x * lanes + lane].
+        std::vector<std::uint16_t> I;
+        std::vector<std::uint16_t> pc;
+        std::vector<std::uint16_t> stack;   ///< stack[level * lanes + lane].
+        std::vector<std::uint8_t> sp;
+        std::vector<std::uint8_t> delayTimer;
+        std::vector<std::uint8_t> soundTimer;
+        std::vector<std::uint64_t> delayTimerSetAt;
+        std::vector<std::uint64_t> soundTimerSetAt;
+        std::vector<std::uint64_t> timerTickBase;
+        std::vector<std::uint64_t> timerCycleBase;
+        std::vector<std::uint64_t> gfx;     ///< gfx[row * lanes + lane].
+        std::vector<std::uint16_t> keys;
+        std::vector<std::uint32_t> rngState;   ///< rngState[word * lanes + lane].
+        std::vector<std::uint64_t> cycles;
+        std::vector<std::uint64_t> target;   ///< Cycle count each lane runs to in emulateCycles.
+        std::vector<std::uint8_t> halted;    ///< 1 for lanes stopped by a fault.
+        std::vector<std::uint8_t> memoryWritten;
+        std::vector<std::string> faults;
+        std::size_t faultCount = 0;
+        std::size_t stepFaults = 0;
+        bool anyMemoryWritten = false;
+
+        std::vector<std::uint8_t> mask;        ///< 1 for lanes in the scheduled group.
+        std::vector<std::uint32_t> scheduled;  ///< Indices of the scheduled lanes.
+        std::size_t scheduledCount = 0;
+        std::size_t leader = 0;                ///< First lane of the scheduled group.
+        std::uint64_t groupBudget = 0;         ///< Cycles every lane of the group has left.
+        bool converged = false;                ///< The group holds every runnable lane.
+        bool dense = false;
+
+        BatchStats stats;
+    };
+}
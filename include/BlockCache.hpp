@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Decoder.hpp"
+#include "GuestMemory.hpp"
+#include "PerfCounters.hpp"
+
+namespace chip8
+{
+    class Chip8;
+
+    /**
+     * @brief Handler executing one micro-op of a translated block.
+     */
+    using MicroHandler = void (*)(Chip8 &, const Instruction &);
+
+    /**
+     * @struct MicroOp
+     * @brief Decoded instruction with its handler already resolved.
+     * Only the last micro-op of a block advances pc.
+     */
+    struct MicroOp
+    {
+        MicroHandler handler;
+        Instruction instruction;
+    };
+
+    /**
+     * @struct Block
+     * @brief Straight-line run of instructions ending at a control transfer.
+     */
+    struct Block
+    {
+        std::uint32_t first = 0;  ///< Index of the first micro-op in the pool.
+        std::uint16_t length = 0; ///< Number of micro-ops.
+        std::uint16_t start = 0;  ///< Guest address of the first instruction.
+        std::uint16_t end = 0;    ///< Guest address after the last instruction.
+        std::uint32_t firstFamily = 0; ///< Index of the first family count in the pool.
+        std::uint8_t familyCount = 0;  ///< Number of family counts.
+        bool live = false;        ///< Cleared when guest code under the block changes.
+    };
+
+    /**
+     * @brief Checks if an operation terminates a basic block.
+     * Jumps, calls, returns, skips, FX0A and invalid opcodes end a block.
+     * FX33/FX55 end it as well, so a write into the running block never
+     * leaves stale micro-ops to execute, and so do the timer operations,
+     * which need the exact cycle count.
+     * @param op Decoded operation.
+     * @return true if no instruction may follow op inside the same block.
+     */
+    bool EndsBlock(Op op);
+
+    /**
+     * @brief Checks if an operation reads or writes the delay/sound timers.
+     * Timer values are derived from the cycle count, so these operations
+     * must run when the cycles of all preceding instructions are counted.
+     * @param op Decoded operation.
+     * @return true for FX07, FX15 and FX18.
+     */
+    bool UsesTimers(Op op);
+
+    /**
+     * @class BlockCache
+     * @brief Translation cache of basic blocks keyed by guest address.
+     * Tracks which memory bytes are covered by translated code so writes into
+     * code drop the affected blocks.
+     */
+    class BlockCache
+    {
+    public:
+        /**
+         * @brief Longest block translated, in instructions.
+         */
+        static constexpr std::uint16_t MAX_BLOCK_LENGTH = 64;
+
+        /**
+         * @brief Micro-op pool size; the cache is flushed when it fills up.
+         */
+        static constexpr std::size_t MAX_MICRO_OPS = 1 << 16;
+
+        /**
+         * @brief Constructor for the BlockCache class.
+         * @param memorySize Size of the guest memory in bytes.
+         */
+        explicit BlockCache(std::size_t memorySize);
+
+        /**
+         * @brief Returns the live block starting at pc.
+         * @param pc Guest address.
+         * @return Block or nullptr if none is cached.
+         */
+        const Block *Find(std::uint16_t pc) const
+        {
+            const std::int32_t index = lookup[pc];
+            return index < 0 ? nullptr : &blocks[index];
+        }
+
+        /**
+         * @brief Checks if the instruction at pc is left to the interpreter.
+         * Set by Translate for blocks of a single instruction.
+         */
+        bool IsInterpreted(std::uint16_t pc) const
+        {
+            return lookup[pc] == INTERPRETED;
+        }
+
+        /**
+         * @brief Translates the block starting at pc.
+         * A block of one instruction, a control transfer on its own, is
+         * not kept: its dispatch would cost more than the decode it saves.
+         * @param memory Guest memory.
+         * @param pc Guest address, pc + 1 must be inside memory.
+         * @param handlers Handler table indexed by Op, used for the last micro-op.
+         * @param bodyHandlers Handlers that do not advance pc, used for the others.
+         * @return Newly translated block, nullptr if pc is left to the interpreter.
+         */
+        const Block *Translate(const GuestMemory &memory, std::uint16_t pc,
+                               const MicroHandler *handlers, const MicroHandler *bodyHandlers);
+
+        /**
+         * @brief Returns the micro-ops of a block.
+         */
+        const MicroOp *Ops(const Block &block) const
+        {
+            return &microOps[block.first];
+        }
+
+        /**
+         * @brief Returns the instructions of a block per opcode family.
+         */
+        const FamilyCount *Families(const Block &block) const
+        {
+            return &familyCounts[block.firstFamily];
+        }
+
+        /**
+         * @brief Drops every block covering a written address.
+         * @param address Written guest address.
+         * @return true if at least one block was dropped.
+         */
+        bool Invalidate(std::uint16_t address)
+        {
+            return coverage[address] != 0 && drop(address);
+        }
+
+        /**
+         * @brief Drops all blocks.
+         */
+        void Clear();
+
+        /**
+         * @brief Returns the number of blocks translated since construction.
+         */
+        std::uint64_t GetTranslationCount() const;
+
+        /**
+         * @brief Returns the number of blocks dropped by guest writes.
+         */
+        std::uint64_t GetInvalidationCount() const;
+
+    private:
+        /**
+         * @brief Lookup entry of an address left to the interpreter.
+         */
+        static constexpr std::int32_t INTERPRETED = -2;
+
+        bool drop(std::uint16_t address);
+
+        std::vector<std::int32_t> lookup;
+        std::vector<std::uint8_t> coverage;
+        std::vector<Block> blocks;
+        std::vector<std::size_t> freeSlots;
+        std::vector<MicroOp> microOps;
+        std::vector<FamilyCount> familyCounts;
+        std::size_t interpretedCount = 0;  ///< Addresses marked INTERPRETED.
+        std::uint64_t translations = 0;
+        std::uint64_t invalidations = 0;
+    };
+}
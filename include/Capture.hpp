@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameBuffer.hpp"
+
+namespace chip8
+{
+    /**
+     * @struct CaptureStats
+     * @brief Counters of a CaptureWriter, complete once it is closed.
+     */
+    struct CaptureStats
+    {
+        std::uint64_t frames = 0;          ///< Frames in the file, dropped ones included as repeats.
+        std::uint64_t droppedFrames = 0;   ///< Frames pushed while the queue was full.
+        std::uint64_t encodedBytes = 0;    ///< Bytes of frame records written.
+
+        /**
+         * @brief Returns the mean encoded size of a frame.
+         */
+        double BytesPerFrame() const
+        {
+            return frames == 0 ? 0.0 : static_cast<double>(encodedBytes) / static_cast<double>(frames);
+        }
+    };
+
+    /**
+     * @class CaptureWriter
+     * @brief Records the screen once per emulated frame into a capture file.
+     * Push only copies the frame into a bounded single-producer queue; a
+     * writer thread encodes each frame as the XOR with the previous one,
+     * stored per changed row as a mask of changed bytes and those bytes,
+     * with runs of unchanged frames collapsed into a count. A full queue
+     * drops the frame rather than stall the emulation; dropped frames are
+     * counted and written as repeats, so the file keeps its timing.
+     */
+    class CaptureWriter
+    {
+    public:
+        /**
+         * @brief Default queue length, about a minute at 60 Hz.
+         */
+        static constexpr std::size_t DEFAULT_QUEUE_FRAMES = 4096;
+
+        /**
+         * @brief Constructor for the CaptureWriter class.
+         * Creates the file and starts the writer thread.
+         * @param filename Path of the capture, overwritten if it exists.
+         * @param queueFrames Queue length, a power of two.
+         */
+        explicit CaptureWriter(const std::string &filename, std::size_t queueFrames = DEFAULT_QUEUE_FRAMES);
+
+        /**
+         * @brief Closes the capture, ignoring errors; call Close to see them.
+         */
+        ~CaptureWriter();
+
+        CaptureWriter(const CaptureWriter &) = delete;
+        CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+        /**
+         * @brief Queues the next frame.
+         * Only one thread may push, and not after Close.
+         * @param rows Packed screen (SCREEN_HEIGHT words).
+         * @param wait Wait for room in a full queue instead of dropping the
+         * frame, for offline runs whose timing doesn't matter.
+         * @return false if the queue was full and the frame was dropped.
+         */
+        bool Push(const std::uint64_t *rows, bool wait = false);
+
+        /**
+         * @brief Writes the queued frames, completes the file and stops the writer thread.
+         * Throws if the file could not be written. Later calls do nothing.
+         */
+        void Close();
+
+        /**
+         * @brief Returns the counters; frames and bytes are final after Close.
+         */
+        CaptureStats GetStats() const;
+
+    private:
+        /**
+         * @brief Queued frame.
+         */
+        struct Slot
+        {
+            FrameBuffer rows;
+            std::uint64_t index;   ///< Number of the frame, counting dropped ones.
+        };
+
+        /**
+         * @brief Writer thread: encodes queued frames until closed.
+         */
+        void writeLoop();
+
+        /**
+         * @brief Appends the record of a frame to the output buffer.
+         */
+        void encode(const Slot &slot);
+
+        /**
+         * @brief Counts a frame equal to the previous one.
+         */
+        void addRepeat();
+
+        /**
+         * @brief Appends the record of the pending unchanged frames.
+         */
+        void flushRepeats();
+
+        /**
+         * @brief Writes the output buffer to the file.
+         */
+        void flushOutput();
+
+        std::string path;
+        std::ofstream file;
+        std::vector<Slot> slots;
+        std::size_t slotMask;
+
+        // Each side owns one position, kept on separate cache lines
+        alignas(64) std::atomic<std::uint64_t> head{0};   ///< Slots filled by Push.
+        alignas(64) std::atomic<std::uint64_t> tail{0};   ///< Slots taken by the writer.
+
+        // Producer side
+        alignas(64) std::uint64_t pushed = 0;
+        std::uint64_t dropped = 0;
+        std::atomic<bool> closing{false};
+        bool closed = false;
+
+        // Writer side
+        FrameBuffer previous{};
+        std::uint64_t nextIndex = 0;
+        std::uint32_t repeats = 0;
+        std::vector<std::uint8_t> output;
+        CaptureStats stats;
+        std::exception_ptr error;
+        std::atomic<bool> stopped{false};   ///< The writer thread ended, on error or close.
+
+        std::thread writer;
+    };
+
+    /**
+     * @class CaptureReader
+     * @brief Decodes a capture file written by CaptureWriter, frame by frame.
+     */
+    class CaptureReader
+    {
+    public:
+        /**
+         * @brief Constructor for the CaptureReader class.
+         * Throws if the file is not a capture or was written by another version.
+         * @param filename Path of the capture.
+         */
+        explicit CaptureReader(const std::string &filename);
+
+        /**
+         * @brief Decodes the next frame.
+         * Throws if the file ends inside a record.
+         * @param frame Receives the screen.
+         * @return false at the end of the capture.
+         */
+        bool Next(FrameBuffer &frame);
+
+        /**
+         * @brief Returns the frame count stored when the capture was closed, 0 if it wasn't.
+         */
+        std::uint64_t GetFrameCount() const;
+
+    private:
+        std::ifstream file;
+        std::string path;
+        FrameBuffer current{};
+        std::uint64_t frameCount = 0;
+        std::uint32_t repeats = 0;
+    };
+}
@@ -2,39 +2,247 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "Aot.hpp"
+#include "BlockCache.hpp"
+#include "Decoder.hpp"
+#include "FrameBuffer.hpp"
+#include "GuestMemory.hpp"
 #include "IChip8.hpp"
+#include "Jit.hpp"
+#include "Quirks.hpp"
+#include "Random.hpp"
+#include "trace/TraceBuffer.hpp"
 
 namespace chip8
 {
+    class Debugger;
+    class FuzzHarness;
+
     /**
      * @class Chip8
      * @brief Main class implementing the Chip8 emulator.
+     * The opcode handlers are instantiated once per Profile with the quirk
+     * branches resolved at compile time; the constructor picks the handler
+     * tables of its profile, so the quirks cost nothing at run time.
      */
     class Chip8 final : public IChip
     {
     public:
         /**
          * @brief Constructor for the Chip8 class.
+         * @param profile Quirk profile, fixed for the lifetime of the chip.
          */
-        explicit Chip8();
+        explicit Chip8(Profile profile = Profile::Modern);
 
         void reset() override;
         void loadROM(const std::string &filename) override;
+        void loadROM(const std::uint8_t *data, std::size_t size) override;
+        void loadROM(const RomImage &image) override;
         void emulateCycle() override;
+        std::uint64_t emulateCycles(std::uint64_t count) override;
+        void SetEngine(Engine engine) override;
+        bool IsWaiting() const override;
+        Profile GetProfile() const override;
         bool ShouldDraw() const override;
         void ClearDrawFlag() override;
-        const std::uint8_t *GetGfx() const override;
+        std::uint32_t GetDirtyRows() const override;
+        const std::uint64_t *GetGfx() const override;
         std::uint8_t *GetKeypad() override;
-        void UpdateTimers() override;
+        void SetClockRate(std::uint32_t instructionsPerSecond) override;
+        std::uint32_t GetClockRate() const override;
         std::uint8_t GetSoundTimer() const override;
+        void SaveState(Snapshot &snapshot) const override;
+        void LoadState(const Snapshot &snapshot) override;
+        void SetSeed(std::uint64_t newSeed) override;
+        std::uint64_t GetCycleCount() const override;
+        PerfCounters GetPerfCounters() const override;
+
+        /**
+         * @brief Default CPU clock in instructions per second.
+         */
+        static constexpr std::uint32_t DEFAULT_CLOCK_RATE = 700;
+
+        /**
+         * @brief Frequency of the delay and sound timers in Hz.
+         */
+        static constexpr std::uint32_t TIMER_RATE = 60;
+
+        /**
+         * @brief Cycles per iteration of a delay timer poll (FX07, SE, JP).
+         */
+        static constexpr std::uint64_t DELAY_POLL_LENGTH = 3;
+
+        /**
+         * @brief Attaches a buffer receiving one record per executed instruction.
+         * Records are only produced in builds with CHIP8_TRACE enabled.
+         * @param buffer Trace buffer or nullptr to detach.
+         */
+        void AttachTrace(trace::TraceBuffer *buffer);
 
     private:
+        friend class BatchChip8;
+        friend class Debugger;
+        friend class FuzzHarness;
+        friend class Jit;
+
+        template <Profile P>
+        struct Ops;
+
+        /**
+         * @brief Opcode handler executing one pre-decoded instruction.
+         */
+        using Handler = MicroHandler;
+
+        using HandlerTable = std::array<Handler, static_cast<std::size_t>(Op::Count)>;
+
+        /**
+         * @brief Handler table indexed by Op, one per profile.
+         */
+        template <Profile P>
+        static const HandlerTable HANDLERS;
+
+        /**
+         * @brief Handler table for the inside of translated blocks, one per profile.
+         */
+        template <Profile P>
+        static const HandlerTable BODY_HANDLERS;
+
+        /**
+         * @brief Writes a byte of memory and drops the cached decodes covering it.
+         * @param address Address to write.
+         * @param value Byte to store.
+         */
+        void writeMemory(std::uint16_t address, std::uint8_t value);
+
+        /**
+         * @brief Drops the cached decodes and translations covering a changed byte.
+         * @param address Changed address.
+         */
+        void invalidate(std::uint16_t address);
+
+        /**
+         * @brief Returns the number of 60 Hz timer ticks elapsed since reset.
+         * Derived from the cycle count and the clock rate.
+         */
+        std::uint64_t timerTicks() const;
+
+        /**
+         * @brief Returns the current value of a timer.
+         * @param value Value the timer was set to.
+         * @param setAt Tick count when it was set.
+         * @return Remaining value, 0 once expired.
+         */
+        std::uint8_t timerValue(std::uint8_t value, std::uint64_t setAt) const;
+
+        /**
+         * @brief Returns the first cycle at which the timer tick count reaches a tick.
+         * @param tick Tick count.
+         */
+        std::uint64_t firstCycleOfTick(std::uint64_t tick) const;
+
+        /**
+         * @brief Counts a timer about to be overwritten if it ran out since it was set.
+         * @param value Value the timer was set to.
+         * @param setAt Tick count when it was set.
+         */
+        void retireTimer(std::uint8_t value, std::uint64_t setAt);
+
+        /**
+         * @brief Runs up to budget cycles one instruction at a time.
+         * @param budget Maximum number of cycles.
+         * @return Number of cycles executed.
+         */
+        std::uint64_t runInterpreter(std::uint64_t budget);
+
+        /**
+         * @brief Fast-forwards through a wait loop at pc.
+         * Engines call this when pc did not move forward, which every loop
+         * does once per iteration. The skipped cycles leave the machine
+         * exactly as running them would, counters included.
+         * @param budget Cycles left in the current emulateCycles call.
+         * @return Number of cycles skipped, 0 if pc is not in a wait loop.
+         */
+        std::uint64_t skipIdle(std::uint64_t budget);
+
+        /**
+         * @brief Skips whole iterations of FX07 / SE Vx, NN / JP polling the delay timer.
+         * Stops before the iteration that reads NN.
+         * @param opcode FX07 opcode at pc.
+         * @param budget Cycles left in the current emulateCycles call.
+         * @return Number of cycles skipped.
+         */
+        std::uint64_t skipDelayPoll(std::uint16_t opcode, std::uint64_t budget);
+
+        /**
+         * @brief Runs up to budget cycles through the basic-block cache.
+         * @param budget Maximum number of cycles.
+         * @return Number of cycles executed.
+         */
+        std::uint64_t runBlocks(std::uint64_t budget);
+
+        /**
+         * @brief Runs up to budget cycles through natively compiled blocks.
+         * Blocks longer than the remaining budget are interpreted so the
+         * cycle count stays exact.
+         * @param budget Maximum number of cycles.
+         * @return Number of cycles executed.
+         */
+        std::uint64_t runJit(std::uint64_t budget);
+
+        /**
+         * @brief Runs up to budget cycles through the ahead-of-time compiled blocks of the ROM.
+         * Addresses without a live compiled block, and blocks longer than
+         * the remaining budget, are interpreted.
+         * @param budget Maximum number of cycles.
+         * @return Number of cycles executed.
+         */
+        std::uint64_t runAot(std::uint64_t budget);
+
+        /**
+         * @brief Looks up the compiled program of the loaded ROM and indexes its blocks.
+         * Blocks over bytes that no longer match the ROM are dropped.
+         */
+        void resolveAot();
+
+        /**
+         * @brief Drops the compiled blocks covering a changed byte.
+         * @param address Changed address.
+         */
+        void invalidateAot(std::uint16_t address);
+
+        /**
+         * @brief Main RAM (4 kB), pages shared with the ROM image until written.
+         */
+        GuestMemory memory;
+
+        /**
+         * @brief Decoded instruction cache, one slot per memory address.
+         */
+        std::array<Instruction, 4096> decodeCache{};
+
+        /**
+         * @brief Set once decodeCache holds an entry, so resetting a fresh machine skips clearing it.
+         */
+        bool decoded = false;
+
+        /**
+         * @brief Translated basic blocks used by Engine::BlockCache.
+         */
+        BlockCache blockCache{4096};
+
+        /**
+         * @brief Native code cache used by Engine::Jit, created on first use.
+         */
+        std::unique_ptr<Jit> jit;
+
         /**
-         * @brief Main RAM (4 kB).
+         * @brief Engine used by emulateCycles.
          */
-        std::array<uint8_t, 4096> memory{};
+        Engine engine = Engine::Interpreter;
 
         /**
          * @brief Registers (16 registers of 8 bits each).
@@ -62,20 +270,48 @@ namespace chip8
         std::uint8_t sp = 0;
 
         /**
-         * @brief Delay timer (8 bits).
+         * @brief Delay timer (8 bits), value last written by FX15.
+         * The timers are not decremented; their current value is computed
+         * from the ticks elapsed since they were set, see timerValue.
          */
         std::uint8_t delay_timer = 0;
 
         /**
-         * @brief Sound timer (8 bits).
+         * @brief Sound timer (8 bits), value last written by FX18.
          */
         std::uint8_t sound_timer = 0;
 
+        /**
+         * @brief Timer tick count when the delay timer was set.
+         */
+        std::uint64_t delayTimerSetAt = 0;
+
+        /**
+         * @brief Timer tick count when the sound timer was set.
+         */
+        std::uint64_t soundTimerSetAt = 0;
+
+        /**
+         * @brief CPU clock in instructions per second.
+         */
+        std::uint32_t clockRate = DEFAULT_CLOCK_RATE;
+
+        /**
+         * @brief Timer ticks and cycle count at the last clock rate change.
+         */
+        std::uint64_t timerTickBase = 0;
+        std::uint64_t timerCycleBase = 0;
+
         /**
          * @brief Screen (64x32 pixels).
-         * Each pixel is represented by a single byte (0 or 1).
+         * Each row is packed into one word, see FrameBuffer.
          */
-        std::array<uint8_t, 64 * 32> gfx{};
+        FrameBuffer gfx{};
+
+        /**
+         * @brief Rows of gfx changed since the last ClearDrawFlag, bit y for row y.
+         */
+        std::uint32_t dirtyRows = ALL_ROWS;
 
         /**
          * @brief Keypad state (16 keys).
@@ -87,6 +323,83 @@ namespace chip8
          */
         bool DrawFlag = true;
 
+        /**
+         * @brief Number of cycles executed since the last reset.
+         */
+        std::uint64_t cycles = 0;
+
+        /**
+         * @brief Seed the random generator is reset to, see SetSeed.
+         */
+        std::uint64_t seed = DEFAULT_SEED;
+
+        /**
+         * @brief State of the CXNN random number generator.
+         */
+        RandomState rngState = SeedRandom(DEFAULT_SEED);
+
+        /**
+         * @brief Execution statistics, see GetPerfCounters.
+         * Timers are not decremented, so an underflow is only counted when
+         * an expired timer is overwritten; GetPerfCounters adds the
+         * timers expired at that point.
+         */
+        PerfCounters perf{};
+
+        /**
+         * @brief Optional sink for instruction trace records.
+         */
+        trace::TraceBuffer *traceBuffer = nullptr;
+
+        /**
+         * @brief Debugger attached by its constructor; emulateCycles runs
+         * through it instead of the engine while it is armed.
+         */
+        Debugger *debugger = nullptr;
+
+        /**
+         * @brief Quirk profile selected at construction.
+         */
+        Profile profile;
+
+        /**
+         * @brief HANDLERS and BODY_HANDLERS of the profile.
+         */
+        const Handler *handlers;
+        const Handler *bodyHandlers;
+
+        /**
+         * @brief Set when the last emulateCycles call ended in a skipped wait loop, see IsWaiting.
+         */
+        bool waiting = false;
+
+        /**
+         * @brief HashRom of the loaded ROM, 0 if none was loaded since reset.
+         */
+        std::uint64_t romHash = 0;
+
+        /**
+         * @brief Compiled program of the ROM used by Engine::Aot, looked up on first use after reset.
+         */
+        const AotProgram *aotProgram = nullptr;
+        bool aotResolved = false;
+        AotContext aotContext;
+
+        /**
+         * @brief Index into the program's blocks per guest address, -1 if no block starts there.
+         */
+        std::vector<std::int32_t> aotLookup;
+
+        /**
+         * @brief Number of compiled blocks covering each guest address.
+         */
+        std::vector<std::uint8_t> aotCoverage;
+
+        /**
+         * @brief Per block, cleared when guest code under it changes.
+         */
+        std::vector<std::uint8_t> aotLive;
+
         /**
          * @brief Fontset (5x8 pixels for each character).
          * The fontset is stored in the memory starting from address 0x50.
@@ -116,4 +429,11 @@ namespace chip8
          */
         static constexpr std::uint16_t FONTSET_START_ADDRESS = 0x050;
     };
+
+    /**
+     * @brief Creates a chip for a quirk profile.
+     * @param profile Quirk profile.
+     * @return New chip in the power-on state.
+     */
+    std::unique_ptr<IChip> CreateChip(Profile profile);
 }
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GuestMemory.hpp"
+
+namespace chip8
+{
+    class Chip8;
+
+    /**
+     * @brief Comparison of a conditional breakpoint, register on the left.
+     */
+    enum class Condition : std::uint8_t
+    {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+    };
+
+    /**
+     * @brief Memory accesses a watchpoint stops on.
+     */
+    enum class WatchKind : std::uint8_t
+    {
+        Read = 1,    ///< DXYN sprite data and FX65.
+        Write = 2,   ///< FX33 and FX55.
+        Access = 3,  ///< Both.
+    };
+
+    /**
+     * @struct Breakpoint
+     * @brief Stops before the instruction at an address executes, optionally only if a register matches.
+     */
+    struct Breakpoint
+    {
+        /**
+         * @brief Address of a breakpoint checked before every instruction.
+         */
+        static constexpr std::uint16_t ANY_ADDRESS = 0xFFFF;
+
+        std::uint32_t id;
+        std::uint16_t address;        ///< Instruction address or ANY_ADDRESS.
+        bool conditional = false;
+        std::uint8_t reg = 0;         ///< Register compared, V0 to VF.
+        Condition condition = Condition::Equal;
+        std::uint8_t value = 0;
+        std::uint64_t hits = 0;
+    };
+
+    /**
+     * @struct Watchpoint
+     * @brief Stops after an instruction that reads or writes an address range.
+     * Instruction fetches are not memory reads.
+     */
+    struct Watchpoint
+    {
+        std::uint32_t id;
+        std::uint16_t first;   ///< First watched address.
+        std::uint16_t last;    ///< Last watched address, inclusive.
+        WatchKind kind;
+        std::uint64_t hits = 0;
+    };
+
+    /**
+     * @brief Why the debugger stopped the machine.
+     */
+    enum class StopReason : std::uint8_t
+    {
+        None,         ///< Running.
+        Breakpoint,   ///< Before the instruction at a breakpoint.
+        Watchpoint,   ///< After an instruction accessed a watched address.
+        Step,         ///< A step, step over or step out completed.
+        Frame,        ///< The frame of RunToFrame was reached.
+    };
+
+    /**
+     * @struct StopEvent
+     * @brief Where and why the machine stopped.
+     */
+    struct StopEvent
+    {
+        StopReason reason = StopReason::None;
+        std::uint16_t pc = 0;        ///< Address of the next instruction.
+        std::uint32_t id = 0;        ///< Breakpoint or watchpoint that stopped the machine.
+        std::uint16_t address = 0;   ///< First watched address accessed.
+        bool write = false;          ///< The watched access was a write.
+        std::uint16_t at = 0;        ///< Address of the instruction that made the watched access.
+    };
+
+    /**
+     * @class Debugger
+     * @brief Breakpoints, watchpoints and stepping for one chip.
+     * While nothing is armed the chip runs its engine untouched; with
+     * breakpoints, watchpoints or a pending step, emulateCycles switches
+     * to an instrumented loop that interprets one instruction at a time
+     * and checks them around it. Once stopped, emulateCycles executes
+     * nothing until Continue or a step command.
+     */
+    class Debugger
+    {
+    public:
+        /**
+         * @brief Constructor for the Debugger class, attaches it to the chip.
+         * @param chip Chip to debug; the debugger must be destroyed first.
+         */
+        explicit Debugger(Chip8 &chip);
+
+        /**
+         * @brief Detaches the debugger from its chip.
+         */
+        ~Debugger();
+
+        Debugger(const Debugger &) = delete;
+        Debugger &operator=(const Debugger &) = delete;
+
+        /**
+         * @brief Adds a breakpoint at an instruction address.
+         * @return Breakpoint id.
+         */
+        std::uint32_t AddBreakpoint(std::uint16_t address);
+
+        /**
+         * @brief Adds a breakpoint taken only if a register compares true.
+         * @param address Instruction address, or Breakpoint::ANY_ADDRESS to check before every instruction.
+         * @param reg Register index, 0 to 15.
+         * @param condition Comparison of the register with value.
+         * @param value Right-hand side.
+         * @return Breakpoint id.
+         */
+        std::uint32_t AddBreakpoint(std::uint16_t address, std::uint8_t reg, Condition condition, std::uint8_t value);
+
+        /**
+         * @brief Adds a watchpoint over an address range.
+         * @param first First address.
+         * @param last Last address, inclusive, not below first.
+         * @param kind Accesses to stop on.
+         * @return Watchpoint id.
+         */
+        std::uint32_t AddWatchpoint(std::uint16_t first, std::uint16_t last, WatchKind kind);
+
+        /**
+         * @brief Removes a breakpoint or watchpoint.
+         * @return false if no breakpoint or watchpoint has the id.
+         */
+        bool Remove(std::uint32_t id);
+
+        /**
+         * @brief Removes every breakpoint and watchpoint.
+         */
+        void Clear();
+
+        const std::vector<Breakpoint> &GetBreakpoints() const;
+        const std::vector<Watchpoint> &GetWatchpoints() const;
+
+        /**
+         * @brief Resumes until a breakpoint or watchpoint stops the machine.
+         * A breakpoint at the current pc is passed over once.
+         */
+        void Continue();
+
+        /**
+         * @brief Executes count instructions, then stops.
+         */
+        void Step(std::uint64_t count = 1);
+
+        /**
+         * @brief Steps, running a subroutine called at pc (2NNN) until it returns.
+         */
+        void StepOver();
+
+        /**
+         * @brief Runs until the current subroutine returns (00EE).
+         * Keeps running like Continue at the outermost level.
+         */
+        void StepOut();
+
+        /**
+         * @brief Runs until the frame count reaches a frame.
+         * Frames are ticks of the 60 Hz timers, see GetFrame.
+         * @param frame Frame to stop at, stops at the next instruction if already reached.
+         */
+        void RunToFrame(std::uint64_t frame);
+
+        /**
+         * @brief Stops the machine before its next instruction, as if a step had completed.
+         */
+        void Pause();
+
+        /**
+         * @brief Returns the number of 60 Hz timer ticks since reset.
+         */
+        std::uint64_t GetFrame() const;
+
+        /**
+         * @brief Checks if the machine is stopped.
+         */
+        bool IsStopped() const;
+
+        /**
+         * @brief Returns the last stop, StopReason::None while running.
+         */
+        const StopEvent &GetStop() const;
+
+        /**
+         * @brief Checks if emulateCycles has to run instrumented.
+         */
+        bool IsArmed() const
+        {
+            return armed;
+        }
+
+    private:
+        friend class Chip8;
+
+        /**
+         * @brief Execution mode set by the last command.
+         */
+        enum class Mode : std::uint8_t
+        {
+            Run,
+            Step,
+            StepOver,
+            StepOut,
+            Frame,
+        };
+
+        /**
+         * @brief Instrumented replacement of emulateCycles.
+         * @param budget Maximum number of cycles.
+         * @return Number of cycles executed, fewer than budget if the machine stopped.
+         */
+        std::uint64_t run(std::uint64_t budget);
+
+        /**
+         * @brief Returns the breakpoint taken before the instruction at pc, or nullptr.
+         */
+        Breakpoint *checkBreakpoints(std::uint16_t pc);
+
+        /**
+         * @brief Checks the data accesses of the instruction at pc, before it executes.
+         * @return true if it accesses a watched address; event receives the access.
+         */
+        bool checkWatchpoints(std::uint16_t pc, StopEvent &event);
+
+        /**
+         * @brief Stops the machine before the instruction at pc.
+         */
+        void stop(StopReason reason, std::uint32_t id = 0);
+
+        /**
+         * @brief Clears the stop and sets the mode for a resuming command.
+         */
+        void resume(Mode newMode);
+
+        /**
+         * @brief Rebuilds the address maps and the armed flag.
+         */
+        void update();
+
+        Chip8 &chip;
+
+        std::vector<Breakpoint> breakpoints;
+        std::vector<Watchpoint> watchpoints;
+        std::uint32_t nextId = 1;
+
+        /**
+         * @brief Addresses with a breakpoint, and watched for reads and writes.
+         */
+        std::bitset<GuestMemory::SIZE> breakAt;
+        std::bitset<GuestMemory::SIZE> watchReads;
+        std::bitset<GuestMemory::SIZE> watchWrites;
+        bool breakAnywhere = false;
+
+        Mode mode = Mode::Run;
+        std::uint64_t stepsLeft = 0;
+        std::uint16_t returnAddress = 0;   ///< Step over: pc after the call.
+        std::uint8_t depth = 0;            ///< Stack depth the step over or out started at.
+        std::uint64_t targetFrame = 0;
+
+        /**
+         * @brief Set by resuming commands so a breakpoint at the resume pc is passed.
+         */
+        bool passBreakpoint = false;
+
+        bool stopped = false;
+        StopEvent event;
+        bool armed = false;
+    };
+
+    /**
+     * @brief Parses a comparison as written in the console, e.g. "==" or ">=".
+     * @return true if the operator is known.
+     */
+    bool ParseCondition(const std::string &text, Condition &condition);
+
+    /**
+     * @brief Returns the console spelling of a comparison.
+     */
+    const char *ConditionName(Condition condition);
+}
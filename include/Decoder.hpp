@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chip8
+{
+    /**
+     * @brief Operation identifiers produced by the decode stage.
+     * Used as indices into the handler table of the interpreter.
+     */
+    enum class Op : std::uint8_t
+    {
+        Undecoded = 0, ///< Cache slot not decoded yet.
+        CLS,           ///< 00E0
+        RET,           ///< 00EE
+        NOP,           ///< 0000
+        JP,            ///< 1NNN
+        CALL,          ///< 2NNN
+        SE_VX_NN,      ///< 3XNN
+        SNE_VX_NN,     ///< 4XNN
+        SE_VX_VY,      ///< 5XY0
+        LD_VX_NN,      ///< 6XNN
+        ADD_VX_NN,     ///< 7XNN
+        LD_VX_VY,      ///< 8XY0
+        OR_VX_VY,      ///< 8XY1
+        AND_VX_VY,     ///< 8XY2
+        XOR_VX_VY,     ///< 8XY3
+        ADD_VX_VY,     ///< 8XY4
+        SUB_VX_VY,     ///< 8XY5
+        SHR_VX,        ///< 8XY6
+        SUBN_VX_VY,    ///< 8XY7
+        SHL_VX,        ///< 8XYE
+        SNE_VX_VY,     ///< 9XY0
+        LD_I_NNN,      ///< ANNN
+        JP_V0_NNN,     ///< BNNN
+        RND_VX_NN,     ///< CXNN
+        DRW,           ///< DXYN
+        SKP_VX,        ///< EX9E
+        SKNP_VX,       ///< EXA1
+        LD_VX_DT,      ///< FX07
+        LD_VX_K,       ///< FX0A
+        LD_DT_VX,      ///< FX15
+        LD_ST_VX,      ///< FX18
+        ADD_I_VX,      ///< FX1E
+        LD_F_VX,       ///< FX29
+        LD_B_VX,       ///< FX33
+        LD_MEM_VX,     ///< FX55
+        LD_VX_MEM,     ///< FX65
+        Invalid,       ///< Opcode not supported, raises an error when executed.
+        Count
+    };
+
+    /**
+     * @struct Instruction
+     * @brief Pre-decoded opcode with all operand fields extracted.
+     */
+    struct Instruction
+    {
+        Op op = Op::Undecoded;
+        std::uint8_t x = 0;       ///< Second nibble.
+        std::uint8_t y = 0;       ///< Third nibble.
+        std::uint8_t n = 0;       ///< Lowest nibble.
+        std::uint8_t nn = 0;      ///< Lowest byte.
+        std::uint16_t nnn = 0;    ///< Lowest 12 bits.
+        std::uint16_t opcode = 0; ///< Raw opcode.
+    };
+
+    /**
+     * @brief Decodes a raw opcode.
+     * @param opcode 16-bit opcode.
+     * @return Decoded instruction, Op::Invalid for unsupported opcodes.
+     */
+    Instruction Decode(std::uint16_t opcode);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace chip8
+{
+    /**
+     * @brief Formats a value as an uppercase hexadecimal literal (e.g. 0x2F0).
+     * @param value Value to format.
+     * @return Formatted string.
+     */
+    std::string ToHex(std::uint16_t value);
+
+    /**
+     * @brief Returns the mnemonic of an opcode, e.g. "LD V3, 10".
+     * Unknown opcodes are rendered as a data word ("DW 0x....").
+     * @param opcode Opcode to disassemble.
+     * @return Human-readable instruction.
+     */
+    std::string Disassemble(std::uint16_t opcode);
+
+    /**
+     * @brief Returns the error reported when an unsupported opcode executes.
+     * @param opcode Opcode decoded as Op::Invalid.
+     * @return Error message, e.g. "Unsupported FX instruction: 0xF0FF".
+     */
+    std::string DescribeInvalid(std::uint16_t opcode);
+}
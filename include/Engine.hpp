@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+namespace chip8
+{
+    /**
+     * @brief Execution engines available to run the CPU.
+     */
+    enum class Engine
+    {
+        Interpreter, ///< Reference interpreter, one dispatch per instruction.
+        BlockCache,  ///< Translated basic blocks, one dispatch per block.
+        Jit,         ///< Basic blocks recompiled to native x86-64 code.
+        Aot,         ///< Basic blocks compiled to C++ ahead of time by chip8_aot.
+    };
+
+    /**
+     * @brief Parses an engine name as accepted on the command line.
+     * @param name "interpreter", "blocks", "jit" or "aot".
+     * @param engine Receives the parsed engine.
+     * @return true if the name is known.
+     */
+    bool ParseEngine(const std::string &name, Engine &engine);
+
+    /**
+     * @brief Returns the command line name of an engine.
+     * @param engine Engine.
+     * @return Engine name.
+     */
+    const char *EngineName(Engine engine);
+}
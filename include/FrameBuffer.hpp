@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace chip8
+{
+    /**
+     * @brief Screen width in pixels.
+     */
+    constexpr int SCREEN_WIDTH = 64;
+
+    /**
+     * @brief Screen height in pixels.
+     */
+    constexpr int SCREEN_HEIGHT = 32;
+
+    /**
+     * @brief Packed screen, one 64-bit word per row.
+     * The most significant bit of a row is the leftmost pixel (x = 0).
+     */
+    using FrameBuffer = std::array<std::uint64_t, SCREEN_HEIGHT>;
+
+    /**
+     * @brief Dirty-row bitmap with every row of the screen set.
+     */
+    constexpr std::uint32_t ALL_ROWS = 0xFFFFFFFFu;
+
+    /**
+     * @brief Places an 8-pixel sprite row at column x of a packed row.
+     * Pixels past the right edge wrap around to the left, like (x + i) % 64.
+     * @param bits Sprite byte, most significant bit drawn first.
+     * @param x Column of the first sprite pixel.
+     * @return Packed row mask.
+     */
+    inline std::uint64_t SpriteRow(std::uint8_t bits, std::uint8_t x)
+    {
+        const std::uint64_t row = static_cast<std::uint64_t>(bits) << 56;
+        const unsigned shift = x & (SCREEN_WIDTH - 1);
+        return shift == 0 ? row : (row >> shift) | (row << (SCREEN_WIDTH - shift));
+    }
+
+    /**
+     * @brief Places an 8-pixel sprite row at column x, dropping pixels past the right edge.
+     * @param bits Sprite byte, most significant bit drawn first.
+     * @param x Column of the first sprite pixel, 0 to SCREEN_WIDTH - 1.
+     * @return Packed row mask.
+     */
+    inline std::uint64_t ClippedSpriteRow(std::uint8_t bits, std::uint8_t x)
+    {
+        return (static_cast<std::uint64_t>(bits) << 56) >> x;
+    }
+
+    /**
+     * @brief Dirty-row bitmap of a sprite, rows wrapping like (y + i) % 32.
+     * @param y Row of the first sprite line.
+     * @param height Number of sprite lines, 0 to 15.
+     * @return Bitmap with bit r set for each row r the sprite covers.
+     */
+    inline std::uint32_t SpriteRows(std::uint8_t y, std::uint8_t height)
+    {
+        const std::uint32_t rows = (1u << height) - 1;
+        const unsigned shift = y & (SCREEN_HEIGHT - 1);
+        return shift == 0 ? rows : (rows << shift) | (rows >> (SCREEN_HEIGHT - shift));
+    }
+
+    /**
+     * @brief Reads one pixel of a packed screen.
+     * @param rows Packed rows (SCREEN_HEIGHT words).
+     * @param x Column, 0 to SCREEN_WIDTH - 1.
+     * @param y Row, 0 to SCREEN_HEIGHT - 1.
+     * @return true if the pixel is lit.
+     */
+    inline bool GetPixel(const std::uint64_t *rows, int x, int y)
+    {
+        return (rows[y] >> (SCREEN_WIDTH - 1 - x)) & 1;
+    }
+
+    /**
+     * @brief Expands a packed screen to one byte (0 or 1) per pixel.
+     * @param rows Packed rows (SCREEN_HEIGHT words).
+     * @param pixels Output buffer of SCREEN_WIDTH * SCREEN_HEIGHT bytes.
+     */
+    inline void Unpack(const std::uint64_t *rows, std::uint8_t *pixels)
+    {
+        for (int y = 0; y < SCREEN_HEIGHT; ++y)
+        {
+            for (int x = 0; x < SCREEN_WIDTH; ++x)
+            {
+                pixels[y * SCREEN_WIDTH + x] = GetPixel(rows, x, y) ? 1 : 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Fast 64-bit hash of a packed screen.
+     * Not cryptographic; meant to compare frames against recorded hashes.
+     * @param rows Packed rows (SCREEN_HEIGHT words).
+     * @return Hash of the screen contents.
+     */
+    inline std::uint64_t HashFrame(const std::uint64_t *rows)
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (int y = 0; y < SCREEN_HEIGHT; ++y)
+        {
+            hash = (hash ^ rows[y]) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+}
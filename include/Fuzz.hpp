@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Chip8.hpp"
+#include "Snapshot.hpp"
+
+namespace chip8
+{
+    /**
+     * @brief Guest behaviour found by FuzzHarness. Everything but MemoryWrap
+     * is left undefined by the core and may corrupt the machine; memory
+     * accesses wrap at 4 KB, so MemoryWrap is only reported on request.
+     */
+    enum class Finding : std::uint8_t
+    {
+        None,
+        MemoryWrap,       ///< FX33, FX55, FX65 or DXYN wrapping past 4 KB from I.
+        StackOverflow,    ///< 2NNN with all 16 stack levels in use.
+        StackUnderflow,   ///< 00EE with an empty stack.
+        KeyOutOfRange,    ///< EX9E or EXA1 with Vx above 0xF.
+    };
+
+    /**
+     * @brief Returns a short description of a finding.
+     */
+    const char *FindingName(Finding finding);
+
+    /**
+     * @struct FuzzResult
+     * @brief Outcome of one fuzz execution.
+     */
+    struct FuzzResult
+    {
+        Finding finding = Finding::None;
+        std::uint16_t pc = 0;          ///< Address of the offending instruction.
+        std::uint16_t opcode = 0;
+        std::uint64_t cycles = 0;      ///< Cycles executed.
+        bool guestError = false;       ///< The core raised an error (invalid opcode, pc out of memory).
+    };
+
+    /**
+     * @class FuzzHarness
+     * @brief Runs fuzz inputs on one chip, restoring a clean state in between.
+     * An input is an input script followed by a ROM:
+     *
+     *   byte 0            number of script events E
+     *   E x 3 bytes       cycles since the previous event, keys held (16-bit little endian)
+     *   remaining bytes   ROM loaded at 0x200, truncated to MAX_ROM_SIZE
+     *
+     * Instructions are stepped with emulateCycle and checked before they
+     * execute, so a finding is reported before it corrupts the machine.
+     * Executions end early once the machine can only wait (JP to itself,
+     * FX0A without a key) and no event is left.
+     */
+    class FuzzHarness
+    {
+    public:
+        /**
+         * @brief Default number of cycles per execution.
+         */
+        static constexpr std::uint64_t DEFAULT_CYCLE_BUDGET = 10000;
+
+        /**
+         * @brief Constructor for the FuzzHarness class.
+         * @param profile Quirk profile of the chip.
+         * @param cycleBudget Maximum cycles per execution, must be positive.
+         * @param reportWraps Also report memory accesses wrapping at 4 KB.
+         */
+        explicit FuzzHarness(Profile profile = Profile::Modern, std::uint64_t cycleBudget = DEFAULT_CYCLE_BUDGET,
+                             bool reportWraps = false);
+
+        /**
+         * @brief Runs one input from the clean state.
+         * @param data Input bytes.
+         * @param size Number of bytes.
+         * @return Outcome, with the first finding if any.
+         */
+        FuzzResult Run(const std::uint8_t *data, std::size_t size);
+
+        /**
+         * @brief Returns the number of executions so far.
+         */
+        std::uint64_t GetExecutions() const;
+
+    private:
+        /**
+         * @brief Checks the instruction at pc against the paths the core leaves unchecked.
+         */
+        Finding check() const;
+
+        Chip8 chip;
+        std::uint64_t budget;
+        bool reportWraps;
+
+        /**
+         * @brief State after reset, taken once; Run copies a ROM into
+         * loaded and restores it with LoadState, which only rewrites and
+         * invalidates the bytes that differ from the machine.
+         */
+        Snapshot clean{};
+        Snapshot loaded{};
+
+        std::size_t lastRomSize = 0;
+        std::uint64_t executions = 0;
+    };
+}
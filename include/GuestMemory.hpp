@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace chip8
+{
+    /**
+     * @class GuestMemory
+     * @brief 4 kB guest RAM made of 256-byte pages with copy-on-write.
+     * Pages either point at shared read-only data (a zero page, the font,
+     * a memory-mapped ROM image) or at the private copy of the instance,
+     * which is only allocated on the first write. Loading a shared image
+     * therefore copies nothing.
+     */
+    class GuestMemory
+    {
+    public:
+        static constexpr std::size_t SIZE = 4096;
+        static constexpr std::size_t PAGE_SIZE = 256;
+        static constexpr std::size_t PAGES = SIZE / PAGE_SIZE;
+
+        /**
+         * @brief Constructor for the GuestMemory class, all bytes zero.
+         */
+        GuestMemory();
+
+        GuestMemory(const GuestMemory &) = delete;
+        GuestMemory &operator=(const GuestMemory &) = delete;
+
+        /**
+         * @brief Reads a byte; addresses wrap around at 4 kB.
+         */
+        std::uint8_t operator[](std::size_t address) const
+        {
+            address &= SIZE - 1;
+            return pages[address / PAGE_SIZE][address % PAGE_SIZE];
+        }
+
+        /**
+         * @brief Returns the bytes from address to the end of its page.
+         * @param address Address below SIZE.
+         */
+        const std::uint8_t *Data(std::size_t address) const
+        {
+            return pages[address / PAGE_SIZE] + address % PAGE_SIZE;
+        }
+
+        /**
+         * @brief Writes a byte, copying its page first if it is shared.
+         * @param address Address, wraps around at 4 kB.
+         * @param value Byte to store.
+         */
+        void Write(std::size_t address, std::uint8_t value)
+        {
+            address &= SIZE - 1;
+            const std::size_t page = address / PAGE_SIZE;
+            if ((ownedPages & (1u << page)) == 0)
+            {
+                own(page);
+            }
+
+            (*owned)[address] = value;
+        }
+
+        /**
+         * @brief Copies bytes into private pages.
+         * @param address First address, address + size must not exceed SIZE.
+         * @param data Bytes to copy.
+         * @param size Number of bytes.
+         */
+        void Load(std::size_t address, const std::uint8_t *data, std::size_t size);
+
+        /**
+         * @brief Maps shared read-only data over whole pages without copying it.
+         * Bytes of the last page beyond size are read from data as well, so
+         * data must be readable, and zero, up to the next page boundary.
+         * The data must outlive the mapping.
+         * @param address Page-aligned first address.
+         * @param data Shared bytes.
+         * @param size Number of bytes, address + size must not exceed SIZE.
+         */
+        void Map(std::size_t address, const std::uint8_t *data, std::size_t size);
+
+        /**
+         * @brief Sets every byte to zero and drops all mappings.
+         * The private copy is kept for reuse.
+         */
+        void Clear();
+
+        /**
+         * @brief Copies the whole memory to a buffer of SIZE bytes.
+         */
+        void CopyTo(std::uint8_t *out) const;
+
+        /**
+         * @brief Returns the number of pages copied into the private memory.
+         */
+        std::size_t GetPrivatePageCount() const;
+
+    private:
+        void own(std::size_t page);
+
+        std::array<const std::uint8_t *, PAGES> pages;
+
+        /**
+         * @brief Private copy, allocated on the first write.
+         */
+        std::unique_ptr<std::array<std::uint8_t, SIZE>> owned;
+
+        /**
+         * @brief Pages served from the private copy, bit p for page p.
+         */
+        std::uint32_t ownedPages = 0;
+    };
+}
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
+#include "Engine.hpp"
+#include "PerfCounters.hpp"
+#include "Quirks.hpp"
+#include "RomLibrary.hpp"
+#include "Snapshot.hpp"
+
 namespace chip8
 {
     /**
@@ -22,16 +29,61 @@ namespace chip8
          */
         virtual void loadROM(const std::string &filename) = 0;
 
+        /**
+         * @brief Loads a ROM image already in memory into the emulator.
+         * @param data ROM bytes.
+         * @param size Number of bytes, at most 4096 - 512.
+         */
+        virtual void loadROM(const std::uint8_t *data, std::size_t size) = 0;
+
+        /**
+         * @brief Loads a shared ROM image without copying it.
+         * Memory pages of the image are only copied when the program writes
+         * to them; the image must outlive the loaded program.
+         * @param image Image from a RomLibrary.
+         */
+        virtual void loadROM(const RomImage &image) = 0;
+
         /**
          * @brief Emulates one cycle of the Chip8 CPU.
          */
         virtual void emulateCycle() = 0;
 
+        /**
+         * @brief Emulates up to count cycles with the selected engine.
+         * @param count Maximum number of cycles to execute.
+         * @return Number of cycles executed.
+         */
+        virtual std::uint64_t emulateCycles(std::uint64_t count) = 0;
+
+        /**
+         * @brief Selects the engine used by emulateCycles.
+         * Throws if the engine is not available on this host.
+         * @param engine Execution engine.
+         */
+        virtual void SetEngine(Engine engine) = 0;
+
+        /**
+         * @brief Checks if the last emulateCycles call ended spinning in a wait loop.
+         * Recognised waits are FX0A without a key, a jump to itself, and
+         * FX07 / SE Vx, NN / JP polling the delay timer; their cycles are
+         * skipped in one step. Nothing changes until a key is pressed or
+         * the timer runs out, so the host may sleep.
+         * @return true if the machine is waiting.
+         */
+        virtual bool IsWaiting() const = 0;
+
+        /**
+         * @brief Returns the quirk profile the chip was created with.
+         * @return Profile.
+         */
+        virtual Profile GetProfile() const = 0;
+
         /**
          * @brief Returns pointer to the graphics buffer.
-         * @return Pointer to the graphics buffer (64 x 32).
+         * @return Pointer to the packed graphics buffer (32 rows of 64 pixels, see FrameBuffer).
          */
-        virtual const std::uint8_t *GetGfx() const = 0;
+        virtual const std::uint64_t *GetGfx() const = 0;
 
         /**
          * @brief Checks if the screen should be refreshed.Chip8
@@ -40,10 +92,16 @@ namespace chip8
         virtual bool ShouldDraw() const = 0;
 
         /**
-         * @brief Clears the draw flag.
+         * @brief Clears the draw flag and the dirty-row bitmap.
          */
         virtual void ClearDrawFlag() = 0;
 
+        /**
+         * @brief Returns the rows changed since the last ClearDrawFlag.
+         * @return Bitmap with bit y set if row y of the graphics buffer changed.
+         */
+        virtual std::uint32_t GetDirtyRows() const = 0;
+
         /**
          * @brief Returns a pointer to the keypad buffer.
          * @return Pointer to the keypad buffer (16 keys).
@@ -51,9 +109,18 @@ namespace chip8
         virtual std::uint8_t *GetKeypad() = 0;
 
         /**
-         * @brief Updates the delay timer
+         * @brief Sets the emulated CPU clock.
+         * The 60 Hz timers advance with the executed cycles, so the clock
+         * rate also decides how many cycles make up one timer tick.
+         * @param instructionsPerSecond Clock rate, must be positive.
+         */
+        virtual void SetClockRate(std::uint32_t instructionsPerSecond) = 0;
+
+        /**
+         * @brief Returns the emulated CPU clock.
+         * @return Instructions per second.
          */
-        virtual void UpdateTimers() = 0;
+        virtual std::uint32_t GetClockRate() const = 0;
 
         /**
          * @brief Returns the current value of the sound timer.
@@ -61,6 +128,44 @@ namespace chip8
          */
         virtual std::uint8_t GetSoundTimer() const = 0;
 
+        /**
+         * @brief Returns the number of cycles executed since the last reset.
+         * @return Cycle count.
+         */
+        virtual std::uint64_t GetCycleCount() const = 0;
+
+        /**
+         * @brief Seeds the CXNN random generator.
+         * The seed is kept across reset and loadROM, so equal seeds give
+         * equal random sequences.
+         * @param seed Any value, DEFAULT_SEED until set.
+         */
+        virtual void SetSeed(std::uint64_t seed) = 0;
+
+        /**
+         * @brief Captures the complete machine state.
+         * Engine caches and attached trace buffers are not part of the state.
+         * @param snapshot Receives the state.
+         */
+        virtual void SaveState(Snapshot &snapshot) const = 0;
+
+        /**
+         * @brief Restores a state captured by SaveState.
+         * Cached translations are only dropped for memory that differs from
+         * the current contents. Only allocates when that memory is still
+         * shared with a RomImage, which takes the private copy of the pages.
+         * States of another version or profile, or with the stack pointer or
+         * pc out of range, are rejected before anything is changed.
+         * @param snapshot State with version SNAPSHOT_VERSION.
+         */
+        virtual void LoadState(const Snapshot &snapshot) = 0;
+
+        /**
+         * @brief Returns the execution statistics since the last reset.
+         * @return Counters, cheap to copy.
+         */
+        virtual PerfCounters GetPerfCounters() const = 0;
+
         /**
          * @brief Destructor.
          */
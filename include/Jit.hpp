@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Decoder.hpp"
+#include "GuestMemory.hpp"
+#include "PerfCounters.hpp"
+#include "Quirks.hpp"
+
+namespace chip8
+{
+    class Chip8;
+
+    /**
+     * @class Jit
+     * @brief x86-64 dynamic recompiler for Chip8 basic blocks.
+     * Register, I, pc and skip/jump opcodes are compiled to native code that
+     * works directly on the fields of Chip8; everything else (DXYN, keys,
+     * memory, calls) calls the interpreter handler from inside the block.
+     * Operations whose quirk differs from Profile::Modern also go through
+     * the handlers, which implement every profile.
+     * A block only starts on a native instruction: addresses whose block
+     * would start with a handler call, or hold a single instruction, are
+     * left to the interpreter, where a run of them costs no more than in
+     * the interpreter engine. Timer operations and invalid opcodes are
+     * never compiled, so no handler called from a block throws.
+     * Guest writes are filtered by code page and drop the blocks covering
+     * the written byte. The code buffer is never writable and executable at
+     * the same time; its pages are only writable while a block is copied in.
+     */
+    class Jit
+    {
+    public:
+        /**
+         * @struct Context
+         * @brief Data the generated code reads its pointers from.
+         */
+        struct Context
+        {
+            std::uint8_t *V;
+            std::uint16_t *I;
+            std::uint16_t *pc;
+            Chip8 *chip;
+        };
+
+        /**
+         * @brief Compiled block; returns the number of guest instructions retired.
+         */
+        using BlockFunction = std::uint32_t (*)(Context *);
+
+        /**
+         * @struct CompiledBlock
+         * @brief Entry point and size of a compiled block.
+         */
+        struct CompiledBlock
+        {
+            BlockFunction function = nullptr;
+            std::uint16_t start = 0;
+            std::uint16_t end = 0;
+            std::uint16_t length = 0;
+            std::uint32_t firstFamily = 0; ///< Index of the first family count in the pool.
+            std::uint8_t familyCount = 0;  ///< Number of family counts.
+            bool live = false;
+        };
+
+        /**
+         * @brief Size of a code page used for invalidation.
+         */
+        static constexpr std::size_t PAGE_SIZE = 256;
+
+        /**
+         * @brief Checks if native code can be generated on this host.
+         * @return true on x86-64 System V and Windows targets.
+         */
+        static bool IsSupported();
+
+        /**
+         * @brief Constructor for the Jit class.
+         * @param chip Chip the generated code operates on.
+         * @param V Register file of chip.
+         * @param I Address register of chip.
+         * @param pc Program counter of chip.
+         * @param memorySize Size of the guest memory in bytes.
+         * @param quirks Quirks of the chip's profile.
+         */
+        Jit(Chip8 &chip, std::uint8_t *V, std::uint16_t *I, std::uint16_t *pc, std::size_t memorySize,
+            const Quirks &quirks);
+        ~Jit();
+
+        Jit(const Jit &) = delete;
+        Jit &operator=(const Jit &) = delete;
+
+        /**
+         * @brief Returns the live block starting at pc.
+         * @param pc Guest address.
+         * @return Block or nullptr.
+         */
+        const CompiledBlock *Find(std::uint16_t pc) const
+        {
+            const std::int32_t index = lookup[pc];
+            return index < 0 ? nullptr : &blocks[index];
+        }
+
+        /**
+         * @brief Checks if the instruction at pc is left to the interpreter.
+         */
+        bool IsInterpreted(std::uint16_t pc) const
+        {
+            return lookup[pc] == INTERPRETED;
+        }
+
+        /**
+         * @brief Compiles the block starting at pc.
+         * @param memory Guest memory.
+         * @param pc Guest address, pc + 1 must be inside memory.
+         * @return Compiled block, nullptr if pc is left to the interpreter.
+         */
+        const CompiledBlock *Compile(const GuestMemory &memory, std::uint16_t pc);
+
+        /**
+         * @brief Runs a compiled block.
+         * @param block Block returned by Find or Compile.
+         * @return Number of guest instructions retired.
+         */
+        std::uint32_t Run(const CompiledBlock &block)
+        {
+            return block.function(&context);
+        }
+
+        /**
+         * @brief Returns the instructions of a block per opcode family.
+         */
+        const FamilyCount *Families(const CompiledBlock &block) const
+        {
+            return &familyCounts[block.firstFamily];
+        }
+
+        /**
+         * @brief Drops the blocks covering a written address.
+         * Only pages holding compiled code or interpreted instructions are searched.
+         * @param address Written guest address.
+         */
+        void Invalidate(std::uint16_t address)
+        {
+            if (codePages[address / PAGE_SIZE])
+            {
+                drop(address);
+            }
+        }
+
+        /**
+         * @brief Drops all blocks and releases their code.
+         */
+        void Clear();
+
+    private:
+        /**
+         * @brief Lookup entry of an address left to the interpreter.
+         */
+        static constexpr std::int32_t INTERPRETED = -2;
+
+        void drop(std::uint16_t address);
+
+        Context context;
+        Quirks quirks;
+        std::uint8_t *code = nullptr;
+        std::size_t codeSize = 0;
+        std::size_t codeUsed = 0;
+        std::vector<std::int32_t> lookup;
+        std::vector<CompiledBlock> blocks;
+        std::vector<std::vector<std::int32_t>> pageBlocks;
+        std::vector<std::uint8_t> codePages;  ///< Set for pages with blocks or interpreted instructions.
+        std::vector<Instruction> instructions;
+        std::vector<FamilyCount> familyCounts;
+    };
+}
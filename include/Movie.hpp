@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "IChip8.hpp"
+
+namespace chip8
+{
+    /**
+     * @struct InputEvent
+     * @brief Keypad change in an input movie.
+     */
+    struct InputEvent
+    {
+        std::uint64_t cycle;   ///< Cycle count at which the keys take effect.
+        std::uint16_t keys;    ///< Keys held from then on, bit k for key k.
+    };
+
+    /**
+     * @struct Movie
+     * @brief Recorded run: the setup, every keypad change keyed by cycle
+     * and hashes of the first and last state.
+     * Timers and the random generator only depend on the executed cycles
+     * and the seed, so replaying the events reproduces the run exactly,
+     * at any speed and with any engine.
+     */
+    struct Movie
+    {
+        std::uint64_t seed = 0;          ///< Seed passed to IChip::SetSeed.
+        std::uint32_t clockRate = 0;     ///< Clock rate passed to IChip::SetClockRate.
+        std::uint64_t initialHash = 0;   ///< HashSnapshot after loading, seeding and clocking.
+        std::uint64_t cycles = 0;        ///< Length of the run.
+        std::uint64_t finalHash = 0;     ///< HashSnapshot at the end of the run.
+        std::vector<InputEvent> events;  ///< Keypad changes in cycle order.
+
+        /**
+         * @brief Starts a recording of a freshly set up chip.
+         * @param chip Chip with the ROM loaded, seed and clock rate set.
+         * @param chipSeed Seed the chip was given.
+         */
+        void Begin(const IChip &chip, std::uint64_t chipSeed);
+
+        /**
+         * @brief Appends an event if the keys differ from the last recorded ones.
+         * @param cycle Current cycle count of the chip.
+         * @param keypad The chip's 16 keys.
+         */
+        void Record(std::uint64_t cycle, const std::uint8_t *keypad);
+
+        /**
+         * @brief Completes the recording with the final state of the chip.
+         * @param chip Recorded chip.
+         */
+        void End(const IChip &chip);
+    };
+
+    /**
+     * @brief Packs 16 key states into a bitmask, bit k for key k.
+     */
+    std::uint16_t PackKeypad(const std::uint8_t *keypad);
+
+    /**
+     * @brief Sets 16 key states from a PackKeypad bitmask.
+     */
+    void UnpackKeypad(std::uint16_t keys, std::uint8_t *keypad);
+
+    /**
+     * @brief Returns the HashSnapshot of the current state of a chip.
+     * The redraw state is left out, since frontends clear it as they present.
+     */
+    std::uint64_t HashState(const IChip &chip);
+
+    /**
+     * @brief Replays a movie on a chip with the movie's ROM loaded.
+     * Seeds and clocks the chip as recorded, then runs it with the keypad
+     * driven by the events. Throws if the chip does not start from the
+     * recorded state.
+     * @param chip Chip after loadROM.
+     * @param movie Movie to replay.
+     * @return HashSnapshot of the final state, equal to movie.finalHash
+     * when the run was reproduced.
+     */
+    std::uint64_t ReplayMovie(IChip &chip, const Movie &movie);
+
+    /**
+     * @brief Writes a movie to a file.
+     * @param filename Path of the file, overwritten if it exists.
+     * @param movie Movie to store.
+     */
+    void WriteMovie(const std::string &filename, const Movie &movie);
+
+    /**
+     * @brief Reads a movie from a file.
+     * Throws if the file is not a movie or was written by another version.
+     * @param filename Path of the file.
+     * @return Stored movie.
+     */
+    Movie ReadMovie(const std::string &filename);
+}
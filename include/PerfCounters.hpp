@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace chip8
+{
+    /**
+     * @brief Number of opcode families, one per value of the highest nibble.
+     */
+    constexpr std::size_t OPCODE_FAMILIES = 16;
+
+    /**
+     * @brief Returns the family of an opcode, its highest nibble.
+     */
+    constexpr std::size_t OpcodeFamily(std::uint16_t opcode)
+    {
+        return opcode >> 12;
+    }
+
+    /**
+     * @struct FamilyCount
+     * @brief Instructions of one family in a translated block.
+     * Blocks keep these so a whole block is counted with a few additions.
+     */
+    struct FamilyCount
+    {
+        std::uint8_t family;
+        std::uint8_t count;
+    };
+
+    /**
+     * @struct PerfCounters
+     * @brief Execution statistics of a chip, see IChip::GetPerfCounters.
+     * Counted by every engine; reset with the machine, not part of its state.
+     */
+    struct PerfCounters
+    {
+        std::uint64_t cycles = 0;                                ///< Instructions executed.
+        std::array<std::uint64_t, OPCODE_FAMILIES> families{};   ///< Instructions executed per opcode family.
+        std::uint64_t spritesDrawn = 0;                          ///< DXYN executed.
+        std::uint64_t collisions = 0;                            ///< DXYN that set VF.
+        std::uint64_t drawFlagSets = 0;                          ///< Instructions that requested a redraw (DXYN, 00E0).
+        std::uint64_t renders = 0;                               ///< Redraw requests served by ClearDrawFlag.
+        std::uint64_t keyWaitCycles = 0;                         ///< FX0A cycles spent waiting for a key.
+        std::uint64_t timerUnderflows = 0;                       ///< Delay or sound timers that counted down to 0.
+        std::uint64_t idleCycles = 0;                            ///< Cycles fast-forwarded in recognised wait loops.
+
+        /**
+         * @brief Adds the instructions of a translated block to the histogram.
+         */
+        void AddFamilies(const FamilyCount *counts, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                families[counts[i].family] += counts[i].count;
+            }
+        }
+    };
+
+    /**
+     * @brief Appends the non-zero entries of a block histogram to a pool.
+     * @param histogram Instructions per family of one block.
+     * @param pool Receives the entries.
+     * @return Number of entries appended.
+     */
+    std::uint8_t AppendFamilyCounts(const std::array<std::uint8_t, OPCODE_FAMILIES> &histogram,
+                                    std::vector<FamilyCount> &pool);
+
+    /**
+     * @brief Prints the counters and the non-empty histogram entries.
+     * @param out Stream to print to.
+     * @param counters Counters to print.
+     */
+    void PrintPerfCounters(std::ostream &out, const PerfCounters &counters);
+}
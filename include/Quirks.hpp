@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace chip8
+{
+    /**
+     * @struct Quirks
+     * @brief Behaviours in which CHIP-8 interpreters disagree.
+     * All false is the behaviour of Profile::Modern.
+     */
+    struct Quirks
+    {
+        bool vfReset = false;           ///< 8XY1, 8XY2 and 8XY3 clear VF.
+        bool shiftVy = false;           ///< 8XY6 and 8XYE shift Vy into Vx instead of shifting Vx.
+        bool memoryIncrementsI = false; ///< FX55 and FX65 leave I past the last register.
+        bool clipSprites = false;       ///< DXYN cuts sprites at the screen edges instead of wrapping them.
+        bool jumpVx = false;            ///< BNNN jumps to XNN + VX instead of NNN + V0.
+    };
+
+    /**
+     * @brief Quirk sets of the interpreters ROMs are written for.
+     * Each profile gets its own handler instantiation, see Chip8::Ops.
+     */
+    enum class Profile : std::uint8_t
+    {
+        Modern,    ///< Behaviour of most current interpreters and of this emulator so far.
+        CosmacVip, ///< Original COSMAC VIP interpreter.
+        SuperChip, ///< SUPER-CHIP 1.1 in low resolution.
+    };
+
+    /**
+     * @brief Number of profiles.
+     */
+    constexpr std::size_t PROFILE_COUNT = 3;
+
+    /**
+     * @brief Returns the quirks of a profile.
+     */
+    constexpr Quirks GetQuirks(Profile profile)
+    {
+        switch (profile)
+        {
+        case Profile::CosmacVip:
+            return Quirks{true, true, true, true, false};
+        case Profile::SuperChip:
+            return Quirks{false, false, false, true, true};
+        case Profile::Modern:
+        default:
+            return Quirks{};
+        }
+    }
+
+    /**
+     * @brief Parses a profile name as accepted on the command line.
+     * @param name "modern", "vip" or "schip".
+     * @param profile Receives the parsed profile.
+     * @return true if the name is known.
+     */
+    bool ParseProfile(const std::string &name, Profile &profile);
+
+    /**
+     * @brief Returns the command line name of a profile.
+     * @param profile Profile.
+     * @return Profile name.
+     */
+    const char *ProfileName(Profile profile);
+}
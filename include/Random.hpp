@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace chip8
+{
+    /**
+     * @brief State of the xoshiro128** generator behind CXNN.
+     */
+    using RandomState = std::array<std::uint32_t, 4>;
+
+    /**
+     * @brief Seed used by a freshly constructed machine.
+     */
+    constexpr std::uint64_t DEFAULT_SEED = 0x2545F4914F6CDD1Dull;
+
+    /**
+     * @brief Expands a seed into a generator state with splitmix64.
+     * Any seed is usable, including 0.
+     * @param seed Any value.
+     * @return Generator state.
+     */
+    inline RandomState SeedRandom(std::uint64_t seed)
+    {
+        RandomState state{};
+
+        for (std::size_t i = 0; i < state.size(); i += 2)
+        {
+            seed += 0x9E3779B97F4A7C15ull;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+
+            state[i] = static_cast<std::uint32_t>(z);
+            state[i + 1] = static_cast<std::uint32_t>(z >> 32);
+        }
+
+        return state;
+    }
+
+    /**
+     * @brief Advances the generator (xoshiro128**) and returns 32 random bits.
+     */
+    inline std::uint32_t NextRandom(RandomState &s)
+    {
+        const auto rotl = [](std::uint32_t x, int k)
+        { return (x << k) | (x >> (32 - k)); };
+
+        const std::uint32_t result = rotl(s[1] * 5, 7) * 9;
+        const std::uint32_t t = s[1] << 9;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+
+        return result;
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "Snapshot.hpp"
+
+namespace chip8
+{
+    /**
+     * @struct RewindStats
+     * @brief Recording counters of a RewindBuffer.
+     */
+    struct RewindStats
+    {
+        std::uint64_t frames = 0;          ///< Frames pushed since construction.
+        std::uint64_t keyframes = 0;       ///< Frames stored as keyframes.
+        std::uint64_t encodedBytes = 0;    ///< Bytes produced by the encoder.
+        std::uint64_t evictedFrames = 0;   ///< Frames dropped to stay within the budget.
+
+        /**
+         * @brief Returns the mean encoded size of a frame.
+         */
+        double BytesPerFrame() const
+        {
+            return frames == 0 ? 0.0 : static_cast<double>(encodedBytes) / static_cast<double>(frames);
+        }
+    };
+
+    /**
+     * @class RewindBuffer
+     * @brief Frame history for stepping the machine back in time.
+     * Every keyframeInterval-th frame is a keyframe; the others are stored
+     * as the XOR of the state with their keyframe, run-length encoded so
+     * the unchanged bulk of memory and screen costs a few bytes. Any frame
+     * is rebuilt from its keyframe and its own delta, so stepping back
+     * costs the same however far back it goes. The oldest keyframe and its
+     * deltas are dropped when the buffer exceeds its budget.
+     */
+    class RewindBuffer
+    {
+    public:
+        /**
+         * @brief Default number of frames between keyframes (1 s at 60 Hz).
+         */
+        static constexpr std::size_t DEFAULT_KEYFRAME_INTERVAL = 60;
+
+        /**
+         * @brief Constructor for the RewindBuffer class.
+         * @param budgetBytes Maximum bytes of encoded frames to keep; the
+         * newest keyframe and its deltas are always kept.
+         * @param keyframeInterval Frames per keyframe, must be positive.
+         */
+        explicit RewindBuffer(std::size_t budgetBytes, std::size_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+        /**
+         * @brief Records the state of the next frame.
+         * @param snapshot State captured by IChip::SaveState.
+         */
+        void Push(const Snapshot &snapshot);
+
+        /**
+         * @brief Steps back and drops the frames after the target.
+         * The target frame stays recorded as the newest one.
+         * @param count Number of frames to go back, clamped to the oldest kept frame.
+         * @param snapshot Receives the state of the target frame.
+         * @return false if nothing is recorded.
+         */
+        bool StepBack(std::size_t count, Snapshot &snapshot);
+
+        /**
+         * @brief Drops all recorded frames.
+         */
+        void Clear();
+
+        /**
+         * @brief Returns the number of frames that can be restored.
+         */
+        std::size_t GetFrameCount() const;
+
+        /**
+         * @brief Returns the bytes held by the encoded frames.
+         */
+        std::size_t GetRetainedBytes() const;
+
+        /**
+         * @brief Returns the recording counters.
+         */
+        const RewindStats &GetStats() const;
+
+    private:
+        /**
+         * @brief One recorded frame.
+         */
+        struct Frame
+        {
+            std::uint32_t distance;           ///< Frames since its keyframe, 0 for keyframes.
+            std::vector<std::uint8_t> data;   ///< Run-length encoded XOR against the keyframe, or zero.
+        };
+
+        /**
+         * @brief Rebuilds the frame at index into snapshot and makes its keyframe current.
+         */
+        void restore(std::size_t index, Snapshot &snapshot);
+
+        /**
+         * @brief Drops the oldest keyframe group while over budget.
+         */
+        void evict();
+
+        std::size_t budget;
+        std::size_t keyframeInterval;
+        std::deque<Frame> frames;
+        std::size_t retainedBytes = 0;
+
+        /**
+         * @brief State of the newest keyframe, the reference of new deltas.
+         */
+        Snapshot keyframe{};
+
+        /**
+         * @brief Frames recorded since the newest keyframe, itself included.
+         */
+        std::size_t sinceKeyframe = 0;
+
+        RewindStats stats;
+    };
+}
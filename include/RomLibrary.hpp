@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace chip8
+{
+    /**
+     * @brief Largest ROM that fits between 0x200 and the end of memory.
+     */
+    constexpr std::size_t MAX_ROM_SIZE = 4096 - 512;
+
+    /**
+     * @struct RomImage
+     * @brief Read-only ROM contents shared by all machines running it.
+     * The bytes after size are zero up to MAX_ROM_SIZE, so the image can
+     * be mapped page by page into guest memory, see GuestMemory::Map.
+     */
+    struct RomImage
+    {
+        std::string name;              ///< File name inside the library directory.
+        std::uint64_t hash = 0;        ///< HashRom of the contents.
+        const std::uint8_t *data = nullptr;
+        std::size_t size = 0;
+    };
+
+    /**
+     * @brief Hashes ROM contents (64-bit FNV-1a).
+     */
+    std::uint64_t HashRom(const std::uint8_t *data, std::size_t size);
+
+    /**
+     * @class RomLibrary
+     * @brief Directory of ROMs, each memory-mapped once and indexed by content hash.
+     * Machines load images from the library with IChip::loadROM(const RomImage &),
+     * which maps them without opening or copying a file. Identical files
+     * are stored once. The library must outlive the machines using it.
+     */
+    class RomLibrary
+    {
+    public:
+        /**
+         * @brief Maps every .ch8 file of a directory.
+         * Empty and oversized files are skipped.
+         * @param directory Directory to scan, not recursive.
+         */
+        explicit RomLibrary(const std::string &directory);
+        ~RomLibrary();
+
+        RomLibrary(const RomLibrary &) = delete;
+        RomLibrary &operator=(const RomLibrary &) = delete;
+
+        /**
+         * @brief Returns the image with the given content hash.
+         * @return Image or nullptr.
+         */
+        const RomImage *Find(std::uint64_t hash) const;
+
+        /**
+         * @brief Returns the image of a file of the library.
+         * @param name File name, e.g. "PONG.ch8".
+         * @return Image or nullptr.
+         */
+        const RomImage *FindByName(const std::string &name) const;
+
+        /**
+         * @brief Returns all distinct images, sorted by name.
+         */
+        const std::vector<RomImage> &GetImages() const;
+
+    private:
+        /**
+         * @brief Maps a file and indexes it, unless it is a copy of a mapped one.
+         */
+        void add(const std::filesystem::path &path);
+
+        /**
+         * @brief A mapped file, released with the library.
+         */
+        struct Mapping
+        {
+            const std::uint8_t *address;
+            std::size_t length;
+        };
+
+        std::vector<RomImage> images;
+        std::vector<Mapping> mappings;
+        std::unordered_map<std::uint64_t, std::size_t> byHash;
+        std::unordered_map<std::string, std::size_t> byName;
+    };
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace chip8
+{
+    /**
+     * @struct PacingStats
+     * @brief Wake-up accuracy of the frame pacer.
+     * Jitter is the distance between a frame deadline and the moment the
+     * pacer actually returned.
+     */
+    struct PacingStats
+    {
+        std::uint64_t frames = 0;      ///< Frames paced.
+        std::uint64_t lateFrames = 0;  ///< Frames whose deadline had already passed.
+        std::uint64_t resyncs = 0;     ///< Times the schedule was reset after falling behind.
+        double totalJitterUs = 0.0;    ///< Sum of the jitter of all frames.
+        double maxJitterUs = 0.0;      ///< Worst jitter observed.
+
+        /**
+         * @brief Returns the mean jitter in microseconds.
+         */
+        double MeanJitterUs() const
+        {
+            return frames == 0 ? 0.0 : totalJitterUs / frames;
+        }
+    };
+
+    /**
+     * @class Scheduler
+     * @brief Splits the CPU clock into per-frame batches and paces host frames.
+     * The emulator runs CyclesForFrame() cycles, presents, and calls
+     * WaitForNextFrame(); the pacer sleeps most of the remaining time and
+     * spins the last part for a precise wake-up.
+     */
+    class Scheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Default host frame rate.
+         */
+        static constexpr std::uint32_t DEFAULT_FRAME_RATE = 60;
+
+        /**
+         * @brief Time before a deadline at which sleeping stops and spinning starts.
+         */
+        static constexpr std::chrono::microseconds SPIN_THRESHOLD{1500};
+
+        /**
+         * @brief Constructor for the Scheduler class.
+         * @param instructionsPerSecond CPU clock, must be positive.
+         * @param framesPerSecond Host frame rate, must be positive.
+         */
+        explicit Scheduler(std::uint32_t instructionsPerSecond, std::uint32_t framesPerSecond = DEFAULT_FRAME_RATE);
+
+        /**
+         * @brief Returns the number of cycles to run in the next frame.
+         * The fractional remainder is carried over, so exactly
+         * instructionsPerSecond cycles are handed out per second.
+         * @return Cycle budget of the frame.
+         */
+        std::uint64_t CyclesForFrame();
+
+        /**
+         * @brief Blocks until the deadline of the next frame.
+         * When more than a frame behind, the schedule restarts from now
+         * instead of running frames back to back to catch up.
+         */
+        void WaitForNextFrame();
+
+        /**
+         * @brief Starts the frame schedule over from now.
+         * Used when pacing resumes after running unpaced, so the frames
+         * run meanwhile are not counted as late.
+         */
+        void Restart();
+
+        /**
+         * @brief Changes the CPU clock, keeping the frame schedule.
+         * @param instructionsPerSecond CPU clock, must be positive.
+         */
+        void SetClockRate(std::uint32_t instructionsPerSecond);
+
+        /**
+         * @brief Returns the pacing statistics collected so far.
+         */
+        const PacingStats &GetStats() const;
+
+    private:
+        std::uint32_t clockRate;
+        std::uint32_t frameRate;
+        std::uint32_t cycleRemainder = 0;
+        Clock::duration framePeriod;
+        Clock::time_point deadline;
+        PacingStats stats;
+    };
+
+    /**
+     * @class FrameSkipper
+     * @brief Picks the frames to present when emulation runs unpaced.
+     * Every Nth emulated frame is presented, with N adapted after each
+     * present so rendering takes at most a fixed share of the wall time
+     * at the current emulation speed.
+     */
+    class FrameSkipper
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Default share of the wall time rendering may take.
+         */
+        static constexpr double DEFAULT_RENDER_SHARE = 0.25;
+
+        /**
+         * @brief Constructor for the FrameSkipper class.
+         * @param renderShare Share of the wall time rendering may take, in (0, 1].
+         */
+        explicit FrameSkipper(double renderShare = DEFAULT_RENDER_SHARE);
+
+        /**
+         * @brief Checks if a frame is due for presenting.
+         * @param sequence Number of the newest emulated frame.
+         */
+        bool IsDue(std::uint64_t sequence) const
+        {
+            return sequence - lastSequence >= interval;
+        }
+
+        /**
+         * @brief Records a present and adapts the interval.
+         * @param sequence Number of the presented frame.
+         * @param renderTime Time the present took.
+         */
+        void Presented(std::uint64_t sequence, Clock::duration renderTime);
+
+        /**
+         * @brief Starts over presenting every frame, e.g. when pacing resumes.
+         * @param sequence Number of the newest emulated frame.
+         */
+        void Reset(std::uint64_t sequence);
+
+        /**
+         * @brief Returns N, the current distance between presented frames.
+         */
+        std::uint64_t GetInterval() const;
+
+    private:
+        double renderShare;
+        std::uint64_t interval = 1;
+        std::uint64_t lastSequence = 0;
+        Clock::time_point lastPresent;
+
+        /**
+         * @brief Moving average of the render time in seconds, negative before the first present.
+         */
+        double renderSeconds = -1.0;
+    };
+}
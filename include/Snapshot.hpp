@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "FrameBuffer.hpp"
+#include "Random.hpp"
+
+namespace chip8
+{
+    /**
+     * @brief Layout version of Snapshot, bumped whenever a field changes.
+     */
+    constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+
+    /**
+     * @struct Snapshot
+     * @brief Complete machine state of a Chip8, see IChip::SaveState.
+     * Fields are ordered by size so the blob has no padding; it is copied
+     * and written to disk as raw bytes.
+     */
+    struct Snapshot
+    {
+        std::uint32_t version;            ///< SNAPSHOT_VERSION of the writer.
+        std::uint32_t clockRate;          ///< Instructions per second.
+        std::uint64_t cycles;             ///< Cycles executed since reset.
+        std::uint64_t delayTimerSetAt;    ///< Timer tick when the delay timer was set.
+        std::uint64_t soundTimerSetAt;    ///< Timer tick when the sound timer was set.
+        std::uint64_t timerTickBase;      ///< Timer ticks at the last clock rate change.
+        std::uint64_t timerCycleBase;     ///< Cycle count at the last clock rate change.
+        FrameBuffer gfx;                  ///< Packed screen rows.
+        RandomState rngState;             ///< CXNN random generator state.
+        std::uint32_t dirtyRows;          ///< Rows changed since the last ClearDrawFlag.
+        std::uint32_t profile;            ///< Profile of the chip; a state only loads into the same profile.
+        std::array<std::uint16_t, 16> stack;
+        std::uint16_t I;
+        std::uint16_t pc;
+        std::array<std::uint8_t, 4096> memory;
+        std::array<std::uint8_t, 16> V;
+        std::array<std::uint8_t, 16> keypad;
+        std::uint8_t sp;
+        std::uint8_t delayTimer;          ///< Value last written by FX15.
+        std::uint8_t soundTimer;          ///< Value last written by FX18.
+        std::uint8_t drawFlag;            ///< 1 if the screen should be redrawn.
+    };
+
+    static_assert(std::is_trivially_copyable<Snapshot>::value, "Snapshot is copied as raw bytes");
+    static_assert(sizeof(Snapshot) == 4496, "Snapshot must not contain padding");
+    static_assert(sizeof(Snapshot) % sizeof(std::uint64_t) == 0, "Snapshot is hashed a word at a time");
+
+    /**
+     * @brief Returns a 64-bit hash of every byte of a snapshot.
+     */
+    std::uint64_t HashSnapshot(const Snapshot &snapshot);
+
+    /**
+     * @brief Writes a snapshot to a state file.
+     * @param filename Path of the file, overwritten if it exists.
+     * @param snapshot State to store.
+     */
+    void WriteSnapshot(const std::string &filename, const Snapshot &snapshot);
+
+    /**
+     * @brief Reads a snapshot from a state file.
+     * Throws if the file is not a state file or was written by another version.
+     * @param filename Path of the file.
+     * @return Stored state.
+     */
+    Snapshot ReadSnapshot(const std::string &filename);
+}
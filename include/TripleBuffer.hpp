@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace chip8
+{
+    /**
+     * @class TripleBuffer
+     * @brief Lock-free handoff of the latest value from one producer thread to one consumer thread.
+     * The producer fills WriteBuffer() and publishes it; the consumer takes
+     * the most recent publication with Update() and reads ReadBuffer().
+     * Neither side ever waits: values published faster than they are taken
+     * replace each other, and the consumer keeps the last one it took.
+     * A buffer handed back to the producer holds an old value, so it must
+     * be written completely before every Publish().
+     */
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        /**
+         * @brief Returns the buffer the producer fills next.
+         */
+        T &WriteBuffer()
+        {
+            return buffers[writeIndex];
+        }
+
+        /**
+         * @brief Makes the write buffer the latest value and takes a free one.
+         * Producer thread only.
+         */
+        void Publish()
+        {
+            const std::uint8_t previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+            writeIndex = previous & INDEX_MASK;
+        }
+
+        /**
+         * @brief Takes the latest value if one was published since the last call.
+         * Consumer thread only.
+         * @return true if ReadBuffer() changed.
+         */
+        bool Update()
+        {
+            if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            {
+                return false;
+            }
+
+            const std::uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX_MASK;
+            return true;
+        }
+
+        /**
+         * @brief Returns the value taken by the last successful Update().
+         */
+        const T &ReadBuffer() const
+        {
+            return buffers[readIndex];
+        }
+
+    private:
+        static constexpr std::uint8_t INDEX_MASK = 0x3;
+
+        /**
+         * @brief Set in middle while it holds a value the consumer hasn't taken.
+         */
+        static constexpr std::uint8_t FRESH = 0x4;
+
+        std::array<T, 3> buffers{};
+
+        /**
+         * @brief Index of the buffer between the two threads, plus FRESH.
+         */
+        alignas(64) std::atomic<std::uint8_t> middle{1};
+
+        // Each side owns one index, kept on separate cache lines
+        alignas(64) std::uint8_t writeIndex = 0;
+        alignas(64) std::uint8_t readIndex = 2;
+    };
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <SDL.h>
-#include <vector>
+#include <array>
+#include <atomic>
+#include <deque>
 
 #include "IDisplay.hpp"
 
@@ -18,24 +20,93 @@ namespace display
         static constexpr int HEIGHT = 32;
         static constexpr int SCALE = 10;
 
+        /**
+         * @brief Window title.
+         */
+        static constexpr const char *TITLE = "CHIP-8 Emulator";
+
+        /**
+         * @brief Default audio buffer size in samples, about 12 ms at 44.1 kHz.
+         */
+        static constexpr std::uint16_t DEFAULT_AUDIO_SAMPLES = 512;
+
         /**
          * @brief Constructor for the Display class.
+         * @param audioSamples Audio buffer size in samples; bounds the delay
+         * between a sound timer change and the tone starting or stopping.
          */
-        explicit Display();
+        explicit Display(std::uint16_t audioSamples = DEFAULT_AUDIO_SAMPLES);
         ~Display() override;
 
         void Clear() override;
-        void Render(const std::uint8_t *gfx) override;
+        bool Render(const std::uint64_t *gfx, std::uint32_t dirtyRows) override;
         bool IsRunning() const override;
         void HandleEvents(std::uint8_t *keypad) override;
-        void Beep() override;
+        Command PollCommand() override;
+        void SetSoundActive(bool active) override;
+        void SetTitle(const std::string &title) override;
 
     private:
+        /**
+         * @brief Converts the dirty rows to texels and uploads them to the texture.
+         */
+        void uploadRows(const std::uint64_t *gfx, std::uint32_t dirtyRows);
+
+        /**
+         * @brief Audio device callback, runs on the audio thread.
+         */
+        static void SDLCALL audioCallback(void *userdata, Uint8 *stream, int length);
+
+        /**
+         * @brief Synthesizes the next samples of the tone.
+         */
+        void synthesize(Sint16 *samples, int count);
+
         SDL_Window *window = nullptr;
         SDL_Renderer *renderer = nullptr;
+
+        /**
+         * @brief 64x32 streaming texture scaled to the window on present.
+         */
+        SDL_Texture *texture = nullptr;
+
+        /**
+         * @brief Staging texels of the whole screen (ARGB8888).
+         */
+        std::array<Uint32, WIDTH * HEIGHT> pixels{};
+
+        /**
+         * @brief Minimum time between two presents, in performance counter ticks.
+         */
+        Uint64 presentInterval = 0;
+
+        /**
+         * @brief Performance counter value of the last present.
+         */
+        Uint64 lastPresent = 0;
+
+        /**
+         * @brief Hotkey commands not yet returned by PollCommand.
+         */
+        std::deque<Command> commands;
+
+        /**
+         * @brief True while the rewind key is held down.
+         */
+        bool rewindHeld = false;
+
         bool running = true;
         SDL_AudioDeviceID audioDevice = 0;
         SDL_AudioSpec audioSpec{};
-        std::vector<std::uint8_t> audioBuffer;
+
+        /**
+         * @brief Set by SetSoundActive, read by the audio callback.
+         */
+        std::atomic<bool> soundActive{false};
+
+        // Owned by the audio callback; the phase carries over between
+        // buffers so the wave never jumps
+        double tonePhase = 0.0;
+        float toneGain = 0.0f;
     };
 }
@@ -1,9 +1,23 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
 
 namespace display
 {
+    /**
+     * @brief Frontend actions bound to hotkeys, see IDisplay::PollCommand.
+     */
+    enum class Command
+    {
+        None,
+        SaveState,
+        LoadState,
+        Rewind,   ///< Sent once per HandleEvents while the rewind key is held.
+        PrintStats,
+        Turbo,    ///< Toggles unpaced emulation.
+    };
+
     /**
      * @brief Interface for the display system of CHIP-8.
      */
@@ -22,6 +36,12 @@ namespace display
          */
         virtual void HandleEvents(std::uint8_t *keypad) = 0;
 
+        /**
+         * @brief Returns the next hotkey command received by HandleEvents.
+         * @return Oldest pending command, Command::None when there is none.
+         */
+        virtual Command PollCommand() = 0;
+
         /**
          * @brief Clears the display.
          * Sets the whole display to black.
@@ -30,14 +50,27 @@ namespace display
 
         /**
          * @brief Renders the graphic buffor.
-         * @param Pointer to the 64 x 32 buffor containing 0 and 1.
+         * Presentation may be throttled; a frame that is not presented must be
+         * passed again with its dirty rows still set.
+         * @param gfx Pointer to the 32 packed rows of 64 pixels, most significant bit leftmost.
+         * @param dirtyRows Rows changed since the last presented frame, bit y for row y.
+         * @return true if the frame was presented.
+         */
+        virtual bool Render(const std::uint64_t *gfx, std::uint32_t dirtyRows) = 0;
+
+        /**
+         * @brief Starts or stops the tone.
+         * Only sets a flag read by the audio device, so it is cheap and may
+         * be called from any thread.
+         * @param active true while the sound timer is running.
          */
-        virtual void Render(const std::uint8_t *gfx) = 0;
+        virtual void SetSoundActive(bool active) = 0;
 
         /**
-         * @brief Calls a sound via SDL2.
+         * @brief Sets the window title, e.g. to show the emulation speed.
+         * @param title New title.
          */
-        virtual void Beep() = 0;
+        virtual void SetTitle(const std::string &title) = 0;
 
         /**
          * @brief Destructor.
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+#include "IDisplay.hpp"
+
+namespace display
+{
+    /**
+     * @class NullDisplay
+     * @brief Headless display that discards all output.
+     * Used to run the emulator without a window or audio device.
+     */
+    class NullDisplay final : public IDisplay
+    {
+    public:
+        /**
+         * @brief Constructor for the NullDisplay class.
+         */
+        explicit NullDisplay() = default;
+
+        void Clear() override;
+        bool Render(const std::uint64_t *gfx, std::uint32_t dirtyRows) override;
+        bool IsRunning() const override;
+        void HandleEvents(std::uint8_t *keypad) override;
+        Command PollCommand() override;
+        void SetSoundActive(bool active) override;
+        void SetTitle(const std::string &title) override;
+
+        /**
+         * @brief Returns the number of frames passed to Render.
+         * @return Render count.
+         */
+        std::uint64_t GetRenderCount() const;
+
+    private:
+        std::uint64_t renderCount = 0;
+    };
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Tracing is compiled out unless the build defines CHIP8_TRACE=1
+ * (CMake option CHIP8_ENABLE_TRACE).
+ */
+#ifndef CHIP8_TRACE
+#define CHIP8_TRACE 0
+#endif
+
+namespace trace
+{
+    /**
+     * @brief Register index stored in a record when no register changed.
+     */
+    constexpr std::uint8_t NO_REGISTER = 0xFF;
+
+    /**
+     * @struct TraceRecord
+     * @brief Fixed-size binary record of one executed instruction.
+     */
+    struct TraceRecord
+    {
+        std::uint64_t cycle;    ///< Cycle number of the instruction.
+        std::uint16_t pc;       ///< Address the opcode was fetched from.
+        std::uint16_t opcode;   ///< Executed opcode.
+        std::uint16_t I;        ///< Value of I after execution.
+        std::uint8_t reg;       ///< Index of the changed V register or NO_REGISTER.
+        std::uint8_t value;     ///< New value of the changed register.
+    };
+
+    static_assert(sizeof(TraceRecord) == 16, "TraceRecord must stay 16 bytes");
+    static_assert(std::is_trivially_copyable<TraceRecord>::value, "TraceRecord is dumped as raw bytes");
+
+    /**
+     * @class TraceBuffer
+     * @brief Lock-free single-producer ring buffer of trace records.
+     * The producer never blocks: once the buffer is full the oldest
+     * records are overwritten.
+     */
+    class TraceBuffer
+    {
+    public:
+        /**
+         * @brief Constructor for the TraceBuffer class.
+         * @param capacity Number of records, rounded up to a power of two.
+         */
+        explicit TraceBuffer(std::size_t capacity = 1 << 16);
+
+        /**
+         * @brief Appends a record. Must only be called by one thread.
+         * @param record Record to store.
+         */
+        void Push(const TraceRecord &record) noexcept
+        {
+            const std::uint64_t h = head.load(std::memory_order_relaxed);
+            slots[h & mask] = record;
+            head.store(h + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Copies the retained records, oldest first.
+         * @return Records currently held by the buffer.
+         */
+        std::vector<TraceRecord> Snapshot() const;
+
+        /**
+         * @brief Returns the number of records pushed since construction.
+         */
+        std::uint64_t Total() const noexcept
+        {
+            return head.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::vector<TraceRecord> slots;
+        std::uint64_t mask = 0;
+        std::atomic<std::uint64_t> head{0};
+    };
+
+    /**
+     * @brief Writes records to a binary dump file.
+     * @param filename Output path.
+     * @param records Records to write.
+     */
+    void WriteDump(const std::string &filename, const std::vector<TraceRecord> &records);
+
+    /**
+     * @brief Reads records from a binary dump file.
+     * @param filename Input path.
+     * @return Records stored in the dump.
+     */
+    std::vector<TraceRecord> ReadDump(const std::string &filename);
+}
@@ -0,0 +1,44 @@
+#include <vector>
+
+#include "Aot.hpp"
+
+namespace
+{
+    /**
+     * @brief Registered programs.
+     * A function-local static, so it exists before the static initialisers
+     * of generated sources register into it.
+     */
+    std::vector<const chip8::AotProgram *> &Programs()
+    {
+        static std::vector<const chip8::AotProgram *> programs;
+        return programs;
+    }
+}
+
+namespace chip8
+{
+    bool RegisterAotProgram(const AotProgram &program)
+    {
+        Programs().push_back(&program);
+        return true;
+    }
+
+    const AotProgram *FindAotProgram(std::uint64_t romHash, Profile profile)
+    {
+        for (const AotProgram *program : Programs())
+        {
+            if (program->romHash == romHash && program->profile == profile)
+            {
+                return program;
+            }
+        }
+
+        return nullptr;
+    }
+
+    std::size_t GetAotProgramCount()
+    {
+        return Programs().size();
+    }
+}
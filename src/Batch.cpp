@@ -0,0 +1,757 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "Batch.hpp"
+#include "Chip8.hpp"
+#include "Disassembler.hpp"
+
+namespace chip8
+{
+    namespace
+    {
+        /**
+         * @brief Returns taken for active lanes and kept otherwise.
+         * Written with bit masks rather than a branch so that the dense lane
+         * loops if-convert into vector blends.
+         */
+        template <typename T>
+        T Select(bool active, T taken, T kept)
+        {
+            const T bits = static_cast<T>(0 - static_cast<T>(active));
+            return static_cast<T>((taken & bits) | (kept & static_cast<T>(~bits)));
+        }
+
+        /**
+         * @brief Returns whether every lane executing op ends up at the same
+         * next pc, so a group that held all runnable lanes still does.
+         */
+        bool KeepsLanesTogether(Op op)
+        {
+            switch (op)
+            {
+            case Op::RET:
+            case Op::SE_VX_NN:
+            case Op::SNE_VX_NN:
+            case Op::SE_VX_VY:
+            case Op::SNE_VX_VY:
+            case Op::JP_V0_NNN:
+            case Op::SKP_VX:
+            case Op::SKNP_VX:
+            case Op::LD_VX_K:
+            case Op::Invalid:
+                return false;
+            default:
+                return true;
+            }
+        }
+    }
+
+    BatchChip8::BatchChip8(std::size_t laneCount)
+        : lanes(laneCount), clockRate(Chip8::DEFAULT_CLOCK_RATE)
+    {
+        if (lanes == 0)
+        {
+            throw std::invalid_argument("Batch needs at least one lane");
+        }
+
+        memory.resize(lanes * MEMORY_SIZE);
+        V.resize(16 * lanes);
+        I.resize(lanes);
+        pc.resize(lanes);
+        stack.resize(16 * lanes);
+        sp.resize(lanes);
+        delayTimer.resize(lanes);
+        soundTimer.resize(lanes);
+        delayTimerSetAt.resize(lanes);
+        soundTimerSetAt.resize(lanes);
+        timerTickBase.resize(lanes);
+        timerCycleBase.resize(lanes);
+        gfx.resize(SCREEN_HEIGHT * lanes);
+        keys.resize(lanes);
+        rngState.resize(4 * lanes);
+        cycles.resize(lanes);
+        target.resize(lanes);
+        halted.resize(lanes);
+        memoryWritten.resize(lanes);
+        faults.resize(lanes);
+        mask.resize(lanes);
+        scheduled.resize(lanes);
+
+        reset();
+    }
+
+    void BatchChip8::reset()
+    {
+        auto prototype = std::make_unique<Chip8>();
+        prototype->reset();
+        assign(*prototype);
+    }
+
+    void BatchChip8::loadROM(const std::uint8_t *data, std::size_t size)
+    {
+        auto prototype = std::make_unique<Chip8>();
+        prototype->loadROM(data, size);
+        assign(*prototype);
+    }
+
+    void BatchChip8::assign(const Chip8 &prototype)
+    {
+        // Every lane starts as a copy of a freshly reset Chip8, so font,
+        // registers and RNG state match the single-machine interpreter
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            prototype.memory.CopyTo(&memory[lane * MEMORY_SIZE]);
+
+            for (std::size_t x = 0; x < 16; ++x)
+            {
+                V[x * lanes + lane] = prototype.V[x];
+                stack[x * lanes + lane] = prototype.stack[x];
+            }
+
+            for (std::size_t row = 0; row < SCREEN_HEIGHT; ++row)
+            {
+                gfx[row * lanes + lane] = prototype.gfx[row];
+            }
+
+            for (std::size_t word = 0; word < prototype.rngState.size(); ++word)
+            {
+                rngState[word * lanes + lane] = prototype.rngState[word];
+            }
+        }
+
+        std::fill(I.begin(), I.end(), prototype.I);
+        std::fill(pc.begin(), pc.end(), prototype.pc);
+        std::fill(sp.begin(), sp.end(), prototype.sp);
+        std::fill(delayTimer.begin(), delayTimer.end(), prototype.delay_timer);
+        std::fill(soundTimer.begin(), soundTimer.end(), prototype.sound_timer);
+        std::fill(delayTimerSetAt.begin(), delayTimerSetAt.end(), 0);
+        std::fill(soundTimerSetAt.begin(), soundTimerSetAt.end(), 0);
+        std::fill(timerTickBase.begin(), timerTickBase.end(), 0);
+        std::fill(timerCycleBase.begin(), timerCycleBase.end(), 0);
+        std::fill(keys.begin(), keys.end(), 0);
+        std::fill(cycles.begin(), cycles.end(), 0);
+        std::fill(target.begin(), target.end(), 0);
+        std::fill(halted.begin(), halted.end(), 0);
+        std::fill(memoryWritten.begin(), memoryWritten.end(), 0);
+        std::fill(faults.begin(), faults.end(), std::string());
+        faultCount = 0;
+        anyMemoryWritten = false;
+    }
+
+    std::uint64_t BatchChip8::emulateCycles(std::uint64_t count)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            target[lane] = cycles[lane] + count;
+        }
+
+        const std::uint64_t before = stats.laneCycles;
+        bool regroup = true;
+
+        // While every runnable lane shares one pc and the last instruction
+        // could not separate them, the group stays valid without a rescan
+        while (!regroup || schedule())
+        {
+            if (scheduledCount == 0)
+            {
+                continue;
+            }
+
+            const std::uint8_t *code = &memory[leader * MEMORY_SIZE + pc[leader]];
+            const Instruction in = Decode(code[0] << 8 | code[1]);
+
+            stepFaults = 0;
+            execute(in);
+
+            // Faulted lanes were dropped from the mask
+            std::uint64_t *const laneCycles = cycles.data();
+            const std::uint8_t *const group = mask.data();
+            forLanes([&](std::size_t lane, bool)
+                     { laneCycles[lane] += group[lane]; });
+
+            ++stats.steps;
+            ++(dense ? stats.denseSteps : stats.scalarSteps);
+            stats.laneCycles += scheduledCount - stepFaults;
+
+            regroup = !converged || stepFaults != 0 || anyMemoryWritten || !KeepsLanesTogether(in.op) ||
+                      --groupBudget == 0 || pc[leader] >= MEMORY_SIZE - 1;
+        }
+
+        return stats.laneCycles - before;
+    }
+
+    bool BatchChip8::schedule()
+    {
+        const std::size_t count = lanes;
+        const std::uint8_t *const stopped = halted.data();
+        const std::uint64_t *const done = cycles.data();
+        const std::uint64_t *const until = target.data();
+        const std::uint16_t *const pcs = pc.data();
+        std::uint8_t *const group = mask.data();
+
+        // Lowest pc first: lanes that fell behind a branch catch up and rejoin the others
+        std::uint16_t lowest = 0xFFFF;
+        std::size_t runnable = 0;
+
+        for (std::size_t lane = 0; lane < count; ++lane)
+        {
+            const std::uint8_t ready = (stopped[lane] == 0) & (done[lane] < until[lane]);
+            const std::uint16_t candidate = Select<std::uint16_t>(ready, pcs[lane], 0xFFFF);
+            group[lane] = ready;
+            lowest = std::min(lowest, candidate);
+            runnable += ready;
+        }
+
+        if (runnable == 0)
+        {
+            return false;
+        }
+
+        std::size_t selected = 0;
+        std::uint64_t budget = ~std::uint64_t{0};
+        for (std::size_t lane = 0; lane < count; ++lane)
+        {
+            group[lane] = group[lane] & (pcs[lane] == lowest ? 1 : 0);
+            selected += group[lane];
+            budget = std::min(budget, Select<std::uint64_t>(group[lane], until[lane] - done[lane], ~std::uint64_t{0}));
+        }
+
+        leader = static_cast<std::size_t>(std::find(group, group + count, 1) - group);
+        scheduledCount = selected;
+        groupBudget = budget;
+        converged = selected == runnable;
+
+        if (lowest >= MEMORY_SIZE - 1)
+        {
+            for (std::size_t lane = leader; lane < count; ++lane)
+            {
+                if (group[lane])
+                {
+                    fault(lane, "Program counter out of bounds: " + ToHex(lowest));
+                }
+            }
+
+            scheduledCount = 0;
+            return true;
+        }
+
+        // Lanes that rewrote memory may hold different code at the same pc
+        if (anyMemoryWritten)
+        {
+            const std::uint8_t *code = &memory[leader * MEMORY_SIZE + lowest];
+
+            for (std::size_t lane = leader + 1; lane < count; ++lane)
+            {
+                const std::uint8_t *other = &memory[lane * MEMORY_SIZE + lowest];
+
+                if (group[lane] && (memoryWritten[lane] || memoryWritten[leader]) &&
+                    (other[0] != code[0] || other[1] != code[1]))
+                {
+                    group[lane] = 0;
+                    --scheduledCount;
+                    converged = false;
+                }
+            }
+        }
+
+        // Small groups run from an index list instead of sweeping every lane
+        dense = scheduledCount * SCALAR_RATIO >= lanes;
+        if (!dense)
+        {
+            std::size_t next = 0;
+            for (std::size_t lane = leader; next < scheduledCount; ++lane)
+            {
+                if (group[lane])
+                {
+                    scheduled[next++] = static_cast<std::uint32_t>(lane);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template <typename Body>
+    void BatchChip8::forScheduled(Body body)
+    {
+        if (dense)
+        {
+            for (std::size_t lane = leader; lane < lanes; ++lane)
+            {
+                if (mask[lane])
+                {
+                    body(lane);
+                }
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < scheduledCount; ++i)
+            {
+                body(static_cast<std::size_t>(scheduled[i]));
+            }
+        }
+    }
+
+    template <typename Body>
+    void BatchChip8::forLanes(Body body)
+    {
+        if (dense)
+        {
+            const std::size_t count = lanes;
+            const std::uint8_t *const group = mask.data();
+
+            for (std::size_t lane = 0; lane < count; ++lane)
+            {
+                body(lane, group[lane] != 0);
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < scheduledCount; ++i)
+            {
+                body(static_cast<std::size_t>(scheduled[i]), true);
+            }
+        }
+    }
+
+    void BatchChip8::execute(const Instruction &in)
+    {
+        std::uint8_t *const vx = &V[in.x * lanes];
+        std::uint8_t *const vy = &V[in.y * lanes];
+        std::uint8_t *const vf = &V[0xF * lanes];
+        std::uint8_t *const v0 = &V[0];
+        std::uint16_t *const pcs = pc.data();
+        std::uint16_t *const addr = I.data();
+        std::uint32_t *const rng0 = &rngState[0];
+        std::uint32_t *const rng1 = &rngState[lanes];
+        std::uint32_t *const rng2 = &rngState[2 * lanes];
+        std::uint32_t *const rng3 = &rngState[3 * lanes];
+        const std::uint16_t *const held = keys.data();
+        const std::uint8_t nn = in.nn;
+        const std::uint16_t nnn = in.nnn;
+
+        // Register operations below are written as per-lane selects so the
+        // dense loops compile to masked vector code
+        switch (in.op)
+        {
+        case Op::CLS:
+            for (std::size_t row = 0; row < SCREEN_HEIGHT; ++row)
+            {
+                std::uint64_t *const line = &gfx[row * lanes];
+                forLanes([&](std::size_t lane, bool active)
+                         { line[lane] = Select<std::uint64_t>(active, 0, line[lane]); });
+            }
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::RET:
+            forScheduled([&](std::size_t lane)
+                         {
+                             if (sp[lane] == 0)
+                             {
+                                 fault(lane, "Stack underflow");
+                                 return;
+                             }
+                             --sp[lane];
+                             pcs[lane] = stack[sp[lane] * lanes + lane] + 2; });
+            break;
+
+        case Op::NOP:
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::JP:
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] = Select<std::uint16_t>(active, nnn, pcs[lane]); });
+            break;
+
+        case Op::CALL:
+            forScheduled([&](std::size_t lane)
+                         {
+                             if (sp[lane] >= 16)
+                             {
+                                 fault(lane, "Stack overflow");
+                                 return;
+                             }
+                             stack[sp[lane] * lanes + lane] = pcs[lane];
+                             ++sp[lane];
+                             pcs[lane] = nnn; });
+            break;
+
+        case Op::SE_VX_NN:
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] += Select<std::uint16_t>(active, vx[lane] == nn ? 4 : 2, 0); });
+            break;
+
+        case Op::SNE_VX_NN:
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] += Select<std::uint16_t>(active, vx[lane] != nn ? 4 : 2, 0); });
+            break;
+
+        case Op::SE_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] += Select<std::uint16_t>(active, vx[lane] == vy[lane] ? 4 : 2, 0); });
+            break;
+
+        case Op::LD_VX_NN:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vx[lane] = Select<std::uint8_t>(active, nn, vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::ADD_VX_NN:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vx[lane] = static_cast<std::uint8_t>(vx[lane] + Select<std::uint8_t>(active, nn, 0));
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::LD_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vx[lane] = Select<std::uint8_t>(active, vy[lane], vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::OR_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vx[lane] = Select<std::uint8_t>(active, vx[lane] | vy[lane], vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::AND_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vx[lane] = Select<std::uint8_t>(active, vx[lane] & vy[lane], vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::XOR_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vx[lane] = Select<std::uint8_t>(active, vx[lane] ^ vy[lane], vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::ADD_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         const std::uint16_t sum = vx[lane] + vy[lane];
+                         vf[lane] = Select<std::uint8_t>(active, sum > 0xFF ? 1 : 0, vf[lane]);
+                         vx[lane] = Select<std::uint8_t>(active, static_cast<std::uint8_t>(sum), vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::SUB_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         const std::uint8_t a = vx[lane];
+                         const std::uint8_t b = vy[lane];
+                         vf[lane] = Select<std::uint8_t>(active, a > b ? 1 : 0, vf[lane]);
+                         vx[lane] = Select<std::uint8_t>(active, static_cast<std::uint8_t>(vx[lane] - vy[lane]), vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::SHR_VX:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vf[lane] = Select<std::uint8_t>(active, vx[lane] & 0x1, vf[lane]);
+                         vx[lane] = Select<std::uint8_t>(active, vx[lane] >> 1, vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::SUBN_VX_VY:
+            // Same register order as Chip8: the difference lands in Vy
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         const std::uint8_t a = vx[lane];
+                         const std::uint8_t b = vy[lane];
+                         vf[lane] = Select<std::uint8_t>(active, b > a ? 1 : 0, vf[lane]);
+                         vy[lane] = Select<std::uint8_t>(active, static_cast<std::uint8_t>(vy[lane] - vx[lane]), vy[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::SHL_VX:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         vf[lane] = Select<std::uint8_t>(active, (vx[lane] & 0x80) >> 7, vf[lane]);
+                         vx[lane] = Select<std::uint8_t>(active, static_cast<std::uint8_t>(vx[lane] << 1), vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::SNE_VX_VY:
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] += Select<std::uint16_t>(active, vx[lane] != vy[lane] ? 4 : 2, 0); });
+            break;
+
+        case Op::LD_I_NNN:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         addr[lane] = Select<std::uint16_t>(active, nnn, addr[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::JP_V0_NNN:
+            forLanes([&](std::size_t lane, bool active)
+                     { pcs[lane] = Select<std::uint16_t>(active, static_cast<std::uint16_t>(v0[lane] + nnn), pcs[lane]); });
+            break;
+
+        case Op::RND_VX_NN:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         RandomState state{rng0[lane], rng1[lane], rng2[lane], rng3[lane]};
+                         const std::uint32_t bits = NextRandom(state);
+                         rng0[lane] = Select<std::uint32_t>(active, state[0], rng0[lane]);
+                         rng1[lane] = Select<std::uint32_t>(active, state[1], rng1[lane]);
+                         rng2[lane] = Select<std::uint32_t>(active, state[2], rng2[lane]);
+                         rng3[lane] = Select<std::uint32_t>(active, state[3], rng3[lane]);
+                         vx[lane] = Select<std::uint8_t>(active, static_cast<std::uint8_t>((bits >> 24) & nn), vx[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::DRW:
+            forScheduled([&](std::size_t lane)
+                         {
+                             // Sprites running past 4 KB wrap around like in Chip8
+                             const std::uint8_t *base = &memory[lane * MEMORY_SIZE];
+                             const std::uint8_t x = vx[lane];
+                             const std::uint8_t y = vy[lane];
+                             std::uint64_t collision = 0;
+
+                             for (int yline = 0; yline < in.n; ++yline)
+                             {
+                                 const std::uint64_t bits = SpriteRow(base[(addr[lane] + yline) & (MEMORY_SIZE - 1)], x);
+                                 std::uint64_t &row = gfx[((y + yline) % SCREEN_HEIGHT) * lanes + lane];
+                                 collision |= row & bits;
+                                 row ^= bits;
+                             }
+
+                             vf[lane] = collision != 0 ? 1 : 0;
+                             pcs[lane] += 2; });
+            break;
+
+        case Op::SKP_VX:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         const bool pressed = vx[lane] < 16 && ((held[lane] >> (vx[lane] & 0xF)) & 1) != 0;
+                         pcs[lane] += Select<std::uint16_t>(active, pressed ? 4 : 2, 0); });
+            break;
+
+        case Op::SKNP_VX:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         const bool pressed = vx[lane] < 16 && ((held[lane] >> (vx[lane] & 0xF)) & 1) != 0;
+                         pcs[lane] += Select<std::uint16_t>(active, pressed ? 2 : 4, 0); });
+            break;
+
+        case Op::LD_VX_DT:
+            forScheduled([&](std::size_t lane)
+                         {
+                             vx[lane] = timerValue(lane, delayTimer[lane], delayTimerSetAt[lane]);
+                             pcs[lane] += 2; });
+            break;
+
+        case Op::LD_VX_K:
+            forScheduled([&](std::size_t lane)
+                         {
+                             for (std::uint8_t key = 0; key < 16; ++key)
+                             {
+                                 if ((held[lane] >> key) & 1)
+                                 {
+                                     vx[lane] = key;
+                                     pcs[lane] += 2;
+                                     return;
+                                 }
+                             } });
+            break;
+
+        case Op::LD_DT_VX:
+            forScheduled([&](std::size_t lane)
+                         {
+                             delayTimer[lane] = vx[lane];
+                             delayTimerSetAt[lane] = timerTicks(lane);
+                             pcs[lane] += 2; });
+            break;
+
+        case Op::LD_ST_VX:
+            forScheduled([&](std::size_t lane)
+                         {
+                             soundTimer[lane] = vx[lane];
+                             soundTimerSetAt[lane] = timerTicks(lane);
+                             pcs[lane] += 2; });
+            break;
+
+        case Op::ADD_I_VX:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         addr[lane] = static_cast<std::uint16_t>(addr[lane] + Select<std::uint16_t>(active, vx[lane], 0));
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::LD_F_VX:
+            forLanes([&](std::size_t lane, bool active)
+                     {
+                         addr[lane] = Select<std::uint16_t>(active, static_cast<std::uint16_t>(Chip8::FONTSET_START_ADDRESS + vx[lane] * 5), addr[lane]);
+                         pcs[lane] += Select<std::uint16_t>(active, 2, 0); });
+            break;
+
+        case Op::LD_B_VX:
+            forScheduled([&](std::size_t lane)
+                         {
+                             const std::uint8_t value = vx[lane];
+                             writeMemory(lane, addr[lane], value / 100);
+                             writeMemory(lane, addr[lane] + 1, (value / 10) % 10);
+                             writeMemory(lane, addr[lane] + 2, value % 10);
+                             pcs[lane] += 2; });
+            break;
+
+        case Op::LD_MEM_VX:
+            forScheduled([&](std::size_t lane)
+                         {
+                             for (std::size_t i = 0; i <= in.x; ++i)
+                             {
+                                 writeMemory(lane, addr[lane] + i, V[i * lanes + lane]);
+                             }
+                             pcs[lane] += 2; });
+            break;
+
+        case Op::LD_VX_MEM:
+            forScheduled([&](std::size_t lane)
+                         {
+                             for (std::size_t i = 0; i <= in.x; ++i)
+                             {
+                                 V[i * lanes + lane] = memory[lane * MEMORY_SIZE + ((addr[lane] + i) & (MEMORY_SIZE - 1))];
+                             }
+                             pcs[lane] += 2; });
+            break;
+
+        case Op::Invalid:
+        default:
+            forScheduled([&](std::size_t lane)
+                         { fault(lane, DescribeInvalid(in.opcode)); });
+            break;
+        }
+    }
+
+    void BatchChip8::fault(std::size_t lane, const std::string &message)
+    {
+        halted[lane] = 1;
+        mask[lane] = 0;
+        faults[lane] = message;
+        ++faultCount;
+        ++stepFaults;
+    }
+
+    void BatchChip8::writeMemory(std::size_t lane, std::uint32_t address, std::uint8_t value)
+    {
+        address &= MEMORY_SIZE - 1;
+        memory[lane * MEMORY_SIZE + address] = value;
+        memoryWritten[lane] = 1;
+        anyMemoryWritten = true;
+    }
+
+    std::uint64_t BatchChip8::timerTicks(std::size_t lane) const
+    {
+        return timerTickBase[lane] + (cycles[lane] - timerCycleBase[lane]) * Chip8::TIMER_RATE / clockRate;
+    }
+
+    std::uint8_t BatchChip8::timerValue(std::size_t lane, std::uint8_t value, std::uint64_t setAt) const
+    {
+        const std::uint64_t elapsed = timerTicks(lane) - setAt;
+        return elapsed >= value ? 0 : static_cast<std::uint8_t>(value - elapsed);
+    }
+
+    void BatchChip8::SetClockRate(std::uint32_t instructionsPerSecond)
+    {
+        if (instructionsPerSecond == 0)
+        {
+            throw std::invalid_argument("Clock rate must be positive");
+        }
+
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            timerTickBase[lane] = timerTicks(lane);
+            timerCycleBase[lane] = cycles[lane];
+        }
+
+        clockRate = instructionsPerSecond;
+    }
+
+    void BatchChip8::SetLaneSeed(std::size_t lane, std::uint64_t seed)
+    {
+        if (lane >= lanes)
+        {
+            throw std::out_of_range("Lane out of range: " + std::to_string(lane));
+        }
+
+        const RandomState state = SeedRandom(seed);
+        for (std::size_t word = 0; word < state.size(); ++word)
+        {
+            rngState[word * lanes + lane] = state[word];
+        }
+    }
+
+    void BatchChip8::SetLaneKeys(std::size_t lane, std::uint16_t laneKeys)
+    {
+        keys.at(lane) = laneKeys;
+    }
+
+    std::size_t BatchChip8::GetLaneCount() const
+    {
+        return lanes;
+    }
+
+    std::uint8_t BatchChip8::GetRegister(std::size_t lane, std::uint8_t x) const
+    {
+        return V[(x & 0xF) * lanes + lane];
+    }
+
+    std::uint16_t BatchChip8::GetI(std::size_t lane) const
+    {
+        return I[lane];
+    }
+
+    std::uint16_t BatchChip8::GetPC(std::size_t lane) const
+    {
+        return pc[lane];
+    }
+
+    std::uint64_t BatchChip8::GetCycleCount(std::size_t lane) const
+    {
+        return cycles[lane];
+    }
+
+    const std::uint8_t *BatchChip8::GetMemory(std::size_t lane) const
+    {
+        return &memory[lane * MEMORY_SIZE];
+    }
+
+    void BatchChip8::CopyGfx(std::size_t lane, FrameBuffer &frame) const
+    {
+        for (std::size_t row = 0; row < SCREEN_HEIGHT; ++row)
+        {
+            frame[row] = gfx[row * lanes + lane];
+        }
+    }
+
+    const std::string &BatchChip8::GetFault(std::size_t lane) const
+    {
+        return faults[lane];
+    }
+
+    std::size_t BatchChip8::GetFaultCount() const
+    {
+        return faultCount;
+    }
+
+    const BatchStats &BatchChip8::GetStats() const
+    {
+        return stats;
+    }
+}
@@ -0,0 +1,179 @@
+#include <algorithm>
+
+#include "BlockCache.hpp"
+
+namespace chip8
+{
+    bool EndsBlock(Op op)
+    {
+        switch (op)
+        {
+        case Op::RET:
+        case Op::JP:
+        case Op::CALL:
+        case Op::SE_VX_NN:
+        case Op::SNE_VX_NN:
+        case Op::SE_VX_VY:
+        case Op::SNE_VX_VY:
+        case Op::JP_V0_NNN:
+        case Op::SKP_VX:
+        case Op::SKNP_VX:
+        case Op::LD_VX_DT:
+        case Op::LD_VX_K:
+        case Op::LD_DT_VX:
+        case Op::LD_ST_VX:
+        case Op::LD_B_VX:
+        case Op::LD_MEM_VX:
+        case Op::Invalid:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool UsesTimers(Op op)
+    {
+        return op == Op::LD_VX_DT || op == Op::LD_DT_VX || op == Op::LD_ST_VX;
+    }
+
+    BlockCache::BlockCache(std::size_t memorySize)
+        : lookup(memorySize, -1), coverage(memorySize, 0)
+    {
+        microOps.reserve(MAX_MICRO_OPS);
+        familyCounts.reserve(MAX_MICRO_OPS);
+    }
+
+    const Block *BlockCache::Translate(const GuestMemory &memory, std::uint16_t pc,
+                                       const MicroHandler *handlers, const MicroHandler *bodyHandlers)
+    {
+        if (microOps.size() + MAX_BLOCK_LENGTH > MAX_MICRO_OPS)
+        {
+            Clear();
+        }
+
+        Block block;
+        block.first = static_cast<std::uint32_t>(microOps.size());
+        block.start = pc;
+        block.live = true;
+
+        std::array<std::uint8_t, OPCODE_FAMILIES> histogram{};
+        std::uint32_t address = pc;
+        while (block.length < MAX_BLOCK_LENGTH && address + 1 < lookup.size())
+        {
+            const Instruction instruction = Decode(memory[address] << 8 | memory[address + 1]);
+            microOps.push_back({bodyHandlers[static_cast<std::size_t>(instruction.op)], instruction});
+            ++histogram[OpcodeFamily(instruction.opcode)];
+            ++block.length;
+            address += 2;
+
+            if (EndsBlock(instruction.op))
+            {
+                break;
+            }
+        }
+
+        // The instruction stays covered so a write over it restores the lookup
+        if (block.length == 1)
+        {
+            microOps.pop_back();
+            lookup[pc] = INTERPRETED;
+            ++coverage[pc];
+            ++coverage[pc + 1];
+            ++interpretedCount;
+            return nullptr;
+        }
+
+        block.end = static_cast<std::uint16_t>(address);
+        block.firstFamily = static_cast<std::uint32_t>(familyCounts.size());
+        block.familyCount = AppendFamilyCounts(histogram, familyCounts);
+
+        MicroOp &last = microOps.back();
+        last.handler = handlers[static_cast<std::size_t>(last.instruction.op)];
+
+        for (std::uint32_t i = block.start; i < address; ++i)
+        {
+            ++coverage[i];
+        }
+
+        ++translations;
+
+        // Reuse the slot of a dropped block if there is one
+        std::size_t index = blocks.size();
+        if (!freeSlots.empty())
+        {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+            blocks[index] = block;
+        }
+        else
+        {
+            blocks.push_back(block);
+        }
+
+        lookup[pc] = static_cast<std::int32_t>(index);
+        return &blocks[index];
+    }
+
+    bool BlockCache::drop(std::uint16_t address)
+    {
+        // Interpreted instructions starting at or just before the address
+        for (std::uint32_t start = address > 0 ? address - 1u : 0u; start <= address; ++start)
+        {
+            if (lookup[start] == INTERPRETED)
+            {
+                lookup[start] = -1;
+                --coverage[start];
+                --coverage[start + 1];
+                --interpretedCount;
+            }
+        }
+
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            Block &block = blocks[i];
+            if (!block.live || address < block.start || address >= block.end)
+            {
+                continue;
+            }
+
+            block.live = false;
+            lookup[block.start] = -1;
+
+            for (std::uint32_t a = block.start; a < block.end; ++a)
+            {
+                --coverage[a];
+            }
+
+            freeSlots.push_back(i);
+            ++invalidations;
+        }
+
+        return true;
+    }
+
+    void BlockCache::Clear()
+    {
+        if (blocks.empty() && interpretedCount == 0)
+        {
+            return;
+        }
+
+        std::fill(lookup.begin(), lookup.end(), -1);
+        std::fill(coverage.begin(), coverage.end(), 0);
+        blocks.clear();
+        freeSlots.clear();
+        interpretedCount = 0;
+        microOps.clear();
+        familyCounts.clear();
+    }
+
+    std::uint64_t BlockCache::GetTranslationCount() const
+    {
+        return translations;
+    }
+
+    std::uint64_t BlockCache::GetInvalidationCount() const
+    {
+        return invalidations;
+    }
+}
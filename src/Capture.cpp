@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "Capture.hpp"
+
+namespace
+{
+    constexpr char CAPTURE_MAGIC[4] = {'C', '8', 'V', 'C'};
+    constexpr std::uint32_t CAPTURE_VERSION = 1;
+
+    struct CaptureHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint16_t width;
+        std::uint16_t height;
+        std::uint32_t reserved;
+        std::uint64_t frames;   ///< Filled in when the capture is closed.
+    };
+
+    static_assert(sizeof(CaptureHeader) == 24, "CaptureHeader must not contain padding");
+
+    /**
+     * @brief Sleep of the writer thread when the queue is empty.
+     * A full default queue lasts over a minute at 60 Hz, and still a few
+     * milliseconds at turbo speed.
+     */
+    constexpr std::chrono::milliseconds WRITER_POLL{1};
+
+    /**
+     * @brief Encoded bytes collected before they are written to the file.
+     */
+    constexpr std::size_t OUTPUT_CHUNK = 64 * 1024;
+
+    /**
+     * @brief Longest run of unchanged frames stored in one record.
+     */
+    constexpr std::uint32_t MAX_REPEATS = 0xFFFF;
+
+    constexpr int ROW_BYTES = chip8::SCREEN_WIDTH / 8;
+
+    static_assert(chip8::SCREEN_HEIGHT == 32 && ROW_BYTES == 8, "Records store 32-bit row masks and 8-bit byte masks");
+
+    void PutLittleEndian(std::vector<std::uint8_t> &out, std::uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+        {
+            out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    /**
+     * @brief Returns byte i of a packed row, byte 0 holding the leftmost pixels.
+     */
+    std::uint8_t RowByte(std::uint64_t row, int i)
+    {
+        return static_cast<std::uint8_t>(row >> (8 * (ROW_BYTES - 1 - i)));
+    }
+}
+
+namespace chip8
+{
+    CaptureWriter::CaptureWriter(const std::string &filename, std::size_t queueFrames)
+        : path(filename), slots(queueFrames), slotMask(queueFrames - 1)
+    {
+        if (queueFrames == 0 || (queueFrames & slotMask) != 0)
+        {
+            throw std::invalid_argument("Capture queue length must be a power of two");
+        }
+
+        file.open(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Capture couldn't be created: " + filename);
+        }
+
+        CaptureHeader header{};
+        std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+        header.version = CAPTURE_VERSION;
+        header.width = SCREEN_WIDTH;
+        header.height = SCREEN_HEIGHT;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        if (!file)
+        {
+            throw std::runtime_error("Capture couldn't be written: " + filename);
+        }
+
+        output.reserve(OUTPUT_CHUNK + sizeof(Slot));
+        writer = std::thread(&CaptureWriter::writeLoop, this);
+    }
+
+    CaptureWriter::~CaptureWriter()
+    {
+        try
+        {
+            Close();
+        }
+
+        catch (const std::exception &)
+        {
+        }
+    }
+
+    bool CaptureWriter::Push(const std::uint64_t *rows, bool wait)
+    {
+        const std::uint64_t index = pushed++;
+        const std::uint64_t position = head.load(std::memory_order_relaxed);
+
+        while (position - tail.load(std::memory_order_acquire) == slots.size())
+        {
+            // A failed writer never makes room again; Close reports its error
+            if (!wait || stopped.load(std::memory_order_relaxed))
+            {
+                ++dropped;
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        Slot &slot = slots[position & slotMask];
+        std::copy(rows, rows + SCREEN_HEIGHT, slot.rows.begin());
+        slot.index = index;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    void CaptureWriter::Close()
+    {
+        if (closed)
+        {
+            return;
+        }
+
+        closed = true;
+        closing.store(true, std::memory_order_release);
+        writer.join();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        // Frames dropped after the last queued one are repeats as well
+        for (; nextIndex < pushed; ++nextIndex)
+        {
+            addRepeat();
+        }
+
+        flushRepeats();
+        flushOutput();
+
+        file.seekp(offsetof(CaptureHeader, frames));
+        file.write(reinterpret_cast<const char *>(&stats.frames), sizeof(stats.frames));
+        file.close();
+
+        if (!file)
+        {
+            throw std::runtime_error("Capture couldn't be written: " + path);
+        }
+    }
+
+    CaptureStats CaptureWriter::GetStats() const
+    {
+        CaptureStats result = stats;
+        result.droppedFrames = dropped;
+        return result;
+    }
+
+    void CaptureWriter::writeLoop()
+    {
+        try
+        {
+            std::uint64_t position = tail.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                // Read before the queue, so every frame pushed before Close is seen
+                const bool done = closing.load(std::memory_order_acquire);
+
+                if (position == head.load(std::memory_order_acquire))
+                {
+                    if (done)
+                    {
+                        break;
+                    }
+
+                    flushOutput();
+                    std::this_thread::sleep_for(WRITER_POLL);
+                    continue;
+                }
+
+                encode(slots[position & slotMask]);
+                tail.store(++position, std::memory_order_release);
+
+                if (output.size() >= OUTPUT_CHUNK)
+                {
+                    flushOutput();
+                }
+            }
+        }
+
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        stopped.store(true, std::memory_order_relaxed);
+    }
+
+    void CaptureWriter::encode(const Slot &slot)
+    {
+        // Frames dropped in between showed nothing new as far as the file knows
+        for (; nextIndex < slot.index; ++nextIndex)
+        {
+            addRepeat();
+        }
+
+        ++nextIndex;
+
+        std::uint32_t changedRows = 0;
+        for (int y = 0; y < SCREEN_HEIGHT; ++y)
+        {
+            changedRows |= (slot.rows[y] != previous[y] ? 1u : 0u) << y;
+        }
+
+        if (changedRows == 0)
+        {
+            addRepeat();
+            return;
+        }
+
+        ++stats.frames;
+        flushRepeats();
+
+        const std::size_t start = output.size();
+        PutLittleEndian(output, changedRows, 4);
+
+        for (int y = 0; y < SCREEN_HEIGHT; ++y)
+        {
+            if ((changedRows >> y & 1) == 0)
+            {
+                continue;
+            }
+
+            const std::uint64_t delta = slot.rows[y] ^ previous[y];
+            const std::size_t maskAt = output.size();
+            std::uint8_t changedBytes = 0;
+            output.push_back(0);
+
+            for (int i = 0; i < ROW_BYTES; ++i)
+            {
+                const std::uint8_t bits = RowByte(delta, i);
+                if (bits != 0)
+                {
+                    changedBytes |= static_cast<std::uint8_t>(0x80 >> i);
+                    output.push_back(bits);
+                }
+            }
+
+            output[maskAt] = changedBytes;
+        }
+
+        stats.encodedBytes += output.size() - start;
+        previous = slot.rows;
+    }
+
+    void CaptureWriter::addRepeat()
+    {
+        ++stats.frames;
+        if (++repeats == MAX_REPEATS)
+        {
+            flushRepeats();
+        }
+    }
+
+    void CaptureWriter::flushRepeats()
+    {
+        if (repeats == 0)
+        {
+            return;
+        }
+
+        // An empty row mask marks a run of frames equal to the previous one
+        PutLittleEndian(output, 0, 4);
+        PutLittleEndian(output, repeats, 2);
+        stats.encodedBytes += 6;
+        repeats = 0;
+    }
+
+    void CaptureWriter::flushOutput()
+    {
+        if (output.empty())
+        {
+            return;
+        }
+
+        file.write(reinterpret_cast<const char *>(output.data()), static_cast<std::streamsize>(output.size()));
+        output.clear();
+
+        if (!file)
+        {
+            throw std::runtime_error("Capture couldn't be written: " + path);
+        }
+    }
+
+    CaptureReader::CaptureReader(const std::string &filename) : file(filename, std::ios::binary), path(filename)
+    {
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Capture couldn't be opened: " + filename);
+        }
+
+        CaptureHeader header{};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+        if (!file || std::memcmp(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not a capture: " + filename);
+        }
+
+        if (header.version != CAPTURE_VERSION || header.width != SCREEN_WIDTH || header.height != SCREEN_HEIGHT)
+        {
+            throw std::runtime_error("Unsupported capture version: " + std::to_string(header.version));
+        }
+
+        frameCount = header.frames;
+    }
+
+    bool CaptureReader::Next(FrameBuffer &frame)
+    {
+        if (repeats != 0)
+        {
+            --repeats;
+            frame = current;
+            return true;
+        }
+
+        std::uint8_t bytes[ROW_BYTES + 1];
+        if (!file.read(reinterpret_cast<char *>(bytes), 4))
+        {
+            if (file.gcount() == 0)
+            {
+                return false;
+            }
+
+            throw std::runtime_error("Truncated capture: " + path);
+        }
+
+        const std::uint32_t changedRows = static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8 |
+                                          static_cast<std::uint32_t>(bytes[2]) << 16 |
+                                          static_cast<std::uint32_t>(bytes[3]) << 24;
+
+        if (changedRows == 0)
+        {
+            if (!file.read(reinterpret_cast<char *>(bytes), 2))
+            {
+                throw std::runtime_error("Truncated capture: " + path);
+            }
+
+            repeats = static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8;
+            if (repeats == 0)
+            {
+                throw std::runtime_error("Corrupt capture: empty repeat in " + path);
+            }
+
+            --repeats;
+            frame = current;
+            return true;
+        }
+
+        for (int y = 0; y < SCREEN_HEIGHT; ++y)
+        {
+            if ((changedRows >> y & 1) == 0)
+            {
+                continue;
+            }
+
+            std::uint8_t changedBytes = 0;
+            file.read(reinterpret_cast<char *>(&changedBytes), 1);
+
+            int count = 0;
+            for (int i = 0; i < ROW_BYTES; ++i)
+            {
+                count += changedBytes >> i & 1;
+            }
+
+            if (!file || !file.read(reinterpret_cast<char *>(bytes), count))
+            {
+                throw std::runtime_error("Truncated capture: " + path);
+            }
+
+            if (count == 0)
+            {
+                throw std::runtime_error("Corrupt capture: empty row in " + path);
+            }
+
+            std::uint64_t delta = 0;
+            for (int i = 0, next = 0; i < ROW_BYTES; ++i)
+            {
+                if (changedBytes & (0x80 >> i))
+                {
+                    delta |= static_cast<std::uint64_t>(bytes[next++]) << (8 * (ROW_BYTES - 1 - i));
+                }
+            }
+
+            current[y] ^= delta;
+        }
+
+        frame = current;
+        return true;
+    }
+
+    std::uint64_t CaptureReader::GetFrameCount() const
+    {
+        return frameCount;
+    }
+}
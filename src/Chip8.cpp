@@ -1,67 +1,690 @@
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <stdexcept>
 
 #include "Chip8.hpp"
+#include "Debugger.hpp"
+#include "Disassembler.hpp"
 
-static std::string intToHex(const std::uint16_t &value)
+#if CHIP8_TRACE
+namespace
 {
-    std::stringstream stream;
-    stream << std::hex << std::uppercase << "0x" << value;
-    return stream.str();
+    void RecordTrace(trace::TraceBuffer *buffer, std::uint64_t cycle, std::uint16_t pc, std::uint16_t opcode,
+                     std::uint16_t I, const std::array<std::uint8_t, 16> &before, const std::array<std::uint8_t, 16> &after)
+    {
+        if (!buffer)
+        {
+            return;
+        }
+
+        trace::TraceRecord record{cycle, pc, opcode, I, trace::NO_REGISTER, 0};
+        for (std::uint8_t i = 0; i < 16; ++i)
+        {
+            if (after[i] != before[i])
+            {
+                record.reg = i;
+                record.value = after[i];
+                break;
+            }
+        }
+
+        buffer->Push(record);
+    }
 }
+#endif
 
 namespace chip8
 {
-    Chip8::Chip8()
+    /**
+     * @brief Opcode handlers, one per decoded operation.
+     * Straight-line operations are written as bodies that leave pc alone;
+     * Step adds the pc increment for the interpreter, while translated
+     * blocks run the bodies back to back and set pc once per block.
+     * Control-flow operations always update pc themselves.
+     * Handlers are instantiated per profile; quirk branches are resolved
+     * at compile time.
+     */
+    template <Profile P>
+    struct Chip8::Ops
+    {
+        static constexpr Quirks QUIRKS = GetQuirks(P);
+
+        template <Handler Body>
+        static void Step(Chip8 &c, const Instruction &in)
+        {
+            Body(c, in);
+            c.pc += 2;
+        }
+
+        static void Undecoded(Chip8 &, const Instruction &instruction)
+        {
+            throw std::runtime_error("Executed undecoded instruction: " + ToHex(instruction.opcode));
+        }
+
+        static void CLS(Chip8 &c, const Instruction &) // 00E0: CLS – clean the view
+        {
+            c.gfx.fill(0);
+            c.dirtyRows = ALL_ROWS;
+            c.DrawFlag = true;
+            ++c.perf.drawFlagSets;
+        }
+
+        static void RET(Chip8 &c, const Instruction &) // 00EE: RET – returns from a subroutine
+        {
+            --c.sp;
+            c.pc = c.stack[c.sp];
+            c.pc += 2;
+        }
+
+        static void NOP(Chip8 &, const Instruction &) // 0000: NOP - does nothing - TEST FEATURE, NORMALLY NOT USED
+        {
+        }
+
+        static void JP(Chip8 &c, const Instruction &in) // 1NNN: JP addr - JUMP to the address NNN
+        {
+            c.pc = in.nnn;
+        }
+
+        static void CALL(Chip8 &c, const Instruction &in) // 2NNN: CALL addr - CALL subroutine at NNN
+        {
+            c.stack[c.sp] = c.pc;
+            ++c.sp;
+            c.pc = in.nnn;
+        }
+
+        static void SE_VX_NN(Chip8 &c, const Instruction &in) // 3XNN: SE Vx, NN - skip instruction if Vx == NN
+        {
+            c.pc += (c.V[in.x] == in.nn) ? 4 : 2;
+        }
+
+        static void SNE_VX_NN(Chip8 &c, const Instruction &in) // 4XNN: SNE Vx, NN - skip instruction if Vx != NN
+        {
+            c.pc += (c.V[in.x] != in.nn) ? 4 : 2;
+        }
+
+        static void SE_VX_VY(Chip8 &c, const Instruction &in) // 5XY0: SE Vx, Vy - skip instruction if Vx == Vy
+        {
+            c.pc += (c.V[in.x] == c.V[in.y]) ? 4 : 2;
+        }
+
+        static void LD_VX_NN(Chip8 &c, const Instruction &in) // 6XNN: LD Vx, NN - Loads NN value to Vx register
+        {
+            c.V[in.x] = in.nn;
+        }
+
+        static void ADD_VX_NN(Chip8 &c, const Instruction &in) // 7XNN: ADD Vx, NN - adds NN value to Vx register, VF untouched
+        {
+            c.V[in.x] += in.nn;
+        }
+
+        static void LD_VX_VY(Chip8 &c, const Instruction &in) // 8XY0: LD Vx, Vy - loads the value of Vy to Vx register
+        {
+            c.V[in.x] = c.V[in.y];
+        }
+
+        static void OR_VX_VY(Chip8 &c, const Instruction &in) // 8XY1: OR Vx, Vy - bitwise OR of Vx and Vy registers
+        {
+            c.V[in.x] |= c.V[in.y];
+
+            if constexpr (QUIRKS.vfReset)
+            {
+                c.V[0xF] = 0;
+            }
+        }
+
+        static void AND_VX_VY(Chip8 &c, const Instruction &in) // 8XY2: AND Vx, Vy - bitwise AND of Vx and Vy registers
+        {
+            c.V[in.x] &= c.V[in.y];
+
+            if constexpr (QUIRKS.vfReset)
+            {
+                c.V[0xF] = 0;
+            }
+        }
+
+        static void XOR_VX_VY(Chip8 &c, const Instruction &in) // 8XY3: XOR Vx, Vy - bitwise XOR of Vx and Vy registers
+        {
+            c.V[in.x] ^= c.V[in.y];
+
+            if constexpr (QUIRKS.vfReset)
+            {
+                c.V[0xF] = 0;
+            }
+        }
+
+        static void ADD_VX_VY(Chip8 &c, const Instruction &in) // 8XY4: ADD Vx, Vy - sets VF if there is a carry
+        {
+            std::uint16_t sum = c.V[in.x] + c.V[in.y];
+            c.V[0xF] = (sum > 0xFF) ? 1 : 0;
+            c.V[in.x] = sum & 0xFF;
+        }
+
+        static void SUB_VX_VY(Chip8 &c, const Instruction &in) // 8XY5: SUB Vx, Vy - sets VF if there is no borrow
+        {
+            c.V[0xF] = (c.V[in.x] > c.V[in.y]) ? 1 : 0;
+            c.V[in.x] -= c.V[in.y];
+        }
+
+        static void SHR_VX(Chip8 &c, const Instruction &in) // 8XY6: SHR Vx - VF is set to the least significant bit of Vx
+        {
+            if constexpr (QUIRKS.shiftVy)
+            {
+                const std::uint8_t value = c.V[in.y];
+                c.V[in.x] = value >> 1;
+                c.V[0xF] = value & 0x1;
+            }
+            else
+            {
+                c.V[0xF] = c.V[in.x] & 0x1;
+                c.V[in.x] >>= 1;
+            }
+        }
+
+        static void SUBN_VX_VY(Chip8 &c, const Instruction &in) // 8XY7: SUBN Vx, Vy - sets VF if there is no borrow
+        {
+            c.V[0xF] = (c.V[in.y] > c.V[in.x]) ? 1 : 0;
+            c.V[in.y] -= c.V[in.x];
+        }
+
+        static void SHL_VX(Chip8 &c, const Instruction &in) // 8XYE: SHL Vx - VF is set to the most significant bit of Vx
+        {
+            if constexpr (QUIRKS.shiftVy)
+            {
+                const std::uint8_t value = c.V[in.y];
+                c.V[in.x] = static_cast<std::uint8_t>(value << 1);
+                c.V[0xF] = value >> 7;
+            }
+            else
+            {
+                c.V[0xF] = (c.V[in.x] & 0x80) >> 7;
+                c.V[in.x] <<= 1;
+            }
+        }
+
+        static void SNE_VX_VY(Chip8 &c, const Instruction &in) // 9XY0: SNE Vx, Vy - skip instruction if Vx != Vy
+        {
+            c.pc += (c.V[in.x] != c.V[in.y]) ? 4 : 2;
+        }
+
+        static void LD_I_NNN(Chip8 &c, const Instruction &in) // ANNN: LD I, NNN - setting the NNN address to the I register
+        {
+            c.I = in.nnn;
+        }
+
+        static void JP_V0_NNN(Chip8 &c, const Instruction &in) // BNNN: JP V0, NNN - jumps to the address NNN + V0
+        {
+            // SUPER-CHIP reads the register from the top nibble of NNN (BXNN)
+            c.pc = c.V[QUIRKS.jumpVx ? in.x : 0] + in.nnn;
+        }
+
+        static void RND_VX_NN(Chip8 &c, const Instruction &in) // CXNN: RND Vx, NN - generates a random number and ANDs it with NN
+        {
+            // Per instance and seeded, so parallel chips and replays stay reproducible
+            std::uint8_t randomByte = NextRandom(c.rngState) >> 24;
+            c.V[in.x] = randomByte & in.nn;
+        }
+
+        static void DRW(Chip8 &c, const Instruction &in) // DXYN: Draw sprite at (Vx, Vy), N bytes tall
+        {
+            std::uint8_t x = c.V[in.x];
+            std::uint8_t y = c.V[in.y];
+            std::uint8_t height = in.n;
+            std::uint64_t collision = 0;
+
+            // Only the origin wraps; the sprite is cut at the right and bottom edges
+            if constexpr (QUIRKS.clipSprites)
+            {
+                x &= SCREEN_WIDTH - 1;
+                y &= SCREEN_HEIGHT - 1;
+                height = static_cast<std::uint8_t>(std::min<int>(height, SCREEN_HEIGHT - y));
+            }
+
+            // Each sprite byte is rotated into place and XORed into its row in one go
+            for (int yline = 0; yline < height; yline++)
+            {
+                const std::uint8_t bits = c.memory[c.I + yline];
+                const std::uint64_t sprite = QUIRKS.clipSprites ? ClippedSpriteRow(bits, x) : SpriteRow(bits, x);
+                std::uint64_t &row = c.gfx[(y + yline) % SCREEN_HEIGHT];
+
+                collision |= row & sprite;
+                row ^= sprite;
+            }
+
+            c.V[0xF] = collision != 0 ? 1 : 0;
+            c.dirtyRows |= SpriteRows(y, height);
+            c.DrawFlag = true;
+
+            ++c.perf.spritesDrawn;
+            c.perf.collisions += c.V[0xF];
+            ++c.perf.drawFlagSets;
+        }
+
+        static void SKP_VX(Chip8 &c, const Instruction &in) // EX9E: SKP Vx - skip next instruction if key Vx is pressed
+        {
+            c.pc += (c.keypad[c.V[in.x]] != 0) ? 4 : 2;
+        }
+
+        static void SKNP_VX(Chip8 &c, const Instruction &in) // EXA1: SKNP Vx - skip next instruction if key Vx is not pressed
+        {
+            c.pc += (c.keypad[c.V[in.x]] == 0) ? 4 : 2;
+        }
+
+        static void LD_VX_DT(Chip8 &c, const Instruction &in) // FX07: LD Vx, DT - loads the delay timer to Vx register
+        {
+            c.V[in.x] = c.timerValue(c.delay_timer, c.delayTimerSetAt);
+        }
+
+        static void LD_VX_K(Chip8 &c, const Instruction &in) // FX0A: LD Vx, K - waits for a key press and stores it in Vx
+        {
+            for (std::size_t i = 0; i < 16; i++)
+            {
+                if (c.keypad[i] != 0)
+                {
+                    c.V[in.x] = i;
+                    c.pc += 2;
+                    return;
+                }
+            }
+
+            ++c.perf.keyWaitCycles;
+        }
+
+        static void LD_DT_VX(Chip8 &c, const Instruction &in) // FX15: LD DT, Vx - sets the delay timer to Vx
+        {
+            c.retireTimer(c.delay_timer, c.delayTimerSetAt);
+            c.delay_timer = c.V[in.x];
+            c.delayTimerSetAt = c.timerTicks();
+        }
+
+        static void LD_ST_VX(Chip8 &c, const Instruction &in) // FX18: LD ST, Vx - sets the sound timer to Vx
+        {
+            c.retireTimer(c.sound_timer, c.soundTimerSetAt);
+            c.sound_timer = c.V[in.x];
+            c.soundTimerSetAt = c.timerTicks();
+        }
+
+        static void ADD_I_VX(Chip8 &c, const Instruction &in) // FX1E: ADD I, Vx - adds Vx to I register
+        {
+            c.I += c.V[in.x];
+        }
+
+        static void LD_F_VX(Chip8 &c, const Instruction &in) // FX29: LD F, Vx - sets I to the font sprite of the digit in Vx
+        {
+            c.I = FONTSET_START_ADDRESS + (c.V[in.x] * 5);
+        }
+
+        static void LD_B_VX(Chip8 &c, const Instruction &in) // FX33: LD B, Vx - stores BCD of Vx at I, I+1 and I+2
+        {
+            const std::uint8_t value = c.V[in.x];
+            c.writeMemory(c.I, value / 100);
+            c.writeMemory(c.I + 1, (value / 10) % 10);
+            c.writeMemory(c.I + 2, value % 10);
+        }
+
+        static void LD_MEM_VX(Chip8 &c, const Instruction &in) // FX55: LD [I], Vx — Store V0 to Vx in memory starting at I
+        {
+            for (std::size_t i = 0; i <= in.x; ++i)
+            {
+                c.writeMemory(c.I + i, c.V[i]);
+            }
+
+            if constexpr (QUIRKS.memoryIncrementsI)
+            {
+                c.I += in.x + 1;
+            }
+        }
+
+        static void LD_VX_MEM(Chip8 &c, const Instruction &in) // FX65: LD Vx, [I] - Load V0 to Vx from memory starting at I
+        {
+            for (std::size_t i = 0; i <= in.x; ++i)
+            {
+                c.V[i] = c.memory[c.I + i];
+            }
+
+            if constexpr (QUIRKS.memoryIncrementsI)
+            {
+                c.I += in.x + 1;
+            }
+        }
+
+        static void Invalid(Chip8 &, const Instruction &in)
+        {
+            throw std::runtime_error(DescribeInvalid(in.opcode));
+        }
+    };
+
+    /**
+     * @brief Flat dispatch table indexed by Op.
+     */
+    template <Profile P>
+    const Chip8::HandlerTable Chip8::HANDLERS = {
+        &Ops<P>::Undecoded,
+        &Ops<P>::template Step<&Ops<P>::CLS>,
+        &Ops<P>::RET,
+        &Ops<P>::template Step<&Ops<P>::NOP>,
+        &Ops<P>::JP,
+        &Ops<P>::CALL,
+        &Ops<P>::SE_VX_NN,
+        &Ops<P>::SNE_VX_NN,
+        &Ops<P>::SE_VX_VY,
+        &Ops<P>::template Step<&Ops<P>::LD_VX_NN>,
+        &Ops<P>::template Step<&Ops<P>::ADD_VX_NN>,
+        &Ops<P>::template Step<&Ops<P>::LD_VX_VY>,
+        &Ops<P>::template Step<&Ops<P>::OR_VX_VY>,
+        &Ops<P>::template Step<&Ops<P>::AND_VX_VY>,
+        &Ops<P>::template Step<&Ops<P>::XOR_VX_VY>,
+        &Ops<P>::template Step<&Ops<P>::ADD_VX_VY>,
+        &Ops<P>::template Step<&Ops<P>::SUB_VX_VY>,
+        &Ops<P>::template Step<&Ops<P>::SHR_VX>,
+        &Ops<P>::template Step<&Ops<P>::SUBN_VX_VY>,
+        &Ops<P>::template Step<&Ops<P>::SHL_VX>,
+        &Ops<P>::SNE_VX_VY,
+        &Ops<P>::template Step<&Ops<P>::LD_I_NNN>,
+        &Ops<P>::JP_V0_NNN,
+        &Ops<P>::template Step<&Ops<P>::RND_VX_NN>,
+        &Ops<P>::template Step<&Ops<P>::DRW>,
+        &Ops<P>::SKP_VX,
+        &Ops<P>::SKNP_VX,
+        &Ops<P>::template Step<&Ops<P>::LD_VX_DT>,
+        &Ops<P>::LD_VX_K,
+        &Ops<P>::template Step<&Ops<P>::LD_DT_VX>,
+        &Ops<P>::template Step<&Ops<P>::LD_ST_VX>,
+        &Ops<P>::template Step<&Ops<P>::ADD_I_VX>,
+        &Ops<P>::template Step<&Ops<P>::LD_F_VX>,
+        &Ops<P>::template Step<&Ops<P>::LD_B_VX>,
+        &Ops<P>::template Step<&Ops<P>::LD_MEM_VX>,
+        &Ops<P>::template Step<&Ops<P>::LD_VX_MEM>,
+        &Ops<P>::Invalid,
+    };
+
+    /**
+     * @brief Handlers used inside translated blocks, straight-line
+     * operations do not advance pc.
+     */
+    template <Profile P>
+    const Chip8::HandlerTable Chip8::BODY_HANDLERS = {
+        &Ops<P>::Undecoded,
+        &Ops<P>::CLS,
+        &Ops<P>::RET,
+        &Ops<P>::NOP,
+        &Ops<P>::JP,
+        &Ops<P>::CALL,
+        &Ops<P>::SE_VX_NN,
+        &Ops<P>::SNE_VX_NN,
+        &Ops<P>::SE_VX_VY,
+        &Ops<P>::LD_VX_NN,
+        &Ops<P>::ADD_VX_NN,
+        &Ops<P>::LD_VX_VY,
+        &Ops<P>::OR_VX_VY,
+        &Ops<P>::AND_VX_VY,
+        &Ops<P>::XOR_VX_VY,
+        &Ops<P>::ADD_VX_VY,
+        &Ops<P>::SUB_VX_VY,
+        &Ops<P>::SHR_VX,
+        &Ops<P>::SUBN_VX_VY,
+        &Ops<P>::SHL_VX,
+        &Ops<P>::SNE_VX_VY,
+        &Ops<P>::LD_I_NNN,
+        &Ops<P>::JP_V0_NNN,
+        &Ops<P>::RND_VX_NN,
+        &Ops<P>::DRW,
+        &Ops<P>::SKP_VX,
+        &Ops<P>::SKNP_VX,
+        &Ops<P>::LD_VX_DT,
+        &Ops<P>::LD_VX_K,
+        &Ops<P>::LD_DT_VX,
+        &Ops<P>::LD_ST_VX,
+        &Ops<P>::ADD_I_VX,
+        &Ops<P>::LD_F_VX,
+        &Ops<P>::LD_B_VX,
+        &Ops<P>::LD_MEM_VX,
+        &Ops<P>::LD_VX_MEM,
+        &Ops<P>::Invalid,
+    };
+
+    Chip8::Chip8(Profile profile)
         : V{}, I(0), pc(0x200), stack{}, sp(0),
           delay_timer(0), sound_timer(0),
-          gfx{}, keypad{}, DrawFlag{false}
+          gfx{}, keypad{}, DrawFlag{false}, profile(profile)
+    {
+        switch (profile)
+        {
+        case Profile::Modern:
+            handlers = HANDLERS<Profile::Modern>.data();
+            bodyHandlers = BODY_HANDLERS<Profile::Modern>.data();
+            break;
+        case Profile::CosmacVip:
+            handlers = HANDLERS<Profile::CosmacVip>.data();
+            bodyHandlers = BODY_HANDLERS<Profile::CosmacVip>.data();
+            break;
+        case Profile::SuperChip:
+            handlers = HANDLERS<Profile::SuperChip>.data();
+            bodyHandlers = BODY_HANDLERS<Profile::SuperChip>.data();
+            break;
+        default:
+            throw std::invalid_argument("Unknown profile: " + std::to_string(static_cast<int>(profile)));
+        }
+
+        aotContext = AotContext{this, V.data(), &I, &pc, &cycles, handlers, bodyHandlers};
+    }
+
+    std::unique_ptr<IChip> CreateChip(Profile profile)
+    {
+        return std::make_unique<Chip8>(profile);
+    }
+
+    Profile Chip8::GetProfile() const
     {
+        return profile;
     }
 
     void Chip8::reset()
     {
-        memory.fill(0);
+        // The font page is shared by every machine, like a ROM image
+        static const std::array<std::uint8_t, GuestMemory::PAGE_SIZE> FONT_PAGE = []
+        {
+            std::array<std::uint8_t, GuestMemory::PAGE_SIZE> page{};
+            std::copy(fontset.begin(), fontset.end(), page.begin() + FONTSET_START_ADDRESS);
+            return page;
+        }();
+
+        memory.Clear();
+        memory.Map(0, FONT_PAGE.data(), FONT_PAGE.size());
         V.fill(0);
         stack.fill(0);
         gfx.fill(0);
+        dirtyRows = ALL_ROWS;
         keypad.fill(0);
         I = 0;
         pc = 0x200;
         sp = 0;
         delay_timer = 0;
         sound_timer = 0;
+        cycles = 0;
+        rngState = SeedRandom(seed);
+        delayTimerSetAt = 0;
+        soundTimerSetAt = 0;
+        timerTickBase = 0;
+        timerCycleBase = 0;
+        perf = PerfCounters{};
+        waiting = false;
+
+        if (decoded)
+        {
+            decodeCache.fill(Instruction{});
+            decoded = false;
+        }
 
-        // Loading fontset into memory
-        for (size_t i = 0; i < fontset.size(); ++i)
+        blockCache.Clear();
+
+        if (jit)
         {
-            memory[FONTSET_START_ADDRESS + i] = fontset[i];
+            jit->Clear();
         }
+
+        romHash = 0;
+        aotProgram = nullptr;
+        aotResolved = false;
     }
 
-    void Chip8::UpdateTimers()
+    void Chip8::SetClockRate(std::uint32_t instructionsPerSecond)
     {
-        if (delay_timer > 0)
+        if (instructionsPerSecond == 0)
         {
-            --delay_timer;
+            throw std::invalid_argument("Clock rate must be positive");
         }
 
-        if (sound_timer > 0)
+        // Re-anchor the tick count so timers keep their value across the change
+        timerTickBase = timerTicks();
+        timerCycleBase = cycles;
+        clockRate = instructionsPerSecond;
+    }
+
+    void Chip8::SetSeed(std::uint64_t newSeed)
+    {
+        seed = newSeed;
+        rngState = SeedRandom(seed);
+    }
+
+    std::uint32_t Chip8::GetClockRate() const
+    {
+        return clockRate;
+    }
+
+    std::uint8_t Chip8::GetSoundTimer() const
+    {
+        return timerValue(sound_timer, soundTimerSetAt);
+    }
+
+    std::uint64_t Chip8::timerTicks() const
+    {
+        return timerTickBase + (cycles - timerCycleBase) * TIMER_RATE / clockRate;
+    }
+
+    std::uint8_t Chip8::timerValue(std::uint8_t value, std::uint64_t setAt) const
+    {
+        const std::uint64_t elapsed = timerTicks() - setAt;
+        return elapsed >= value ? 0 : static_cast<std::uint8_t>(value - elapsed);
+    }
+
+    std::uint64_t Chip8::firstCycleOfTick(std::uint64_t tick) const
+    {
+        if (tick <= timerTickBase)
         {
-            --sound_timer;
+            return timerCycleBase;
         }
+
+        // Inverse of timerTicks, rounded up to the first whole cycle
+        return timerCycleBase + ((tick - timerTickBase) * clockRate + TIMER_RATE - 1) / TIMER_RATE;
     }
 
-    std::uint8_t Chip8::GetSoundTimer() const
+    void Chip8::retireTimer(std::uint8_t value, std::uint64_t setAt)
     {
-        return sound_timer;
+        if (value != 0 && timerValue(value, setAt) == 0)
+        {
+            ++perf.timerUnderflows;
+        }
     }
 
-    void Chip8::loadROM(const std::string &filename)
+    void Chip8::SaveState(Snapshot &snapshot) const
     {
-        reset();
+        snapshot.version = SNAPSHOT_VERSION;
+        snapshot.clockRate = clockRate;
+        snapshot.cycles = cycles;
+        snapshot.delayTimerSetAt = delayTimerSetAt;
+        snapshot.soundTimerSetAt = soundTimerSetAt;
+        snapshot.timerTickBase = timerTickBase;
+        snapshot.timerCycleBase = timerCycleBase;
+        snapshot.gfx = gfx;
+        snapshot.dirtyRows = dirtyRows;
+        snapshot.profile = static_cast<std::uint32_t>(profile);
+        snapshot.rngState = rngState;
+        snapshot.stack = stack;
+        snapshot.I = I;
+        snapshot.pc = pc;
+        memory.CopyTo(snapshot.memory.data());
+        snapshot.V = V;
+        snapshot.keypad = keypad;
+        snapshot.sp = sp;
+        snapshot.delayTimer = delay_timer;
+        snapshot.soundTimer = sound_timer;
+        snapshot.drawFlag = DrawFlag ? 1 : 0;
+    }
+
+    void Chip8::LoadState(const Snapshot &snapshot)
+    {
+        if (snapshot.version != SNAPSHOT_VERSION)
+        {
+            throw std::invalid_argument("Unsupported snapshot version: " + std::to_string(snapshot.version));
+        }
+
+        if (snapshot.clockRate == 0)
+        {
+            throw std::invalid_argument("Snapshot has no clock rate");
+        }
+
+        if (snapshot.profile != static_cast<std::uint32_t>(profile))
+        {
+            throw std::invalid_argument("Snapshot was taken with another quirk profile");
+        }
+
+        // State files are external input, and CALL/RET index the stack unchecked
+        if (snapshot.sp > stack.size())
+        {
+            throw std::invalid_argument("Snapshot stack pointer out of range: " + std::to_string(snapshot.sp));
+        }
+
+        if (snapshot.pc >= GuestMemory::SIZE)
+        {
+            throw std::invalid_argument("Snapshot program counter out of bounds: " + ToHex(snapshot.pc));
+        }
+
+        // Only the bytes that differ are invalidated, so restoring a state
+        // of the same program keeps its decoded and translated code
+        for (std::size_t base = 0; base < GuestMemory::SIZE; base += GuestMemory::PAGE_SIZE)
+        {
+            if (std::memcmp(memory.Data(base), &snapshot.memory[base], GuestMemory::PAGE_SIZE) == 0)
+            {
+                continue;
+            }
 
+            for (std::size_t address = base; address < base + GuestMemory::PAGE_SIZE; ++address)
+            {
+                if (memory[address] != snapshot.memory[address])
+                {
+                    memory.Write(address, snapshot.memory[address]);
+                    invalidate(static_cast<std::uint16_t>(address));
+                }
+            }
+        }
+
+        retireTimer(delay_timer, delayTimerSetAt);
+        retireTimer(sound_timer, soundTimerSetAt);
+
+        clockRate = snapshot.clockRate;
+        cycles = snapshot.cycles;
+        delayTimerSetAt = snapshot.delayTimerSetAt;
+        soundTimerSetAt = snapshot.soundTimerSetAt;
+        timerTickBase = snapshot.timerTickBase;
+        timerCycleBase = snapshot.timerCycleBase;
+        gfx = snapshot.gfx;
+        dirtyRows = snapshot.dirtyRows;
+        rngState = snapshot.rngState;
+        stack = snapshot.stack;
+        I = snapshot.I;
+        pc = snapshot.pc;
+        V = snapshot.V;
+        keypad = snapshot.keypad;
+        sp = snapshot.sp;
+        delay_timer = snapshot.delayTimer;
+        sound_timer = snapshot.soundTimer;
+        DrawFlag = snapshot.drawFlag != 0;
+    }
+
+    void Chip8::loadROM(const std::string &filename)
+    {
         std::ifstream file(filename, std::ios::binary | std::ios::ate);
         if (!file.is_open())
         {
@@ -79,10 +702,36 @@ namespace chip8
             return;
         }
 
-        file.read(reinterpret_cast<char *>(&memory[0x200]), size);
+        std::array<std::uint8_t, 4096 - 512> rom{};
+        file.read(reinterpret_cast<char *>(rom.data()), size);
+        loadROM(rom.data(), static_cast<std::size_t>(size));
         std::cout << "ROM loaded: " << filename << " (" << size << " bytes)" << std::endl;
     }
 
+    void Chip8::loadROM(const std::uint8_t *data, std::size_t size)
+    {
+        if (size > (4096 - 512))
+        {
+            throw std::runtime_error("ROM too big! Size: " + std::to_string(size) + " bytes. Max size: " + std::to_string(4096 - 512) + " bytes.");
+        }
+
+        reset();
+        memory.Load(0x200, data, size);
+        romHash = HashRom(data, size);
+    }
+
+    void Chip8::loadROM(const RomImage &image)
+    {
+        if (image.size > MAX_ROM_SIZE)
+        {
+            throw std::runtime_error("ROM too big! Size: " + std::to_string(image.size) + " bytes. Max size: " + std::to_string(MAX_ROM_SIZE) + " bytes.");
+        }
+
+        reset();
+        memory.Map(0x200, image.data, image.size);
+        romHash = image.hash;
+    }
+
     std::uint8_t *Chip8::GetKeypad()
     {
         return keypad.data();
@@ -90,482 +739,516 @@ namespace chip8
 
     void Chip8::emulateCycle()
     {
-
-        if (pc >= memory.size() - 1)
+        if (pc >= GuestMemory::SIZE - 1)
         {
-            throw std::runtime_error("Program counter out of bounds: " + intToHex(pc));
+            throw std::runtime_error("Program counter out of bounds: " + ToHex(pc));
         }
 
-        // Fetch opcode (2 bytes)
+        // Fetch and decode only on the first visit of an address,
+        // afterwards the cached instruction is dispatched directly
         // note: each instruction takies 2 bytes of memory
-        std::uint16_t opcode = memory[pc] << 8 | memory[pc + 1];
-        std::cout << "PC: " << std::hex << pc << " Opcode: 0x" << opcode << std::dec << '\n';
-
-        // decoding the instruction - checking the first nibble (4 bits)
-        switch (opcode & 0xF000)
-        {
-        case 0x0000:
+        Instruction &instruction = decodeCache[pc];
+        if (instruction.op == Op::Undecoded)
         {
-            switch (opcode)
-            {
-            case 0x00E0: // CLS – clean the view
-                std::cout << "Instruction: CLS (clean the view)\n";
-                gfx.fill(0);
-                DrawFlag = true;
-                pc += 2;
-                break;
+            instruction = Decode(memory[pc] << 8 | memory[pc + 1]);
+            decoded = true;
+        }
 
-            case 0x00EE: // RET – returns from a subroutine
-                std::cout << "Instruction: RET\n";
-                --sp;
-                pc = stack[sp];
-                pc += 2;
-                break;
+#if CHIP8_TRACE
+        const std::uint16_t tracedPc = pc;
+        const std::array<std::uint8_t, 16> before = V;
+        const std::uint16_t opcode = instruction.opcode;
+#endif
 
-            case 0x0000: // NOP - does nothing - TEST FEATURE, NORMALLY NOT USED
-                std::cout << "Instruction: NOP\n";
-                pc += 2;
-                break;
+        ++perf.families[OpcodeFamily(instruction.opcode)];
+        handlers[static_cast<std::size_t>(instruction.op)](*this, instruction);
+        ++cycles;
 
-            default:
-                throw std::runtime_error("Unknown instruction: " + intToHex(opcode));
-                break;
-            }
-            break;
-        }
+#if CHIP8_TRACE
+        RecordTrace(traceBuffer, cycles - 1, tracedPc, opcode, I, before, V);
+#endif
+    }
 
-        case 0x1000:
-        { // 1NNN: JP addr - JUMP to the address NNN
-            std::uint16_t nnn = opcode & 0x0FFF;
-            pc = nnn;
-            break;
+    std::uint64_t Chip8::emulateCycles(std::uint64_t count)
+    {
+        waiting = false;
+
+        // Checked once per call, so an idle debugger leaves the engines alone
+        if (debugger != nullptr && debugger->IsArmed())
+        {
+            return debugger->run(count);
         }
 
-        case 0x2000:
-        { // CALL addr - CALL subroutine at NNN
-            std::uint16_t nnn = opcode & 0x0FFF;
-            stack[sp] = pc;
-            ++sp;
-            pc = nnn;
-            std::cout << "Instruction: CALL " << intToHex(nnn) << '\n';
-            break;
+        if (engine == Engine::BlockCache)
+        {
+            return runBlocks(count);
         }
 
-        case 0x3000: // SE Vx, NN - skip instruction if Vx == NN
+        if (engine == Engine::Jit)
         {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t nn = opcode & 0x00FF;
-            std::cout << "Instruction: SE V" << +x << ", " << +nn << "\n";
-            if (V[x] == nn)
-                pc += 4;
-            else
-                pc += 2;
-            break;
+            return runJit(count);
         }
 
-        case 0x4000: // SNE Vx, NN - skip instruction if Vx != NN
+        if (engine == Engine::Aot)
         {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t nn = opcode & 0x00FF;
-            std::cout << "Instruction: SNE V" << +x << ", " << +nn << "\n";
-            if (V[x] != nn)
-                pc += 4;
-            else
-                pc += 2;
-            break;
+            return runAot(count);
         }
 
-        case 0x5000: // SE Vx, Vy - skip instruction if Vx == Vy
+        return runInterpreter(count);
+    }
+
+    bool Chip8::IsWaiting() const
+    {
+        return waiting;
+    }
+
+    std::uint64_t Chip8::runInterpreter(std::uint64_t budget)
+    {
+        std::uint64_t executed = 0;
+
+        while (executed < budget)
         {
-            if ((opcode & 0x000F) != 0)
+            const std::uint16_t at = pc;
+            emulateCycle();
+            ++executed;
+
+            if (pc <= at)
             {
-                throw std::runtime_error("Invalid instruction: " + intToHex(opcode));
+                executed += skipIdle(budget - executed);
             }
-
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t y = (opcode & 0x00F0) >> 4;
-            std::cout << "Instruction: SE V" << +x << ", V" << +y << "\n";
-
-            if (V[x] == V[y])
-                pc += 4;
-            else
-                pc += 2;
-            break;
         }
 
-        case 0x6000: // 6XNN - LD Vx, NN - Loads NN value to Vx register DOES SET
+        return executed;
+    }
+
+    std::uint64_t Chip8::skipIdle(std::uint64_t budget)
+    {
+#if CHIP8_TRACE
+        // Skipped cycles would be missing from the trace
+        (void)budget;
+        return 0;
+#else
+        if (budget == 0)
         {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t nn = opcode & 0x00FF;
-            V[x] = nn;
-            std::cout << "Instruction: LD V" << +x << ", " << +nn << '\n';
-            pc += 2;
-            break;
+            return 0;
         }
 
-        case 0x7000: // 7XNN - ADD Vx, NN - adds NN value to Vx register DOES NOT SET, increments
+        const std::uint16_t opcode = memory[pc] << 8 | memory[pc + 1];
+        std::uint64_t skipped = 0;
+
+        if (opcode == (0x1000 | pc))
         {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t nn = opcode & 0x00FF;
-            V[x] += nn;
-            std::cout << "Instruction: ADD V" << +x << ", " << +nn << '\n';
-            pc += 2; //
-            break;
+            // JP to itself, the usual end of a program
+            skipped = budget;
+            perf.families[0x1] += skipped;
+            cycles += skipped;
         }
-
-        case 0x8000:
+        else if ((opcode & 0xF0FF) == 0xF00A)
         {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t y = (opcode & 0x00F0) >> 4;
-            std::uint8_t subcode = opcode & 0x000F;
-
-            switch (subcode)
+            // The keypad only changes between emulateCycles calls
+            if (std::all_of(keypad.begin(), keypad.end(), [](std::uint8_t key) { return key == 0; }))
             {
-            case 0x0: // 8XY0 - LD Vx, Vy - loads the value of Vy to Vx register
-                V[x] = V[y];
-                std::cout << "Instruction: LD V" << +x << ", V" << +y << '\n';
-                pc += 2;
-                break;
-
-            case 0x1: // 8XY1 -  OR Vx, Vy - bitwise OR of Vx and Vy registers
-            {
-                V[x] |= V[y];
-                std::cout << "Instruction: OR V" << +x << ", V" << +y << '\n';
-                pc += 2;
-                break;
+                skipped = budget;
+                perf.families[0xF] += skipped;
+                perf.keyWaitCycles += skipped;
+                cycles += skipped;
             }
+        }
+        else if ((opcode & 0xF0FF) == 0xF007)
+        {
+            skipped = skipDelayPoll(opcode, budget);
+        }
 
-            case 0x2: // 8XY2 - AND Vx, Vy - bitwise AND of Vx and Vy registers
-            {
-                V[x] &= V[y];
-                std::cout << "Instruction: AND V" << +x << ", V" << +y << '\n';
-                pc += 2;
-                break;
-            }
+        if (skipped != 0)
+        {
+            perf.idleCycles += skipped;
+            waiting = budget - skipped < DELAY_POLL_LENGTH;
+        }
 
-            case 0x3: // 8XY3 - XOR Vx, Vy - bitwise XOR of Vx and Vy registers
-            {
-                V[x] ^= V[y];
-                std::cout << "Instruction: XOR V" << +x << ", V" << +y << '\n';
-                pc += 2;
-                break;
-            }
+        return skipped;
+#endif
+    }
 
-            case 0x4: // 8XY4 - ADD Vx, Vy - adds the value of Vy to Vx register and sets VF if there is a carry
-            {
-                std::uint16_t sum = V[x] + V[y];
-                V[0xF] = (sum > 0xFF) ? 1 : 0;
-                V[x] = sum & 0xFF;
-                std::cout << "Instruction: ADD V" << +x << ", V" << +y << '\n';
-                pc += 2;
-                break;
-            }
+    std::uint64_t Chip8::skipDelayPoll(std::uint16_t opcode, std::uint64_t budget)
+    {
+        const std::uint8_t x = (opcode >> 8) & 0xF;
+        const std::uint16_t skip = memory[pc + 2] << 8 | memory[pc + 3];
+        const std::uint16_t jump = memory[pc + 4] << 8 | memory[pc + 5];
 
-            case 0x5: // 8XY5 - SUB Vx, Vy - subtracts the value of Vy from Vx register and sets VF if there is no borrow
-            {
-                V[0xF] = (V[x] > V[y]) ? 1 : 0;
-                V[x] -= V[y];
-                std::cout << "Instruction: SUB V" << +x << ", V" << +y << '\n';
-                pc += 2;
-                break;
-            }
+        if ((skip & 0xFF00) != (0x3000 | x << 8) || jump != (0x1000 | pc))
+        {
+            return 0;
+        }
 
-            case 0x6: // 8XY6 - SHR Vx {, Vy} - shifts Vx register right by 1 bit and sets VF to the least significant bit of Vx
-            {
-                V[0xF] = V[x] & 0x1;
-                V[x] >>= 1;
-                std::cout << "Instruction: SHR V" << +x << '\n';
-                pc += 2;
-                break;
-            }
+        const std::uint8_t nn = skip & 0xFF;
+        std::uint64_t iterations = budget / DELAY_POLL_LENGTH;
 
-            case 0x7: // 8XY7 - SUBN Vx, Vy - subtracts the value of Vx from Vy register and sets VF if there is no borrow
-            {
-                V[0xF] = (V[y] > V[x]) ? 1 : 0;
-                V[y] -= V[x];
-                std::cout << "Instruction: SUBN V" << +x << ", V" << +y << '\n';
-                pc += 2;
-                break;
-            }
+        // The timer reads NN during one tick, or from its expiry on for 0;
+        // iterations whose FX07 falls between two reads of that window
+        // spin forever, like the real loop does
+        if (nn <= delay_timer)
+        {
+            const std::uint64_t tick = delayTimerSetAt + delay_timer - nn;
+            const std::uint64_t first = firstCycleOfTick(tick);
+            const std::uint64_t last = nn == 0 ? UINT64_MAX : firstCycleOfTick(tick + 1);
 
-            case 0xE: // 8XYE - SHL Vx {, Vy} - shifts Vx register left by 1 bit and sets VF to the most significant bit of Vx
+            if (cycles >= first && cycles < last)
             {
-                V[0xF] = (V[x] & 0x80) >> 7;
-                V[x] <<= 1;
-                std::cout << "Instruction: SHL V" << +x << '\n';
-                pc += 2;
-                break;
+                return 0;
             }
 
-            default:
+            if (cycles < first)
             {
-                throw std::runtime_error("Unsupported 0x8XY* instruction: " + intToHex(opcode));
-                break;
-            }
+                const std::uint64_t exit = (first - cycles + DELAY_POLL_LENGTH - 1) / DELAY_POLL_LENGTH;
+                if (cycles + exit * DELAY_POLL_LENGTH < last)
+                {
+                    iterations = std::min(iterations, exit);
+                }
             }
-            break;
         }
 
-        case 0x9000: // SNE Vx, Vy - skip instruction if Vx != Vy
+        if (iterations == 0)
         {
-            if ((opcode & 0x000F) != 0)
-            {
-                throw std::runtime_error("Invalid instruction: " + intToHex(opcode));
-            }
+            return 0;
+        }
 
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t y = (opcode & 0x00F0) >> 4;
-            std::cout << "Instruction: SNE V" << +x << ", V" << +y << "\n";
+        // Vx keeps the value read by the last skipped iteration
+        cycles += (iterations - 1) * DELAY_POLL_LENGTH;
+        V[x] = timerValue(delay_timer, delayTimerSetAt);
+        cycles += DELAY_POLL_LENGTH;
 
-            if (V[x] != V[y])
-                pc += 4;
-            else
-                pc += 2;
-            break;
-        }
+        perf.families[0xF] += iterations;
+        perf.families[0x3] += iterations;
+        perf.families[0x1] += iterations;
+        return iterations * DELAY_POLL_LENGTH;
+    }
 
-        case 0xA000: // ANNN - LD I, NNN - setting the NNN (12-bit address) to the I register
+    void Chip8::SetEngine(Engine newEngine)
+    {
+        if (newEngine == Engine::Jit && !jit)
         {
-            std::uint16_t nnn = opcode & 0x0FFF;
-            I = nnn;
-            std::cout << "Instruction: LD I, " << intToHex(nnn) << '\n';
-            pc += 2;
-            break;
+            jit = std::make_unique<Jit>(*this, V.data(), &I, &pc, GuestMemory::SIZE, GetQuirks(profile));
         }
 
-        case 0xB000: // BNNN - JP V0, NNN - jumps to the address NNN + V0
+        if (newEngine == Engine::Aot && GetAotProgramCount() == 0)
         {
-            std::uint16_t nnn = opcode & 0x0FFF;
-            pc = V[0] + nnn;
-            std::cout << "Instruction: JP " << intToHex(nnn) << '\n';
-            break;
+            throw std::runtime_error("No ahead-of-time compiled ROMs are linked in, see CHIP8_AOT_ROMS");
         }
 
-        case 0xC000: // CXNN - RND Vx, NN - generates a random number and ANDs it with NN
-        {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t nn = opcode & 0x00FF;
-            std::uint8_t randomByte = rand() % 256;
-            V[x] = randomByte & nn;
-            std::cout << "Instruction: RND V" << +x << ", " << +nn << '\n';
-            pc += 2;
-            break;
-        }
+        engine = newEngine;
+    }
 
-        case 0xD000: // DXYN - Draw sprite at (Vx, Vy), N bytes tall
+    std::uint64_t Chip8::runBlocks(std::uint64_t budget)
+    {
+        std::uint64_t executed = 0;
+
+        while (executed < budget)
         {
-            std::uint8_t x = V[(opcode & 0x0F00) >> 8];
-            std::uint8_t y = V[(opcode & 0x00F0) >> 4];
-            std::uint8_t height = opcode & 0x000F;
-            std::uint8_t pixel;
+            if (pc >= GuestMemory::SIZE - 1)
+            {
+                throw std::runtime_error("Program counter out of bounds: " + ToHex(pc));
+            }
 
-            V[0xF] = 0;
+            const Block *block = blockCache.Find(pc);
+            if (!block && !blockCache.IsInterpreted(pc))
+            {
+                block = blockCache.Translate(memory, pc, handlers, bodyHandlers);
+            }
 
-            for (int yline = 0; yline < height; yline++)
+            // A lone control transfer gains nothing from a block, the
+            // bookkeeping below costs more than the decode it saves; call
+            // and return chains stay here until they reach a real block
+            if (!block)
             {
-                pixel = memory[I + yline];
-                for (int xline = 0; xline < 8; xline++)
+                do
                 {
-                    if ((pixel & (0x80 >> xline)) != 0)
+                    const std::uint16_t at = pc;
+                    emulateCycle();
+                    ++executed;
+
+                    if (pc <= at)
                     {
-                        int xPos = (x + xline) % 64;
-                        int yPos = (y + yline) % 32;
-                        int index = yPos * 64 + xPos;
+                        executed += skipIdle(budget - executed);
+                    }
+                } while (executed < budget && pc < GuestMemory::SIZE - 1 && blockCache.IsInterpreted(pc));
 
-                        if (gfx[index] == 1)
-                            V[0xF] = 1;
+                continue;
+            }
 
-                        gfx[index] ^= 1;
-                    }
+            const MicroOp *ops = blockCache.Ops(*block);
+            const std::uint16_t start = block->start;
+            const std::uint64_t length = block->length;
+
+            // The last micro-op is the only one that advances pc; when the
+            // budget ends inside the block pc is set to the next instruction
+            const bool complete = length <= budget - executed;
+            const std::uint64_t body = complete ? length - 1 : budget - executed;
+
+            // Whole blocks are counted from their histogram, cut ones per instruction
+            if (complete)
+            {
+                perf.AddFamilies(blockCache.Families(*block), block->familyCount);
+            }
+            else
+            {
+                for (std::uint64_t i = 0; i < body; ++i)
+                {
+                    ++perf.families[OpcodeFamily(ops[i].instruction.opcode)];
                 }
             }
 
-            DrawFlag = true;
+            for (std::uint64_t i = 0; i < body; ++i)
+            {
+#if CHIP8_TRACE
+                pc = start + 2 * i;
+                const std::array<std::uint8_t, 16> before = V;
+                ops[i].handler(*this, ops[i].instruction);
+                RecordTrace(traceBuffer, cycles + i, pc, ops[i].instruction.opcode, I, before, V);
+#else
+                ops[i].handler(*this, ops[i].instruction);
+#endif
+            }
 
-            std::cout << "DRW V" << +((opcode & 0x0F00) >> 8)
-                      << ", V" << +((opcode & 0x00F0) >> 4)
-                      << ", " << +height << " → sprite\n";
+            pc = static_cast<std::uint16_t>(start + 2 * body);
+            cycles += body;
+            executed += body;
 
-            pc += 2;
-            break;
-        }
+            if (complete)
+            {
+#if CHIP8_TRACE
+                const std::uint16_t tracedPc = pc;
+                const std::array<std::uint8_t, 16> before = V;
+#endif
 
-        case 0xE000: // Key operations
-        {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t key = V[x];
+                ops[body].handler(*this, ops[body].instruction);
+                ++cycles;
+                ++executed;
 
-            switch (opcode & 0x00FF)
-            {
-            case 0x9E: // EX9E - SKP Vx - skip next instruction if key with value of Vx is pressed
-            {
-                std::cout << "Instruction: SKP V" << +x << '\n';
+#if CHIP8_TRACE
+                RecordTrace(traceBuffer, cycles - 1, tracedPc, ops[body].instruction.opcode, I, before, V);
+#endif
 
-                if (keypad[key] != 0)
+                if (pc < start + 2 * length)
                 {
-                    pc += 4;
+                    executed += skipIdle(budget - executed);
                 }
+            }
+        }
 
-                else
-                {
-                    pc += 2;
-                }
+        return executed;
+    }
 
-                break;
+    std::uint64_t Chip8::runJit(std::uint64_t budget)
+    {
+#if CHIP8_TRACE
+        // Generated code does not record trace entries
+        return runBlocks(budget);
+#else
+        std::uint64_t executed = 0;
+
+        while (executed < budget)
+        {
+            if (pc >= GuestMemory::SIZE - 1)
+            {
+                throw std::runtime_error("Program counter out of bounds: " + ToHex(pc));
             }
 
-            case 0xA1: // EXA1 - SKNP Vx - skip next instruction if key with value of Vx is not pressed
+            const Jit::CompiledBlock *block = jit->Find(pc);
+            if (!block && !jit->IsInterpreted(pc))
             {
-                std::cout << "Instruction: SKNP V" << +x << '\n';
+                block = jit->Compile(memory, pc);
+            }
 
-                if (keypad[key] == 0)
+            // Runs of instructions the JIT leaves alone stay in this loop
+            if (!block)
+            {
+                do
                 {
-                    pc += 4;
-                }
+                    const std::uint16_t at = pc;
+                    emulateCycle();
+                    ++executed;
+
+                    if (pc <= at)
+                    {
+                        executed += skipIdle(budget - executed);
+                    }
+                } while (executed < budget && pc < GuestMemory::SIZE - 1 && jit->IsInterpreted(pc));
 
-                else
+                continue;
+            }
+
+            if (block->length > budget - executed)
+            {
+                const std::uint16_t at = pc;
+                emulateCycle();
+                ++executed;
+
+                if (pc <= at)
                 {
-                    pc += 2;
+                    executed += skipIdle(budget - executed);
                 }
 
-                break;
+                continue;
             }
 
-            default:
+            const std::uint16_t end = block->end;
+            const std::uint32_t retired = jit->Run(*block);
+            cycles += retired;
+            executed += retired;
+
+            perf.AddFamilies(jit->Families(*block), block->familyCount);
+
+            if (pc < end)
             {
-                throw std::runtime_error("Unsupported EX instruction: " + intToHex(opcode));
-                break;
+                executed += skipIdle(budget - executed);
             }
-            }
-            break;
         }
 
-        case 0xF000:
+        return executed;
+#endif
+    }
+
+    std::uint64_t Chip8::runAot(std::uint64_t budget)
+    {
+#if CHIP8_TRACE
+        // Compiled code does not record trace entries
+        return runBlocks(budget);
+#else
+        if (!aotResolved)
         {
-            std::uint8_t x = (opcode & 0x0F00) >> 8;
-            std::uint8_t subcode = opcode & 0x00FF;
-            std::cout << "Subcode: " << intToHex(subcode) << '\n';
+            resolveAot();
+        }
 
-            switch (subcode)
-            {
-            case 0x07: // FX07 - LD Vx, DT - loads the value of the delay timer to Vx register
+        std::uint64_t executed = 0;
+
+        while (executed < budget)
+        {
+            if (pc >= GuestMemory::SIZE - 1)
             {
-                std::cout << "Instruction: LD V" << +x << ", DT\n";
-                V[x] = delay_timer;
-                pc += 2;
-                break;
+                throw std::runtime_error("Program counter out of bounds: " + ToHex(pc));
             }
 
-            case 0x0A: // FX0A - LD Vx, K - waits for a key press and stores the value in Vx register
+            // Computed dispatch: returns and BNNN land on any block start through the table
+            const std::int32_t index = aotProgram ? aotLookup[pc] : -1;
+            if (index < 0 || !aotLive[index] || aotProgram->blocks[index].length > budget - executed)
             {
-                std::cout << "Instruction: LD V" << +x << ", K\n";
+                const std::uint16_t at = pc;
+                emulateCycle();
+                ++executed;
 
-                bool keyPressed = false;
-
-                for (std::size_t i = 0; i < 16; i++)
+                if (pc <= at)
                 {
-                    if (keypad[i] != 0)
-                    {
-                        V[x] = i;
-                        keyPressed = true;
-                        break;
-                    }
+                    executed += skipIdle(budget - executed);
                 }
 
-                if (!keyPressed)
-                {
-                    return;
-                }
-
-                pc += 2;
-                break;
+                continue;
             }
 
-            case 0x15: // FX15 - LD DT, Vx - sets the delay timer to the value of Vx register
-            {
-                std::cout << "Instruction: LD DT, V" << +x << "\n";
-                delay_timer = V[x];
-                pc += 2;
-                break;
-            }
+            const AotBlock &block = aotProgram->blocks[index];
+            block.function(aotContext);
+            executed += block.length;
+            perf.AddFamilies(block.families, block.familyCount);
 
-            case 0x18: // FX18 - LD ST, Vx - sets the sound timer to the value of Vx register
+            if (pc < block.end)
             {
-                std::cout << "Instruction: LD ST, V" << +x << '\n';
-                sound_timer = V[x];
-                pc += 2;
-                break;
+                executed += skipIdle(budget - executed);
             }
+        }
 
-            case 0x1E: // FX1E - ADD I, Vx - adds the value of Vx register to I register
-            {
-                std::cout << "Instruction: ADD I, V" << +x << '\n';
-                I += V[x];
-                pc += 2;
-                break;
-            }
+        return executed;
+#endif
+    }
+
+    void Chip8::resolveAot()
+    {
+        aotResolved = true;
+        aotProgram = romHash != 0 ? FindAotProgram(romHash, profile) : nullptr;
+        if (!aotProgram)
+        {
+            return;
+        }
+
+        aotLookup.assign(GuestMemory::SIZE, -1);
+        aotCoverage.assign(GuestMemory::SIZE, 0);
+        aotLive.assign(aotProgram->blockCount, 1);
 
-            case 0x29: // FX29 - LD F, Vx - sets I to the location of the sprite for the character in Vx register
+        for (std::uint16_t i = 0; i < aotProgram->blockCount; ++i)
+        {
+            const AotBlock &block = aotProgram->blocks[i];
+            aotLookup[block.start] = i;
+            for (std::uint32_t address = block.start; address < block.end; ++address)
             {
-                I = FONTSET_START_ADDRESS + (V[x] * 5);
-                std::cout << "Instruction: LD F, V" << +x << " → I = " << intToHex(I) << '\n';
-                pc += 2;
-                break;
+                ++aotCoverage[address];
             }
+        }
 
-            case 0x33: // FX33 - LD B, Vx - stores the binary-coded decimal representation of Vx in memory locations I, I+1, and I+2
+        // Writes since the ROM was loaded were not tracked yet
+        for (std::uint16_t offset = 0; offset < aotProgram->romSize; ++offset)
+        {
+            const std::uint16_t address = 0x200 + offset;
+            if (memory[address] != aotProgram->rom[offset])
             {
-                std::cout << "Instruction: LD B, V" << +x << '\n';
-                memory[I] = V[x] / 100;
-                memory[I + 1] = (V[x] / 10) % 10;
-                memory[I + 2] = V[x] % 10;
-                pc += 2;
-                break;
+                invalidateAot(address);
             }
+        }
+    }
+
+    void Chip8::invalidateAot(std::uint16_t address)
+    {
+        if (aotCoverage[address] == 0)
+        {
+            return;
+        }
 
-            case 0x55: // FX55 - LD [I], Vx — Store V0 to Vx in memory starting at I
+        // Blocks are at most MAX_BLOCK_LENGTH instructions long
+        const std::uint32_t first = address >= 2 * BlockCache::MAX_BLOCK_LENGTH ? address - 2 * BlockCache::MAX_BLOCK_LENGTH + 1 : 0;
+        for (std::uint32_t start = first; start <= address; ++start)
+        {
+            const std::int32_t index = aotLookup[start];
+            if (index >= 0 && aotLive[index] && aotProgram->blocks[index].end > address)
             {
-                std::cout << "Instruction: LD [I], V" << +x << '\n';
+                aotLive[index] = 0;
 
-                for (std::size_t i = 0; i <= x; ++i)
+                const AotBlock &block = aotProgram->blocks[index];
+                for (std::uint32_t covered = block.start; covered < block.end; ++covered)
                 {
-                    memory[I + i] = V[i];
+                    --aotCoverage[covered];
                 }
-
-                pc += 2;
-                break;
             }
+        }
+    }
 
-            case 0x65: // FX65 - LD Vx, [I]
-            {
-                std::cout << "Instruction: LD V" << +x << ", [I]\n";
-                for (std::size_t i = 0; i <= x; ++i)
-                {
-                    V[i] = memory[I + i];
-                }
+    void Chip8::writeMemory(std::uint16_t address, std::uint8_t value)
+    {
+        // FX33/FX55 near the end of memory wrap around like reads do
+        address &= GuestMemory::SIZE - 1;
+        memory.Write(address, value);
+        invalidate(address);
+    }
 
-                pc += 2;
-                break;
-            }
+    void Chip8::invalidate(std::uint16_t address)
+    {
+        blockCache.Invalidate(address);
 
-            default:
-            {
-                throw std::runtime_error("Unsupported FX instruction: " + intToHex(opcode));
-                break;
-            }
-            }
-            break;
+        if (jit)
+        {
+            jit->Invalidate(address);
         }
 
-        default:
+        if (aotProgram)
         {
-            throw std::runtime_error("Not supported opcode: " + intToHex(opcode));
-            break;
+            invalidateAot(address);
         }
+
+        // The byte belongs to the opcodes starting at address and address - 1
+        decodeCache[address].op = Op::Undecoded;
+        if (address > 0)
+        {
+            decodeCache[address - 1].op = Op::Undecoded;
         }
     }
 
-    const std::uint8_t *Chip8::GetGfx() const
+    const std::uint64_t *Chip8::GetGfx() const
     {
         return gfx.data();
     }
@@ -577,6 +1260,38 @@ namespace chip8
 
     void Chip8::ClearDrawFlag()
     {
+        perf.renders += DrawFlag ? 1 : 0;
         DrawFlag = false;
+        dirtyRows = 0;
+    }
+
+    std::uint32_t Chip8::GetDirtyRows() const
+    {
+        return dirtyRows;
+    }
+
+    void Chip8::AttachTrace(trace::TraceBuffer *buffer)
+    {
+        traceBuffer = buffer;
+    }
+
+    std::uint64_t Chip8::GetCycleCount() const
+    {
+        return cycles;
+    }
+
+    PerfCounters Chip8::GetPerfCounters() const
+    {
+        PerfCounters counters = perf;
+
+        // Every engine feeds the histogram, so it also gives the executed cycles
+        for (std::uint64_t count : counters.families)
+        {
+            counters.cycles += count;
+        }
+
+        counters.timerUnderflows += (delay_timer != 0 && timerValue(delay_timer, delayTimerSetAt) == 0) ? 1 : 0;
+        counters.timerUnderflows += (sound_timer != 0 && timerValue(sound_timer, soundTimerSetAt) == 0) ? 1 : 0;
+        return counters;
     }
 }
@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Chip8.hpp"
+#include "Debugger.hpp"
+
+namespace
+{
+    bool Compare(std::uint8_t left, chip8::Condition condition, std::uint8_t right)
+    {
+        switch (condition)
+        {
+        case chip8::Condition::Equal:
+            return left == right;
+        case chip8::Condition::NotEqual:
+            return left != right;
+        case chip8::Condition::Less:
+            return left < right;
+        case chip8::Condition::LessEqual:
+            return left <= right;
+        case chip8::Condition::Greater:
+            return left > right;
+        case chip8::Condition::GreaterEqual:
+        default:
+            return left >= right;
+        }
+    }
+
+    constexpr const char *CONDITION_NAMES[] = {"==", "!=", "<", "<=", ">", ">="};
+}
+
+namespace chip8
+{
+    Debugger::Debugger(Chip8 &debugged) : chip(debugged)
+    {
+        if (chip.debugger != nullptr)
+        {
+            throw std::invalid_argument("The chip already has a debugger");
+        }
+
+        chip.debugger = this;
+    }
+
+    Debugger::~Debugger()
+    {
+        chip.debugger = nullptr;
+    }
+
+    std::uint32_t Debugger::AddBreakpoint(std::uint16_t address)
+    {
+        if (address >= GuestMemory::SIZE)
+        {
+            throw std::invalid_argument("Breakpoint address out of range: " + std::to_string(address));
+        }
+
+        breakpoints.push_back(Breakpoint{nextId, address});
+        update();
+        return nextId++;
+    }
+
+    std::uint32_t Debugger::AddBreakpoint(std::uint16_t address, std::uint8_t reg, Condition condition,
+                                          std::uint8_t value)
+    {
+        if (address >= GuestMemory::SIZE && address != Breakpoint::ANY_ADDRESS)
+        {
+            throw std::invalid_argument("Breakpoint address out of range: " + std::to_string(address));
+        }
+
+        if (reg > 0xF)
+        {
+            throw std::invalid_argument("No register V" + std::to_string(reg));
+        }
+
+        breakpoints.push_back(Breakpoint{nextId, address, true, reg, condition, value});
+        update();
+        return nextId++;
+    }
+
+    std::uint32_t Debugger::AddWatchpoint(std::uint16_t first, std::uint16_t last, WatchKind kind)
+    {
+        if (first > last || last >= GuestMemory::SIZE)
+        {
+            throw std::invalid_argument("Invalid watchpoint range: " + std::to_string(first) + " to " +
+                                        std::to_string(last));
+        }
+
+        watchpoints.push_back(Watchpoint{nextId, first, last, kind});
+        update();
+        return nextId++;
+    }
+
+    bool Debugger::Remove(std::uint32_t id)
+    {
+        const std::size_t count = breakpoints.size() + watchpoints.size();
+
+        breakpoints.erase(std::remove_if(breakpoints.begin(), breakpoints.end(),
+                                         [id](const Breakpoint &breakpoint) { return breakpoint.id == id; }),
+                          breakpoints.end());
+        watchpoints.erase(std::remove_if(watchpoints.begin(), watchpoints.end(),
+                                         [id](const Watchpoint &watchpoint) { return watchpoint.id == id; }),
+                          watchpoints.end());
+
+        update();
+        return breakpoints.size() + watchpoints.size() != count;
+    }
+
+    void Debugger::Clear()
+    {
+        breakpoints.clear();
+        watchpoints.clear();
+        update();
+    }
+
+    const std::vector<Breakpoint> &Debugger::GetBreakpoints() const
+    {
+        return breakpoints;
+    }
+
+    const std::vector<Watchpoint> &Debugger::GetWatchpoints() const
+    {
+        return watchpoints;
+    }
+
+    void Debugger::Continue()
+    {
+        resume(Mode::Run);
+    }
+
+    void Debugger::Step(std::uint64_t count)
+    {
+        if (count == 0)
+        {
+            throw std::invalid_argument("Step count must be positive");
+        }
+
+        resume(Mode::Step);
+        stepsLeft = count;
+    }
+
+    void Debugger::StepOver()
+    {
+        const std::uint16_t opcode = chip.memory[chip.pc] << 8 | chip.memory[chip.pc + 1];
+
+        if ((opcode & 0xF000) != 0x2000)
+        {
+            Step();
+            return;
+        }
+
+        resume(Mode::StepOver);
+        returnAddress = static_cast<std::uint16_t>(chip.pc + 2);
+        depth = chip.sp;
+    }
+
+    void Debugger::StepOut()
+    {
+        resume(Mode::StepOut);
+        depth = chip.sp;
+    }
+
+    void Debugger::RunToFrame(std::uint64_t frame)
+    {
+        resume(Mode::Frame);
+        targetFrame = frame;
+    }
+
+    void Debugger::Pause()
+    {
+        stop(StopReason::Step);
+    }
+
+    std::uint64_t Debugger::GetFrame() const
+    {
+        return chip.timerTicks();
+    }
+
+    bool Debugger::IsStopped() const
+    {
+        return stopped;
+    }
+
+    const StopEvent &Debugger::GetStop() const
+    {
+        return event;
+    }
+
+    std::uint64_t Debugger::run(std::uint64_t budget)
+    {
+        std::uint64_t executed = 0;
+
+        // Wait loops are not skipped: registers change while the delay timer is polled
+        while (executed < budget && !stopped)
+        {
+            const std::uint16_t at = chip.pc;
+
+            if (!passBreakpoint && (breakAnywhere || breakAt[at & (GuestMemory::SIZE - 1)]))
+            {
+                if (Breakpoint *breakpoint = checkBreakpoints(at))
+                {
+                    ++breakpoint->hits;
+                    stop(StopReason::Breakpoint, breakpoint->id);
+                    break;
+                }
+            }
+
+            passBreakpoint = false;
+
+            StopEvent access;
+            const bool watched = !watchpoints.empty() && checkWatchpoints(at, access);
+
+            chip.emulateCycle();
+            ++executed;
+
+            if (watched)
+            {
+                for (Watchpoint &watchpoint : watchpoints)
+                {
+                    const bool kind = static_cast<std::uint8_t>(watchpoint.kind) &
+                                      static_cast<std::uint8_t>(access.write ? WatchKind::Write : WatchKind::Read);
+
+                    if (kind && access.address >= watchpoint.first && access.address <= watchpoint.last)
+                    {
+                        ++watchpoint.hits;
+                        stop(StopReason::Watchpoint, watchpoint.id);
+                        event.address = access.address;
+                        event.write = access.write;
+                        event.at = at;
+                        break;
+                    }
+                }
+
+                break;
+            }
+
+            switch (mode)
+            {
+            case Mode::Step:
+                if (--stepsLeft == 0)
+                {
+                    stop(StopReason::Step);
+                }
+                break;
+
+            case Mode::StepOver:
+                if (chip.pc == returnAddress && chip.sp == depth)
+                {
+                    stop(StopReason::Step);
+                }
+                break;
+
+            case Mode::StepOut:
+                if (chip.sp < depth)
+                {
+                    stop(StopReason::Step);
+                }
+                break;
+
+            case Mode::Frame:
+                if (GetFrame() >= targetFrame)
+                {
+                    stop(StopReason::Frame);
+                }
+                break;
+
+            case Mode::Run:
+                break;
+            }
+        }
+
+        return executed;
+    }
+
+    Breakpoint *Debugger::checkBreakpoints(std::uint16_t pc)
+    {
+        for (Breakpoint &breakpoint : breakpoints)
+        {
+            if (breakpoint.address != pc && breakpoint.address != Breakpoint::ANY_ADDRESS)
+            {
+                continue;
+            }
+
+            if (!breakpoint.conditional || Compare(chip.V[breakpoint.reg], breakpoint.condition, breakpoint.value))
+            {
+                return &breakpoint;
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool Debugger::checkWatchpoints(std::uint16_t pc, StopEvent &access)
+    {
+        const Instruction instruction = Decode(chip.memory[pc] << 8 | chip.memory[pc + 1]);
+
+        // Data accessed by the instruction, addresses wrapping like GuestMemory
+        std::size_t count = 0;
+        bool write = false;
+
+        switch (instruction.op)
+        {
+        case Op::DRW:
+            count = instruction.n;
+            if (GetQuirks(chip.profile).clipSprites)
+            {
+                count = std::min<std::size_t>(count, SCREEN_HEIGHT - (chip.V[instruction.y] & (SCREEN_HEIGHT - 1)));
+            }
+            break;
+
+        case Op::LD_VX_MEM:
+            count = instruction.x + 1u;
+            break;
+
+        case Op::LD_B_VX:
+            count = 3;
+            write = true;
+            break;
+
+        case Op::LD_MEM_VX:
+            count = instruction.x + 1u;
+            write = true;
+            break;
+
+        default:
+            return false;
+        }
+
+        const std::bitset<GuestMemory::SIZE> &watched = write ? watchWrites : watchReads;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const std::size_t address = (chip.I + i) & (GuestMemory::SIZE - 1);
+            if (watched[address])
+            {
+                access.address = static_cast<std::uint16_t>(address);
+                access.write = write;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Debugger::stop(StopReason reason, std::uint32_t id)
+    {
+        stopped = true;
+        event = StopEvent{reason, chip.pc, id};
+        mode = Mode::Run;
+        update();
+    }
+
+    void Debugger::resume(Mode newMode)
+    {
+        // The instruction the machine stopped at runs before its breakpoint counts again
+        passBreakpoint = stopped;
+        stopped = false;
+        event = StopEvent{};
+        mode = newMode;
+        update();
+    }
+
+    void Debugger::update()
+    {
+        breakAt.reset();
+        breakAnywhere = false;
+        for (const Breakpoint &breakpoint : breakpoints)
+        {
+            if (breakpoint.address == Breakpoint::ANY_ADDRESS)
+            {
+                breakAnywhere = true;
+            }
+            else
+            {
+                breakAt.set(breakpoint.address);
+            }
+        }
+
+        watchReads.reset();
+        watchWrites.reset();
+        for (const Watchpoint &watchpoint : watchpoints)
+        {
+            for (std::size_t address = watchpoint.first; address <= watchpoint.last; ++address)
+            {
+                if (static_cast<std::uint8_t>(watchpoint.kind) & static_cast<std::uint8_t>(WatchKind::Read))
+                {
+                    watchReads.set(address);
+                }
+
+                if (static_cast<std::uint8_t>(watchpoint.kind) & static_cast<std::uint8_t>(WatchKind::Write))
+                {
+                    watchWrites.set(address);
+                }
+            }
+        }
+
+        armed = stopped || mode != Mode::Run || !breakpoints.empty() || !watchpoints.empty();
+    }
+
+    bool ParseCondition(const std::string &text, Condition &condition)
+    {
+        for (std::size_t i = 0; i < sizeof(CONDITION_NAMES) / sizeof(CONDITION_NAMES[0]); ++i)
+        {
+            if (text == CONDITION_NAMES[i])
+            {
+                condition = static_cast<Condition>(i);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const char *ConditionName(Condition condition)
+    {
+        return CONDITION_NAMES[static_cast<std::size_t>(condition)];
+    }
+}
@@ -0,0 +1,128 @@
+#include "Decoder.hpp"
+
+namespace
+{
+    chip8::Op DecodeOp(std::uint16_t opcode)
+    {
+        using chip8::Op;
+
+        switch (opcode & 0xF000)
+        {
+        case 0x0000:
+            switch (opcode)
+            {
+            case 0x00E0:
+                return Op::CLS;
+            case 0x00EE:
+                return Op::RET;
+            case 0x0000:
+                return Op::NOP;
+            default:
+                return Op::Invalid;
+            }
+
+        case 0x1000:
+            return Op::JP;
+        case 0x2000:
+            return Op::CALL;
+        case 0x3000:
+            return Op::SE_VX_NN;
+        case 0x4000:
+            return Op::SNE_VX_NN;
+        case 0x5000:
+            return (opcode & 0x000F) == 0 ? Op::SE_VX_VY : Op::Invalid;
+        case 0x6000:
+            return Op::LD_VX_NN;
+        case 0x7000:
+            return Op::ADD_VX_NN;
+
+        case 0x8000:
+            switch (opcode & 0x000F)
+            {
+            case 0x0:
+                return Op::LD_VX_VY;
+            case 0x1:
+                return Op::OR_VX_VY;
+            case 0x2:
+                return Op::AND_VX_VY;
+            case 0x3:
+                return Op::XOR_VX_VY;
+            case 0x4:
+                return Op::ADD_VX_VY;
+            case 0x5:
+                return Op::SUB_VX_VY;
+            case 0x6:
+                return Op::SHR_VX;
+            case 0x7:
+                return Op::SUBN_VX_VY;
+            case 0xE:
+                return Op::SHL_VX;
+            default:
+                return Op::Invalid;
+            }
+
+        case 0x9000:
+            return (opcode & 0x000F) == 0 ? Op::SNE_VX_VY : Op::Invalid;
+        case 0xA000:
+            return Op::LD_I_NNN;
+        case 0xB000:
+            return Op::JP_V0_NNN;
+        case 0xC000:
+            return Op::RND_VX_NN;
+        case 0xD000:
+            return Op::DRW;
+
+        case 0xE000:
+            switch (opcode & 0x00FF)
+            {
+            case 0x9E:
+                return Op::SKP_VX;
+            case 0xA1:
+                return Op::SKNP_VX;
+            default:
+                return Op::Invalid;
+            }
+
+        default: // 0xF000
+            switch (opcode & 0x00FF)
+            {
+            case 0x07:
+                return Op::LD_VX_DT;
+            case 0x0A:
+                return Op::LD_VX_K;
+            case 0x15:
+                return Op::LD_DT_VX;
+            case 0x18:
+                return Op::LD_ST_VX;
+            case 0x1E:
+                return Op::ADD_I_VX;
+            case 0x29:
+                return Op::LD_F_VX;
+            case 0x33:
+                return Op::LD_B_VX;
+            case 0x55:
+                return Op::LD_MEM_VX;
+            case 0x65:
+                return Op::LD_VX_MEM;
+            default:
+                return Op::Invalid;
+            }
+        }
+    }
+}
+
+namespace chip8
+{
+    Instruction Decode(std::uint16_t opcode)
+    {
+        Instruction instruction;
+        instruction.op = DecodeOp(opcode);
+        instruction.x = (opcode & 0x0F00) >> 8;
+        instruction.y = (opcode & 0x00F0) >> 4;
+        instruction.n = opcode & 0x000F;
+        instruction.nn = opcode & 0x00FF;
+        instruction.nnn = opcode & 0x0FFF;
+        instruction.opcode = opcode;
+        return instruction;
+    }
+}
@@ -0,0 +1,159 @@
+#include <sstream>
+
+#include "Disassembler.hpp"
+
+namespace
+{
+    std::string Reg(std::uint8_t index)
+    {
+        return "V" + std::to_string(index);
+    }
+}
+
+namespace chip8
+{
+    std::string ToHex(std::uint16_t value)
+    {
+        std::stringstream stream;
+        stream << std::hex << std::uppercase << "0x" << value;
+        return stream.str();
+    }
+
+    std::string Disassemble(std::uint16_t opcode)
+    {
+        const std::uint8_t x = (opcode & 0x0F00) >> 8;
+        const std::uint8_t y = (opcode & 0x00F0) >> 4;
+        const std::uint8_t n = opcode & 0x000F;
+        const std::uint8_t nn = opcode & 0x00FF;
+        const std::uint16_t nnn = opcode & 0x0FFF;
+        const std::string nnStr = std::to_string(nn);
+
+        switch (opcode & 0xF000)
+        {
+        case 0x0000:
+            switch (opcode)
+            {
+            case 0x00E0:
+                return "CLS";
+            case 0x00EE:
+                return "RET";
+            case 0x0000:
+                return "NOP";
+            default:
+                break;
+            }
+            break;
+
+        case 0x1000:
+            return "JP " + ToHex(nnn);
+        case 0x2000:
+            return "CALL " + ToHex(nnn);
+        case 0x3000:
+            return "SE " + Reg(x) + ", " + nnStr;
+        case 0x4000:
+            return "SNE " + Reg(x) + ", " + nnStr;
+        case 0x5000:
+            if (n == 0)
+                return "SE " + Reg(x) + ", " + Reg(y);
+            break;
+        case 0x6000:
+            return "LD " + Reg(x) + ", " + nnStr;
+        case 0x7000:
+            return "ADD " + Reg(x) + ", " + nnStr;
+
+        case 0x8000:
+            switch (n)
+            {
+            case 0x0:
+                return "LD " + Reg(x) + ", " + Reg(y);
+            case 0x1:
+                return "OR " + Reg(x) + ", " + Reg(y);
+            case 0x2:
+                return "AND " + Reg(x) + ", " + Reg(y);
+            case 0x3:
+                return "XOR " + Reg(x) + ", " + Reg(y);
+            case 0x4:
+                return "ADD " + Reg(x) + ", " + Reg(y);
+            case 0x5:
+                return "SUB " + Reg(x) + ", " + Reg(y);
+            case 0x6:
+                return "SHR " + Reg(x);
+            case 0x7:
+                return "SUBN " + Reg(x) + ", " + Reg(y);
+            case 0xE:
+                return "SHL " + Reg(x);
+            default:
+                break;
+            }
+            break;
+
+        case 0x9000:
+            if (n == 0)
+                return "SNE " + Reg(x) + ", " + Reg(y);
+            break;
+        case 0xA000:
+            return "LD I, " + ToHex(nnn);
+        case 0xB000:
+            return "JP V0, " + ToHex(nnn);
+        case 0xC000:
+            return "RND " + Reg(x) + ", " + nnStr;
+        case 0xD000:
+            return "DRW " + Reg(x) + ", " + Reg(y) + ", " + std::to_string(n);
+
+        case 0xE000:
+            if (nn == 0x9E)
+                return "SKP " + Reg(x);
+            if (nn == 0xA1)
+                return "SKNP " + Reg(x);
+            break;
+
+        case 0xF000:
+            switch (nn)
+            {
+            case 0x07:
+                return "LD " + Reg(x) + ", DT";
+            case 0x0A:
+                return "LD " + Reg(x) + ", K";
+            case 0x15:
+                return "LD DT, " + Reg(x);
+            case 0x18:
+                return "LD ST, " + Reg(x);
+            case 0x1E:
+                return "ADD I, " + Reg(x);
+            case 0x29:
+                return "LD F, " + Reg(x);
+            case 0x33:
+                return "LD B, " + Reg(x);
+            case 0x55:
+                return "LD [I], " + Reg(x);
+            case 0x65:
+                return "LD " + Reg(x) + ", [I]";
+            default:
+                break;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        return "DW " + ToHex(opcode);
+    }
+
+    std::string DescribeInvalid(std::uint16_t opcode)
+    {
+        switch (opcode & 0xF000)
+        {
+        case 0x0000:
+            return "Unknown instruction: " + ToHex(opcode);
+        case 0x8000:
+            return "Unsupported 0x8XY* instruction: " + ToHex(opcode);
+        case 0xE000:
+            return "Unsupported EX instruction: " + ToHex(opcode);
+        case 0xF000:
+            return "Unsupported FX instruction: " + ToHex(opcode);
+        default:
+            return "Invalid instruction: " + ToHex(opcode);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#include "Engine.hpp"
+
+namespace chip8
+{
+    bool ParseEngine(const std::string &name, Engine &engine)
+    {
+        if (name == "interpreter")
+        {
+            engine = Engine::Interpreter;
+            return true;
+        }
+
+        if (name == "blocks")
+        {
+            engine = Engine::BlockCache;
+            return true;
+        }
+
+        if (name == "jit")
+        {
+            engine = Engine::Jit;
+            return true;
+        }
+
+        if (name == "aot")
+        {
+            engine = Engine::Aot;
+            return true;
+        }
+
+        return false;
+    }
+
+    const char *EngineName(Engine engine)
+    {
+        switch (engine)
+        {
+        case Engine::BlockCache:
+            return "blocks";
+        case Engine::Jit:
+            return "jit";
+        case Engine::Aot:
+            return "aot";
+        case Engine::Interpreter:
+        default:
+            return "interpreter";
+        }
+    }
+}
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Fuzz.hpp"
+#include "Movie.hpp"
+#include "RomLibrary.hpp"
+
+namespace chip8
+{
+    const char *FindingName(Finding finding)
+    {
+        switch (finding)
+        {
+        case Finding::MemoryWrap:
+            return "memory access wrapping past 4 KB";
+        case Finding::StackOverflow:
+            return "stack overflow";
+        case Finding::StackUnderflow:
+            return "stack underflow";
+        case Finding::KeyOutOfRange:
+            return "key index out of range";
+        case Finding::None:
+        default:
+            return "none";
+        }
+    }
+
+    FuzzHarness::FuzzHarness(Profile profile, std::uint64_t cycleBudget, bool reportWraps)
+        : chip(profile), budget(cycleBudget), reportWraps(reportWraps)
+    {
+        if (budget == 0)
+        {
+            throw std::invalid_argument("Cycle budget must be positive");
+        }
+
+        chip.reset();
+        chip.SaveState(clean);
+        loaded = clean;
+    }
+
+    FuzzResult FuzzHarness::Run(const std::uint8_t *data, std::size_t size)
+    {
+        ++executions;
+
+        const std::size_t events = size == 0 ? 0 : std::min<std::size_t>(data[0], (size - 1) / 3);
+        const std::uint8_t *script = size == 0 ? data : data + 1;
+        const std::uint8_t *rom = script + 3 * events;
+        const std::size_t romSize = std::min<std::size_t>(size - (rom - data), MAX_ROM_SIZE);
+
+        // Only the bytes that differ from the last execution are rewritten and invalidated
+        std::fill(loaded.memory.begin() + 0x200, loaded.memory.begin() + 0x200 + lastRomSize, 0);
+        std::copy(rom, rom + romSize, loaded.memory.begin() + 0x200);
+        lastRomSize = romSize;
+        chip.LoadState(loaded);
+
+        FuzzResult result;
+        std::size_t nextEvent = 0;
+        std::uint64_t eventCycle = events > 0 ? script[0] : 0;
+
+        try
+        {
+            while (result.cycles < budget)
+            {
+                for (; nextEvent < events && result.cycles >= eventCycle; ++nextEvent)
+                {
+                    const std::uint8_t *event = script + 3 * nextEvent;
+                    UnpackKeypad(static_cast<std::uint16_t>(event[1] | event[2] << 8), chip.GetKeypad());
+
+                    if (nextEvent + 1 < events)
+                    {
+                        eventCycle += event[3];
+                    }
+                }
+
+                result.finding = check();
+                if (result.finding != Finding::None)
+                {
+                    result.pc = chip.pc;
+                    result.opcode = static_cast<std::uint16_t>(chip.memory[chip.pc] << 8 | chip.memory[chip.pc + 1]);
+                    break;
+                }
+
+                const std::uint16_t at = chip.pc;
+                chip.emulateCycle();
+                ++result.cycles;
+
+                // A jump to itself or FX0A without a key can't lead anywhere new once the script is done
+                if (chip.pc == at && nextEvent == events)
+                {
+                    const std::uint16_t opcode = chip.memory[at] << 8 | chip.memory[at + 1];
+                    if ((opcode & 0xF000) == 0x1000 || (opcode & 0xF000) == 0xB000 || (opcode & 0xF0FF) == 0xF00A)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Invalid opcodes and a pc running off memory are errors the core already reports
+        catch (const std::runtime_error &)
+        {
+            result.guestError = true;
+        }
+
+        return result;
+    }
+
+    std::uint64_t FuzzHarness::GetExecutions() const
+    {
+        return executions;
+    }
+
+    Finding FuzzHarness::check() const
+    {
+        const std::uint16_t opcode = chip.memory[chip.pc] << 8 | chip.memory[chip.pc + 1];
+        const std::uint8_t x = (opcode >> 8) & 0xF;
+
+        switch (opcode & 0xF000)
+        {
+        case 0x0000:
+            return opcode == 0x00EE && chip.sp == 0 ? Finding::StackUnderflow : Finding::None;
+
+        case 0x2000:
+            return chip.sp >= chip.stack.size() ? Finding::StackOverflow : Finding::None;
+
+        case 0xD000:
+        {
+            if (!reportWraps)
+            {
+                return Finding::None;
+            }
+
+            std::size_t rows = opcode & 0xF;
+            if (GetQuirks(chip.profile).clipSprites)
+            {
+                const std::uint8_t y = chip.V[(opcode >> 4) & 0xF] & (SCREEN_HEIGHT - 1);
+                rows = std::min<std::size_t>(rows, SCREEN_HEIGHT - y);
+            }
+
+            return chip.I + rows > GuestMemory::SIZE ? Finding::MemoryWrap : Finding::None;
+        }
+
+        case 0xE000:
+            if ((opcode & 0xFF) == 0x9E || (opcode & 0xFF) == 0xA1)
+            {
+                return chip.V[x] > 0xF ? Finding::KeyOutOfRange : Finding::None;
+            }
+            return Finding::None;
+
+        case 0xF000:
+            if (!reportWraps)
+            {
+                return Finding::None;
+            }
+
+            switch (opcode & 0xFF)
+            {
+            case 0x33:
+                return chip.I + 3u > GuestMemory::SIZE ? Finding::MemoryWrap : Finding::None;
+            case 0x55:
+            case 0x65:
+                return chip.I + x + 1u > GuestMemory::SIZE ? Finding::MemoryWrap : Finding::None;
+            default:
+                return Finding::None;
+            }
+
+        default:
+            return Finding::None;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "GuestMemory.hpp"
+
+namespace
+{
+    const std::array<std::uint8_t, chip8::GuestMemory::PAGE_SIZE> ZERO_PAGE{};
+}
+
+namespace chip8
+{
+    GuestMemory::GuestMemory()
+    {
+        pages.fill(ZERO_PAGE.data());
+    }
+
+    void GuestMemory::Load(std::size_t address, const std::uint8_t *data, std::size_t size)
+    {
+        if (address + size > SIZE)
+        {
+            throw std::out_of_range("Guest memory load past 4 kB");
+        }
+
+        for (std::size_t page = address / PAGE_SIZE; page * PAGE_SIZE < address + size; ++page)
+        {
+            if ((ownedPages & (1u << page)) == 0)
+            {
+                own(page);
+            }
+        }
+
+        std::memcpy(owned->data() + address, data, size);
+    }
+
+    void GuestMemory::Map(std::size_t address, const std::uint8_t *data, std::size_t size)
+    {
+        if (address % PAGE_SIZE != 0 || address + size > SIZE)
+        {
+            throw std::invalid_argument("Guest memory mappings must be page aligned and inside 4 kB");
+        }
+
+        for (std::size_t offset = 0; offset < size; offset += PAGE_SIZE)
+        {
+            const std::size_t page = (address + offset) / PAGE_SIZE;
+            pages[page] = data + offset;
+            ownedPages &= ~(1u << page);
+        }
+    }
+
+    void GuestMemory::Clear()
+    {
+        pages.fill(ZERO_PAGE.data());
+        ownedPages = 0;
+    }
+
+    void GuestMemory::CopyTo(std::uint8_t *out) const
+    {
+        for (std::size_t page = 0; page < PAGES; ++page)
+        {
+            std::memcpy(out + page * PAGE_SIZE, pages[page], PAGE_SIZE);
+        }
+    }
+
+    std::size_t GuestMemory::GetPrivatePageCount() const
+    {
+        std::size_t count = 0;
+        for (std::uint32_t bits = ownedPages; bits != 0; bits &= bits - 1)
+        {
+            ++count;
+        }
+
+        return count;
+    }
+
+    void GuestMemory::own(std::size_t page)
+    {
+        if (!owned)
+        {
+            owned = std::make_unique<std::array<std::uint8_t, SIZE>>();
+        }
+
+        std::uint8_t *copy = owned->data() + page * PAGE_SIZE;
+        std::memcpy(copy, pages[page], PAGE_SIZE);
+        pages[page] = copy;
+        ownedPages |= 1u << page;
+    }
+}
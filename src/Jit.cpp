@@ -0,0 +1,532 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "BlockCache.hpp"
+#include "Chip8.hpp"
+#include "Jit.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHIP8_JIT_X64 1
+#else
+#define CHIP8_JIT_X64 0
+#endif
+
+namespace
+{
+    constexpr std::size_t CODE_SIZE = 4 << 20;
+    constexpr std::size_t MAX_INSTRUCTIONS = 1 << 16;
+    constexpr std::size_t MAX_BLOCK_BYTES = chip8::BlockCache::MAX_BLOCK_LENGTH * 64 + 64;
+
+    // Granularity of the code protection changes, the x86-64 page size
+    constexpr std::size_t HOST_PAGE_SIZE = 4096;
+
+    // Low three bits of the x86 registers used below
+    enum Reg : std::uint8_t
+    {
+        AL = 0,
+        CL = 1,
+        DL = 2,
+    };
+
+    /**
+     * @brief Minimal x86-64 machine code emitter.
+     * Register use inside a block: rbx = Context*, r12 = V, r14 = &I, r15 = &pc.
+     */
+    class Emitter
+    {
+    public:
+        std::vector<std::uint8_t> buffer;
+
+        void Bytes(std::initializer_list<std::uint8_t> bytes)
+        {
+            buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+        }
+
+        void Imm16(std::uint16_t value)
+        {
+            Bytes({static_cast<std::uint8_t>(value), static_cast<std::uint8_t>(value >> 8)});
+        }
+
+        void Imm32(std::uint32_t value)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                buffer.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        void Imm64(std::uint64_t value)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                buffer.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        void Prologue()
+        {
+            Bytes({0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57}); // push rbx, r12-r15
+#if defined(_WIN32)
+            Bytes({0x48, 0x83, 0xEC, 0x20}); // sub rsp, 32 (shadow space)
+            Bytes({0x48, 0x89, 0xCB});       // mov rbx, rcx
+#else
+            Bytes({0x48, 0x89, 0xFB}); // mov rbx, rdi
+#endif
+            Bytes({0x4C, 0x8B, 0x23});       // mov r12, [rbx]      ; V
+            Bytes({0x4C, 0x8B, 0x73, 0x08}); // mov r14, [rbx + 8]  ; &I
+            Bytes({0x4C, 0x8B, 0x7B, 0x10}); // mov r15, [rbx + 16] ; &pc
+        }
+
+        void Return(std::uint32_t retired)
+        {
+            Bytes({0xB8}); // mov eax, retired
+            Imm32(retired);
+#if defined(_WIN32)
+            Bytes({0x48, 0x83, 0xC4, 0x20}); // add rsp, 32
+#endif
+            Bytes({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3}); // pop r15-r12, rbx; ret
+        }
+
+        void LoadV(Reg reg, std::uint8_t index) // movzx reg32, byte [r12 + index]
+        {
+            Bytes({0x41, 0x0F, 0xB6, static_cast<std::uint8_t>(0x44 | (reg << 3)), 0x24, index});
+        }
+
+        void StoreV(std::uint8_t index, Reg reg) // mov byte [r12 + index], reg8
+        {
+            Bytes({0x41, 0x88, static_cast<std::uint8_t>(0x44 | (reg << 3)), 0x24, index});
+        }
+
+        void StoreVImm(std::uint8_t index, std::uint8_t value) // mov byte [r12 + index], value
+        {
+            Bytes({0x41, 0xC6, 0x44, 0x24, index, value});
+        }
+
+        void AddVImm(std::uint8_t index, std::uint8_t value) // add byte [r12 + index], value
+        {
+            Bytes({0x41, 0x80, 0x44, 0x24, index, value});
+        }
+
+        void CmpVImm(std::uint8_t index, std::uint8_t value) // cmp byte [r12 + index], value
+        {
+            Bytes({0x41, 0x80, 0x7C, 0x24, index, value});
+        }
+
+        void CmpAlV(std::uint8_t index) // cmp al, byte [r12 + index]
+        {
+            Bytes({0x41, 0x3A, 0x44, 0x24, index});
+        }
+
+        void StoreI(std::uint16_t value) // mov word [r14], value
+        {
+            Bytes({0x66, 0x41, 0xC7, 0x06});
+            Imm16(value);
+        }
+
+        void AddIAx() // add word [r14], ax
+        {
+            Bytes({0x66, 0x41, 0x01, 0x06});
+        }
+
+        void StorePc(std::uint16_t value) // mov word [r15], value
+        {
+            Bytes({0x66, 0x41, 0xC7, 0x07});
+            Imm16(value);
+        }
+
+        /**
+         * @brief pc = condition ? address + 4 : address + 2.
+         * @param skipIfEqual true for SE, false for SNE; flags must be set by a compare.
+         */
+        void Skip(std::uint16_t address, bool skipIfEqual)
+        {
+            StorePc(address + 2);                             // 6 bytes, flags preserved
+            Bytes({static_cast<std::uint8_t>(skipIfEqual ? 0x75 : 0x74), 0x06}); // jne/je over the next store
+            StorePc(address + 4);
+        }
+
+        /**
+         * @brief Calls handler(*context->chip, *instruction); the handler must not throw.
+         */
+        void CallHandler(chip8::MicroHandler handler, const chip8::Instruction *instruction)
+        {
+#if defined(_WIN32)
+            Bytes({0x48, 0x8B, 0x4B, 0x18}); // mov rcx, [rbx + 24] ; chip
+            Bytes({0x48, 0xBA});             // mov rdx, instruction
+#else
+            Bytes({0x48, 0x8B, 0x7B, 0x18}); // mov rdi, [rbx + 24] ; chip
+            Bytes({0x48, 0xBE});             // mov rsi, instruction
+#endif
+            Imm64(reinterpret_cast<std::uint64_t>(instruction));
+            Bytes({0x48, 0xB8}); // mov rax, handler
+            Imm64(reinterpret_cast<std::uint64_t>(handler));
+            Bytes({0xFF, 0xD0}); // call rax
+        }
+    };
+
+    /**
+     * @brief Emits native code for an operation.
+     * @return false if the operation has to go through the interpreter.
+     */
+    bool EmitNative(Emitter &e, const chip8::Instruction &in, std::uint16_t address, const chip8::Quirks &quirks)
+    {
+        using chip8::Op;
+
+        const bool usesFlag = in.x == 0xF || in.y == 0xF;
+
+        switch (in.op)
+        {
+        case Op::NOP:
+            return true;
+
+        case Op::JP:
+            e.StorePc(in.nnn);
+            return true;
+
+        case Op::SE_VX_NN:
+        case Op::SNE_VX_NN:
+            e.CmpVImm(in.x, in.nn);
+            e.Skip(address, in.op == Op::SE_VX_NN);
+            return true;
+
+        case Op::SE_VX_VY:
+        case Op::SNE_VX_VY:
+            e.LoadV(AL, in.x);
+            e.CmpAlV(in.y);
+            e.Skip(address, in.op == Op::SE_VX_VY);
+            return true;
+
+        case Op::LD_VX_NN:
+            e.StoreVImm(in.x, in.nn);
+            return true;
+
+        case Op::ADD_VX_NN:
+            e.AddVImm(in.x, in.nn);
+            return true;
+
+        case Op::LD_VX_VY:
+            e.LoadV(AL, in.y);
+            e.StoreV(in.x, AL);
+            return true;
+
+        case Op::OR_VX_VY:
+        case Op::AND_VX_VY:
+        case Op::XOR_VX_VY:
+        {
+            if (quirks.vfReset)
+                return false;
+            const std::uint8_t opcode = in.op == Op::OR_VX_VY ? 0x08 : in.op == Op::AND_VX_VY ? 0x20 : 0x30;
+            e.LoadV(AL, in.x);
+            e.LoadV(CL, in.y);
+            e.Bytes({opcode, 0xC8}); // or/and/xor al, cl
+            e.StoreV(in.x, AL);
+            return true;
+        }
+
+        case Op::ADD_VX_VY:
+            if (usesFlag)
+                return false;
+            e.LoadV(AL, in.x);
+            e.LoadV(CL, in.y);
+            e.Bytes({0x00, 0xC8});       // add al, cl
+            e.Bytes({0x0F, 0x92, 0xC2}); // setc dl
+            e.StoreV(in.x, AL);
+            e.StoreV(0xF, DL);
+            return true;
+
+        case Op::SUB_VX_VY:
+            if (usesFlag)
+                return false;
+            e.LoadV(AL, in.x);
+            e.LoadV(CL, in.y);
+            e.Bytes({0x38, 0xC8});       // cmp al, cl
+            e.Bytes({0x0F, 0x97, 0xC2}); // seta dl
+            e.Bytes({0x28, 0xC8});       // sub al, cl
+            e.StoreV(in.x, AL);
+            e.StoreV(0xF, DL);
+            return true;
+
+        case Op::SUBN_VX_VY: // Stores into Vy like the interpreter
+            if (usesFlag)
+                return false;
+            e.LoadV(AL, in.y);
+            e.LoadV(CL, in.x);
+            e.Bytes({0x38, 0xC8});       // cmp al, cl
+            e.Bytes({0x0F, 0x97, 0xC2}); // seta dl
+            e.Bytes({0x28, 0xC8});       // sub al, cl
+            e.StoreV(in.y, AL);
+            e.StoreV(0xF, DL);
+            return true;
+
+        case Op::SHR_VX:
+            if (in.x == 0xF || quirks.shiftVy)
+                return false;
+            e.LoadV(AL, in.x);
+            e.Bytes({0x88, 0xC2});       // mov dl, al
+            e.Bytes({0x80, 0xE2, 0x01}); // and dl, 1
+            e.Bytes({0xD0, 0xE8});       // shr al, 1
+            e.StoreV(in.x, AL);
+            e.StoreV(0xF, DL);
+            return true;
+
+        case Op::SHL_VX:
+            if (in.x == 0xF || quirks.shiftVy)
+                return false;
+            e.LoadV(AL, in.x);
+            e.Bytes({0x88, 0xC2});       // mov dl, al
+            e.Bytes({0xC0, 0xEA, 0x07}); // shr dl, 7
+            e.Bytes({0xD0, 0xE0});       // shl al, 1
+            e.StoreV(in.x, AL);
+            e.StoreV(0xF, DL);
+            return true;
+
+        case Op::LD_I_NNN:
+            e.StoreI(in.nnn);
+            return true;
+
+        case Op::ADD_I_VX:
+            e.LoadV(AL, in.x);
+            e.AddIAx();
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief Makes the host pages covering [begin, begin + size) writable or executable, never both.
+     */
+    void Protect(std::uint8_t *begin, std::size_t size, bool writable)
+    {
+        const auto first = reinterpret_cast<std::uintptr_t>(begin) & ~(HOST_PAGE_SIZE - 1);
+        const auto last = reinterpret_cast<std::uintptr_t>(begin) + size;
+        void *pages = reinterpret_cast<void *>(first);
+        const std::size_t length = last - first;
+
+#if defined(_WIN32)
+        DWORD previous = 0;
+        const bool changed = VirtualProtect(pages, length, writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &previous) != 0;
+#else
+        const bool changed = mprotect(pages, length, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+#endif
+        if (!changed)
+        {
+            throw std::runtime_error("JIT code protection couldn't be changed");
+        }
+    }
+}
+
+namespace chip8
+{
+    bool Jit::IsSupported()
+    {
+        return CHIP8_JIT_X64 != 0;
+    }
+
+    Jit::Jit(Chip8 &chip, std::uint8_t *V, std::uint16_t *I, std::uint16_t *pc, std::size_t memorySize,
+             const Quirks &quirks)
+        : context{V, I, pc, &chip},
+          quirks(quirks),
+          lookup(memorySize, -1),
+          pageBlocks((memorySize + PAGE_SIZE - 1) / PAGE_SIZE),
+          codePages(pageBlocks.size(), 0)
+    {
+        if (!IsSupported())
+        {
+            throw std::runtime_error("JIT is not supported on this platform");
+        }
+
+        // Never writable and executable at once: pages are flipped to
+        // executable once a block is copied in
+#if defined(_WIN32)
+        void *memory = VirtualAlloc(nullptr, CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (!memory)
+#else
+        void *memory = mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+#endif
+        {
+            throw std::runtime_error("JIT code buffer couldn't be allocated");
+        }
+
+        code = static_cast<std::uint8_t *>(memory);
+        codeSize = CODE_SIZE;
+        instructions.reserve(MAX_INSTRUCTIONS);
+        familyCounts.reserve(MAX_INSTRUCTIONS);
+    }
+
+    Jit::~Jit()
+    {
+#if defined(_WIN32)
+        VirtualFree(code, 0, MEM_RELEASE);
+#else
+        munmap(code, codeSize);
+#endif
+    }
+
+    const Jit::CompiledBlock *Jit::Compile(const GuestMemory &memory, std::uint16_t pc)
+    {
+        // Generated code embeds pointers into `instructions`, so both buffers
+        // are flushed together before they could overflow
+        if (codeUsed + MAX_BLOCK_BYTES > codeSize ||
+            instructions.size() + BlockCache::MAX_BLOCK_LENGTH > MAX_INSTRUCTIONS)
+        {
+            Clear();
+        }
+
+        Emitter e;
+        e.Prologue();
+
+        const MicroHandler *handlers = context.chip->handlers;
+        const MicroHandler *bodyHandlers = context.chip->bodyHandlers;
+        const std::size_t firstInstruction = instructions.size();
+
+        CompiledBlock block;
+        block.start = pc;
+        block.live = true;
+
+        std::array<std::uint8_t, OPCODE_FAMILIES> histogram{};
+        std::uint32_t address = pc;
+        bool terminated = false;
+
+        while (block.length < BlockCache::MAX_BLOCK_LENGTH && address + 1 < lookup.size())
+        {
+            const Instruction decoded = Decode(memory[address] << 8 | memory[address + 1]);
+
+            // Cycles are only counted when the block returns, so timer
+            // operations run in the interpreter, and so do invalid opcodes,
+            // whose exception must not unwind through generated code
+            if (UsesTimers(decoded.op) || decoded.op == Op::Invalid)
+            {
+                break;
+            }
+
+            instructions.push_back(decoded);
+            const Instruction &in = instructions.back();
+
+            if (!EmitNative(e, in, static_cast<std::uint16_t>(address), quirks))
+            {
+                if (block.length == 0)
+                {
+                    instructions.pop_back();
+                    break;
+                }
+
+                // Only the handler of the last instruction advances pc, from the address it expects
+                if (EndsBlock(in.op))
+                {
+                    e.StorePc(static_cast<std::uint16_t>(address));
+                    e.CallHandler(handlers[static_cast<std::size_t>(in.op)], &in);
+                }
+                else
+                {
+                    e.CallHandler(bodyHandlers[static_cast<std::size_t>(in.op)], &in);
+                }
+            }
+
+            ++histogram[OpcodeFamily(in.opcode)];
+            ++block.length;
+            address += 2;
+
+            if (EndsBlock(in.op))
+            {
+                terminated = true;
+                break;
+            }
+        }
+
+        // Entering and leaving a block costs more than interpreting one instruction
+        if (block.length < 2)
+        {
+            instructions.resize(firstInstruction);
+            lookup[pc] = INTERPRETED;
+            codePages[pc / PAGE_SIZE] = 1;
+            codePages[(pc + 1u) / PAGE_SIZE] = 1;
+            return nullptr;
+        }
+
+        if (!terminated)
+        {
+            e.StorePc(static_cast<std::uint16_t>(address));
+        }
+
+        e.Return(block.length);
+
+        // The pages may hold earlier blocks, which are only run after this returns
+        Protect(code + codeUsed, e.buffer.size(), true);
+        std::memcpy(code + codeUsed, e.buffer.data(), e.buffer.size());
+        Protect(code + codeUsed, e.buffer.size(), false);
+        block.function = reinterpret_cast<BlockFunction>(code + codeUsed);
+        block.end = static_cast<std::uint16_t>(address);
+        block.firstFamily = static_cast<std::uint32_t>(familyCounts.size());
+        block.familyCount = AppendFamilyCounts(histogram, familyCounts);
+        codeUsed += (e.buffer.size() + 15) & ~std::size_t(15);
+
+        const auto index = static_cast<std::int32_t>(blocks.size());
+        blocks.push_back(block);
+        lookup[pc] = index;
+
+        for (std::size_t page = block.start / PAGE_SIZE; page <= (block.end - 1) / PAGE_SIZE; ++page)
+        {
+            pageBlocks[page].push_back(index);
+            codePages[page] = 1;
+        }
+
+        return &blocks.back();
+    }
+
+    void Jit::drop(std::uint16_t address)
+    {
+        auto &page = pageBlocks[address / PAGE_SIZE];
+
+        // Drop the blocks covering the address and forget dead entries
+        std::size_t kept = 0;
+        for (const std::int32_t index : page)
+        {
+            CompiledBlock &block = blocks[index];
+            if (block.live && address >= block.start && address < block.end)
+            {
+                block.live = false;
+                lookup[block.start] = -1;
+            }
+
+            if (block.live)
+            {
+                page[kept++] = index;
+            }
+        }
+
+        page.resize(kept);
+
+        // The instruction may compile now
+        for (std::uint32_t start = address > 0 ? address - 1u : 0u; start <= address; ++start)
+        {
+            if (lookup[start] == INTERPRETED)
+            {
+                lookup[start] = -1;
+            }
+        }
+    }
+
+    void Jit::Clear()
+    {
+        std::fill(lookup.begin(), lookup.end(), -1);
+        for (auto &page : pageBlocks)
+        {
+            page.clear();
+        }
+        std::fill(codePages.begin(), codePages.end(), 0);
+        blocks.clear();
+        instructions.clear();
+        familyCounts.clear();
+        codeUsed = 0;
+    }
+}
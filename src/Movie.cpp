@@ -0,0 +1,208 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "Movie.hpp"
+
+namespace
+{
+    constexpr char MOVIE_MAGIC[4] = {'C', '8', 'M', 'V'};
+    constexpr std::uint32_t MOVIE_VERSION = 1;
+
+    struct MovieHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t seed;
+        std::uint32_t clockRate;
+        std::uint32_t reserved;
+        std::uint64_t initialHash;
+        std::uint64_t cycles;
+        std::uint64_t finalHash;
+        std::uint64_t count;
+    };
+
+    /**
+     * @brief On-disk event, padded explicitly so no uninitialised bytes are written.
+     */
+    struct EventRecord
+    {
+        std::uint64_t cycle;
+        std::uint16_t keys;
+        std::uint16_t reserved[3];
+    };
+
+    static_assert(sizeof(MovieHeader) == 56, "MovieHeader must not contain padding");
+    static_assert(sizeof(EventRecord) == 16, "EventRecord must stay 16 bytes");
+}
+
+namespace chip8
+{
+    std::uint16_t PackKeypad(const std::uint8_t *keypad)
+    {
+        std::uint16_t keys = 0;
+        for (std::size_t key = 0; key < 16; ++key)
+        {
+            keys |= static_cast<std::uint16_t>((keypad[key] != 0 ? 1u : 0u) << key);
+        }
+
+        return keys;
+    }
+
+    void UnpackKeypad(std::uint16_t keys, std::uint8_t *keypad)
+    {
+        for (std::size_t key = 0; key < 16; ++key)
+        {
+            keypad[key] = (keys >> key) & 1;
+        }
+    }
+
+    std::uint64_t HashState(const IChip &chip)
+    {
+        Snapshot snapshot;
+        chip.SaveState(snapshot);
+
+        // Which rows still need presenting depends on the frontend, not the program
+        snapshot.dirtyRows = 0;
+        snapshot.drawFlag = 0;
+        return HashSnapshot(snapshot);
+    }
+
+    void Movie::Begin(const IChip &chip, std::uint64_t chipSeed)
+    {
+        seed = chipSeed;
+        clockRate = chip.GetClockRate();
+        initialHash = HashState(chip);
+        cycles = 0;
+        finalHash = 0;
+        events.clear();
+    }
+
+    void Movie::Record(std::uint64_t cycle, const std::uint8_t *keypad)
+    {
+        const std::uint16_t keys = PackKeypad(keypad);
+        const std::uint16_t previous = events.empty() ? 0 : events.back().keys;
+
+        if (keys != previous)
+        {
+            events.push_back({cycle, keys});
+        }
+    }
+
+    void Movie::End(const IChip &chip)
+    {
+        cycles = chip.GetCycleCount();
+        finalHash = HashState(chip);
+    }
+
+    std::uint64_t ReplayMovie(IChip &chip, const Movie &movie)
+    {
+        chip.SetSeed(movie.seed);
+        chip.SetClockRate(movie.clockRate);
+
+        if (HashState(chip) != movie.initialHash)
+        {
+            throw std::runtime_error("Movie was recorded with a different ROM or setup");
+        }
+
+        std::uint64_t cycle = chip.GetCycleCount();
+        for (const InputEvent &event : movie.events)
+        {
+            chip.emulateCycles(event.cycle - cycle);
+            cycle = event.cycle;
+            UnpackKeypad(event.keys, chip.GetKeypad());
+        }
+
+        chip.emulateCycles(movie.cycles - cycle);
+        return HashState(chip);
+    }
+
+    void WriteMovie(const std::string &filename, const Movie &movie)
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Movie couldn't be created: " + filename);
+        }
+
+        MovieHeader header{};
+        std::memcpy(header.magic, MOVIE_MAGIC, sizeof(MOVIE_MAGIC));
+        header.version = MOVIE_VERSION;
+        header.seed = movie.seed;
+        header.clockRate = movie.clockRate;
+        header.initialHash = movie.initialHash;
+        header.cycles = movie.cycles;
+        header.finalHash = movie.finalHash;
+        header.count = movie.events.size();
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        for (const InputEvent &event : movie.events)
+        {
+            const EventRecord record{event.cycle, event.keys, {}};
+            file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error("Movie couldn't be written: " + filename);
+        }
+    }
+
+    Movie ReadMovie(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Movie couldn't be opened: " + filename);
+        }
+
+        MovieHeader header{};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+        if (!file || std::memcmp(header.magic, MOVIE_MAGIC, sizeof(MOVIE_MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not a movie: " + filename);
+        }
+
+        if (header.version != MOVIE_VERSION)
+        {
+            throw std::runtime_error("Unsupported movie version: " + std::to_string(header.version));
+        }
+
+        Movie movie;
+        movie.seed = header.seed;
+        movie.clockRate = header.clockRate;
+        movie.initialHash = header.initialHash;
+        movie.cycles = header.cycles;
+        movie.finalHash = header.finalHash;
+
+        std::uint64_t cycle = 0;
+        for (std::uint64_t i = 0; i < header.count; ++i)
+        {
+            EventRecord record{};
+            file.read(reinterpret_cast<char *>(&record), sizeof(record));
+
+            if (!file)
+            {
+                throw std::runtime_error("Truncated movie: " + filename);
+            }
+
+            // Replay relies on events being in order and inside the run
+            if (record.cycle < cycle || record.cycle > header.cycles)
+            {
+                throw std::runtime_error("Corrupt movie event at cycle " + std::to_string(record.cycle));
+            }
+
+            cycle = record.cycle;
+            movie.events.push_back({record.cycle, record.keys});
+        }
+
+        if (header.clockRate == 0)
+        {
+            throw std::runtime_error("Corrupt movie: no clock rate");
+        }
+
+        return movie;
+    }
+}
@@ -0,0 +1,60 @@
+#include <iomanip>
+
+#include "PerfCounters.hpp"
+
+namespace
+{
+    const char *const FAMILY_NAMES[chip8::OPCODE_FAMILIES] = {
+        "CLS/RET", "JP", "CALL", "SE Vx,NN", "SNE Vx,NN", "SE Vx,Vy", "LD Vx,NN", "ADD Vx,NN",
+        "ALU Vx,Vy", "SNE Vx,Vy", "LD I", "JP V0", "RND", "DRW", "SKP/SKNP", "FX misc"};
+}
+
+namespace chip8
+{
+    std::uint8_t AppendFamilyCounts(const std::array<std::uint8_t, OPCODE_FAMILIES> &histogram,
+                                    std::vector<FamilyCount> &pool)
+    {
+        std::uint8_t entries = 0;
+        for (std::size_t family = 0; family < OPCODE_FAMILIES; ++family)
+        {
+            if (histogram[family] != 0)
+            {
+                pool.push_back({static_cast<std::uint8_t>(family), histogram[family]});
+                ++entries;
+            }
+        }
+
+        return entries;
+    }
+
+    void PrintPerfCounters(std::ostream &out, const PerfCounters &counters)
+    {
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+
+        out << "Counters: " << counters.cycles << " cycles, " << counters.spritesDrawn << " sprites ("
+            << counters.collisions << " collisions), " << counters.drawFlagSets << " redraw requests, "
+            << counters.renders << " renders, " << counters.keyWaitCycles << " cycles waiting for keys, "
+            << counters.timerUnderflows << " timer underflows, " << counters.idleCycles << " idle cycles skipped" << '\n';
+
+        for (std::size_t family = 0; family < OPCODE_FAMILIES; ++family)
+        {
+            if (counters.families[family] == 0)
+            {
+                continue;
+            }
+
+            const double share = 100.0 * static_cast<double>(counters.families[family]) /
+                                 static_cast<double>(counters.cycles);
+
+            out << "  " << std::hex << std::uppercase << family << std::dec << "xxx " << std::left << std::setw(10)
+                << FAMILY_NAMES[family] << std::right << std::setw(14) << counters.families[family] << std::fixed
+                << std::setprecision(1) << std::setw(7) << share << " %" << '\n';
+
+            out.flags(flags);
+        }
+
+        out.precision(precision);
+        out << std::flush;
+    }
+}
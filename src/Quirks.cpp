@@ -0,0 +1,41 @@
+#include "Quirks.hpp"
+
+namespace chip8
+{
+    bool ParseProfile(const std::string &name, Profile &profile)
+    {
+        if (name == "modern")
+        {
+            profile = Profile::Modern;
+            return true;
+        }
+
+        if (name == "vip")
+        {
+            profile = Profile::CosmacVip;
+            return true;
+        }
+
+        if (name == "schip")
+        {
+            profile = Profile::SuperChip;
+            return true;
+        }
+
+        return false;
+    }
+
+    const char *ProfileName(Profile profile)
+    {
+        switch (profile)
+        {
+        case Profile::CosmacVip:
+            return "vip";
+        case Profile::SuperChip:
+            return "schip";
+        case Profile::Modern:
+        default:
+            return "modern";
+        }
+    }
+}
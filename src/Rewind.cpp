@@ -0,0 +1,243 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "Rewind.hpp"
+
+namespace
+{
+    /**
+     * @brief Equal bytes in a row that end a literal run.
+     * Shorter gaps are cheaper to keep inside the literal than to encode
+     * as a new run header.
+     */
+    constexpr std::size_t MIN_GAP = 8;
+
+    std::size_t SkipEqual(const std::uint8_t *state, const std::uint8_t *reference, std::size_t pos, std::size_t size)
+    {
+        // Most of the state matches, so compare a word at a time first
+        while (pos + sizeof(std::uint64_t) <= size)
+        {
+            std::uint64_t a;
+            std::uint64_t b;
+            std::memcpy(&a, state + pos, sizeof(a));
+            std::memcpy(&b, reference + pos, sizeof(b));
+
+            if (a != b)
+            {
+                break;
+            }
+
+            pos += sizeof(std::uint64_t);
+        }
+
+        while (pos < size && state[pos] == reference[pos])
+        {
+            ++pos;
+        }
+
+        return pos;
+    }
+
+    void PutLength(std::vector<std::uint8_t> &out, std::size_t value)
+    {
+        out.push_back(static_cast<std::uint8_t>(value));
+        out.push_back(static_cast<std::uint8_t>(value >> 8));
+    }
+
+    std::size_t GetLength(const std::uint8_t *in)
+    {
+        return static_cast<std::size_t>(in[0]) | static_cast<std::size_t>(in[1]) << 8;
+    }
+
+    /**
+     * @brief Encodes state XOR reference as runs of [skip][length][bytes].
+     * Skip and length are 16-bit little endian; trailing equal bytes are implied.
+     */
+    void EncodeXor(const std::uint8_t *state, const std::uint8_t *reference, std::size_t size,
+                   std::vector<std::uint8_t> &out)
+    {
+        static_assert(sizeof(chip8::Snapshot) <= 0xFFFF, "Run lengths are stored in 16 bits");
+
+        std::size_t pos = 0;
+        while (true)
+        {
+            const std::size_t start = pos;
+            pos = SkipEqual(state, reference, pos, size);
+            if (pos == size)
+            {
+                break;
+            }
+
+            const std::size_t literal = pos;
+            std::size_t equal = 0;
+            while (pos < size && equal < MIN_GAP)
+            {
+                equal = state[pos] == reference[pos] ? equal + 1 : 0;
+                ++pos;
+            }
+
+            pos -= equal;
+            PutLength(out, literal - start);
+            PutLength(out, pos - literal);
+
+            for (std::size_t i = literal; i < pos; ++i)
+            {
+                out.push_back(state[i] ^ reference[i]);
+            }
+        }
+    }
+
+    void ApplyXor(const std::vector<std::uint8_t> &data, std::uint8_t *state)
+    {
+        std::size_t pos = 0;
+        for (std::size_t i = 0; i < data.size();)
+        {
+            pos += GetLength(&data[i]);
+            const std::size_t length = GetLength(&data[i + 2]);
+            i += 4;
+
+            for (std::size_t end = i + length; i < end; ++i)
+            {
+                state[pos++] ^= data[i];
+            }
+        }
+    }
+
+    std::uint8_t *Bytes(chip8::Snapshot &snapshot)
+    {
+        return reinterpret_cast<std::uint8_t *>(&snapshot);
+    }
+
+    const std::uint8_t *Bytes(const chip8::Snapshot &snapshot)
+    {
+        return reinterpret_cast<const std::uint8_t *>(&snapshot);
+    }
+}
+
+namespace chip8
+{
+    RewindBuffer::RewindBuffer(std::size_t budgetBytes, std::size_t interval)
+        : budget(budgetBytes), keyframeInterval(interval)
+    {
+        if (keyframeInterval == 0)
+        {
+            throw std::invalid_argument("Keyframe interval must be positive");
+        }
+    }
+
+    void RewindBuffer::Push(const Snapshot &snapshot)
+    {
+        Frame frame{};
+
+        if (frames.empty() || sinceKeyframe >= keyframeInterval)
+        {
+            // Keyframes are encoded against zero, which still collapses unused memory
+            static const Snapshot ZERO{};
+            EncodeXor(Bytes(snapshot), Bytes(ZERO), sizeof(Snapshot), frame.data);
+            keyframe = snapshot;
+            sinceKeyframe = 0;
+            ++stats.keyframes;
+        }
+        else
+        {
+            EncodeXor(Bytes(snapshot), Bytes(keyframe), sizeof(Snapshot), frame.data);
+        }
+
+        frame.distance = static_cast<std::uint32_t>(sinceKeyframe++);
+        frame.data.shrink_to_fit();
+
+        ++stats.frames;
+        stats.encodedBytes += frame.data.size();
+        retainedBytes += frame.data.size();
+        frames.push_back(std::move(frame));
+
+        evict();
+    }
+
+    bool RewindBuffer::StepBack(std::size_t count, Snapshot &snapshot)
+    {
+        if (frames.empty())
+        {
+            return false;
+        }
+
+        if (count > frames.size() - 1)
+        {
+            count = frames.size() - 1;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            retainedBytes -= frames.back().data.size();
+            frames.pop_back();
+        }
+
+        restore(frames.size() - 1, snapshot);
+        return true;
+    }
+
+    void RewindBuffer::restore(std::size_t index, Snapshot &snapshot)
+    {
+        const Frame &frame = frames[index];
+        const Frame &key = frames[index - frame.distance];
+
+        std::memset(Bytes(snapshot), 0, sizeof(Snapshot));
+        ApplyXor(key.data, Bytes(snapshot));
+        keyframe = snapshot;
+
+        if (frame.distance != 0)
+        {
+            ApplyXor(frame.data, Bytes(snapshot));
+        }
+
+        sinceKeyframe = frame.distance + 1;
+    }
+
+    void RewindBuffer::evict()
+    {
+        while (retainedBytes > budget)
+        {
+            // Deltas are useless without their keyframe, so whole groups go at once
+            std::size_t group = 1;
+            while (group < frames.size() && frames[group].distance != 0)
+            {
+                ++group;
+            }
+
+            if (group == frames.size())
+            {
+                break;
+            }
+
+            for (std::size_t i = 0; i < group; ++i)
+            {
+                retainedBytes -= frames.front().data.size();
+                frames.pop_front();
+            }
+
+            stats.evictedFrames += group;
+        }
+    }
+
+    void RewindBuffer::Clear()
+    {
+        frames.clear();
+        retainedBytes = 0;
+        sinceKeyframe = 0;
+    }
+
+    std::size_t RewindBuffer::GetFrameCount() const
+    {
+        return frames.size();
+    }
+
+    std::size_t RewindBuffer::GetRetainedBytes() const
+    {
+        return retainedBytes;
+    }
+
+    const RewindStats &RewindBuffer::GetStats() const
+    {
+        return stats;
+    }
+}
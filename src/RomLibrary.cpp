@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "RomLibrary.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    /**
+     * @brief Maps a whole file read-only.
+     * The tail of the last page of a mapping reads as zero, and every ROM
+     * fits in one page, which gives the zero padding RomImage promises.
+     * @return Address of the mapping, nullptr if the file couldn't be mapped.
+     */
+    const std::uint8_t *MapFile(const fs::path &path, std::size_t size)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+        {
+            return nullptr;
+        }
+
+        void *address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        (void)size;
+        return static_cast<const std::uint8_t *>(address);
+#else
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return nullptr;
+        }
+
+        void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+        close(file);
+        return address == MAP_FAILED ? nullptr : static_cast<const std::uint8_t *>(address);
+#endif
+    }
+
+    void UnmapFile(const std::uint8_t *address, std::size_t length)
+    {
+#if defined(_WIN32)
+        (void)length;
+        UnmapViewOfFile(address);
+#else
+        munmap(const_cast<std::uint8_t *>(address), length);
+#endif
+    }
+
+    std::size_t PageSize()
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+}
+
+namespace chip8
+{
+    std::uint64_t HashRom(const std::uint8_t *data, std::size_t size)
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ data[i]) * 0x100000001B3ull;
+        }
+
+        return hash;
+    }
+
+    RomLibrary::RomLibrary(const std::string &directory)
+    {
+        if (PageSize() < MAX_ROM_SIZE)
+        {
+            throw std::runtime_error("ROM library needs pages of at least " + std::to_string(MAX_ROM_SIZE) + " bytes");
+        }
+
+        std::vector<fs::path> files;
+        for (const fs::directory_entry &entry : fs::directory_iterator(directory))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".ch8")
+            {
+                files.push_back(entry.path());
+            }
+        }
+
+        std::sort(files.begin(), files.end());
+
+        try
+        {
+            for (const fs::path &path : files)
+            {
+                add(path);
+            }
+        }
+        catch (...)
+        {
+            for (const Mapping &mapping : mappings)
+            {
+                UnmapFile(mapping.address, mapping.length);
+            }
+
+            throw;
+        }
+    }
+
+    void RomLibrary::add(const fs::path &path)
+    {
+        const std::uintmax_t size = fs::file_size(path);
+        if (size == 0 || size > MAX_ROM_SIZE)
+        {
+            return;
+        }
+
+        const std::uint8_t *data = MapFile(path, static_cast<std::size_t>(size));
+        if (!data)
+        {
+            throw std::runtime_error("ROM couldn't be mapped: " + path.string());
+        }
+
+        const std::string name = path.filename().string();
+        const std::uint64_t hash = HashRom(data, static_cast<std::size_t>(size));
+
+        // Copies of a ROM under other names share the first mapping
+        const auto existing = byHash.find(hash);
+        if (existing != byHash.end())
+        {
+            const RomImage &image = images[existing->second];
+            const bool same = image.size == size && std::memcmp(image.data, data, image.size) == 0;
+            UnmapFile(data, static_cast<std::size_t>(size));
+
+            if (!same)
+            {
+                throw std::runtime_error("ROM hash collision: " + name + " and " + image.name);
+            }
+
+            byName.emplace(name, existing->second);
+            return;
+        }
+
+        mappings.push_back({data, static_cast<std::size_t>(size)});
+        byHash.emplace(hash, images.size());
+        byName.emplace(name, images.size());
+        images.push_back({name, hash, data, static_cast<std::size_t>(size)});
+    }
+
+    RomLibrary::~RomLibrary()
+    {
+        for (const Mapping &mapping : mappings)
+        {
+            UnmapFile(mapping.address, mapping.length);
+        }
+    }
+
+    const RomImage *RomLibrary::Find(std::uint64_t hash) const
+    {
+        const auto it = byHash.find(hash);
+        return it == byHash.end() ? nullptr : &images[it->second];
+    }
+
+    const RomImage *RomLibrary::FindByName(const std::string &name) const
+    {
+        const auto it = byName.find(name);
+        return it == byName.end() ? nullptr : &images[it->second];
+    }
+
+    const std::vector<RomImage> &RomLibrary::GetImages() const
+    {
+        return images;
+    }
+}
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+#include "Scheduler.hpp"
+
+namespace chip8
+{
+    Scheduler::Scheduler(std::uint32_t instructionsPerSecond, std::uint32_t framesPerSecond)
+        : clockRate(instructionsPerSecond), frameRate(framesPerSecond)
+    {
+        if (instructionsPerSecond == 0 || framesPerSecond == 0)
+        {
+            throw std::invalid_argument("Clock and frame rate must be positive");
+        }
+
+        framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / frameRate;
+        deadline = Clock::now() + framePeriod;
+    }
+
+    std::uint64_t Scheduler::CyclesForFrame()
+    {
+        const std::uint64_t total = static_cast<std::uint64_t>(clockRate) + cycleRemainder;
+        cycleRemainder = static_cast<std::uint32_t>(total % frameRate);
+        return total / frameRate;
+    }
+
+    void Scheduler::WaitForNextFrame()
+    {
+        Clock::time_point now = Clock::now();
+
+        if (now >= deadline)
+        {
+            ++stats.lateFrames;
+        }
+
+        // Coarse sleep until shortly before the deadline, the OS wakes up
+        // too late too often to sleep all the way
+        else
+        {
+            if (deadline - now > SPIN_THRESHOLD)
+            {
+                std::this_thread::sleep_for(deadline - now - SPIN_THRESHOLD);
+            }
+
+            do
+            {
+                now = Clock::now();
+            } while (now < deadline);
+        }
+
+        const double jitterUs = std::chrono::duration<double, std::micro>(now - deadline).count();
+        ++stats.frames;
+        stats.totalJitterUs += jitterUs;
+        stats.maxJitterUs = std::fmax(stats.maxJitterUs, jitterUs);
+
+        deadline += framePeriod;
+        if (now - deadline > framePeriod)
+        {
+            deadline = now + framePeriod;
+            ++stats.resyncs;
+        }
+    }
+
+    void Scheduler::Restart()
+    {
+        deadline = Clock::now() + framePeriod;
+    }
+
+    void Scheduler::SetClockRate(std::uint32_t instructionsPerSecond)
+    {
+        if (instructionsPerSecond == 0)
+        {
+            throw std::invalid_argument("Clock rate must be positive");
+        }
+
+        clockRate = instructionsPerSecond;
+        cycleRemainder = 0;
+    }
+
+    const PacingStats &Scheduler::GetStats() const
+    {
+        return stats;
+    }
+
+    FrameSkipper::FrameSkipper(double renderShare)
+        : renderShare(renderShare), lastPresent(Clock::now())
+    {
+        if (!(renderShare > 0.0 && renderShare <= 1.0))
+        {
+            throw std::invalid_argument("Render share must be in (0, 1]");
+        }
+    }
+
+    void FrameSkipper::Presented(std::uint64_t sequence, Clock::duration renderTime)
+    {
+        const Clock::time_point now = Clock::now();
+        const double wall = std::chrono::duration<double>(now - lastPresent).count();
+        const double render = std::chrono::duration<double>(renderTime).count();
+        const std::uint64_t frames = sequence - lastSequence;
+
+        // A single slow present, e.g. one blocked by vsync, only moves N part of the way
+        renderSeconds = renderSeconds < 0.0 ? render : 0.75 * renderSeconds + 0.25 * render;
+
+        // Presenting every Nth of f frames per second costs f / N * render seconds per second
+        if (frames != 0 && wall > 0.0)
+        {
+            const double framesPerSecond = frames / wall;
+            interval = static_cast<std::uint64_t>(std::fmax(1.0, std::ceil(framesPerSecond * renderSeconds / renderShare)));
+        }
+
+        lastSequence = sequence;
+        lastPresent = now;
+    }
+
+    void FrameSkipper::Reset(std::uint64_t sequence)
+    {
+        interval = 1;
+        lastSequence = sequence;
+        lastPresent = Clock::now();
+        renderSeconds = -1.0;
+    }
+
+    std::uint64_t FrameSkipper::GetInterval() const
+    {
+        return interval;
+    }
+}
@@ -0,0 +1,91 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "Snapshot.hpp"
+
+namespace
+{
+    constexpr char STATE_MAGIC[4] = {'C', '8', 'S', 'S'};
+
+    struct StateHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t size;
+        std::uint32_t reserved;
+    };
+}
+
+namespace chip8
+{
+    std::uint64_t HashSnapshot(const Snapshot &snapshot)
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&snapshot);
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+
+        for (std::size_t offset = 0; offset < sizeof(Snapshot); offset += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, bytes + offset, sizeof(word));
+            hash = (hash ^ word) * 0x100000001B3ull;
+            hash ^= hash >> 29;
+        }
+
+        return hash;
+    }
+
+    void WriteSnapshot(const std::string &filename, const Snapshot &snapshot)
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("State file couldn't be created: " + filename);
+        }
+
+        StateHeader header{};
+        std::memcpy(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC));
+        header.version = snapshot.version;
+        header.size = sizeof(Snapshot);
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(&snapshot), sizeof(snapshot));
+
+        if (!file)
+        {
+            throw std::runtime_error("State file couldn't be written: " + filename);
+        }
+    }
+
+    Snapshot ReadSnapshot(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("State file couldn't be opened: " + filename);
+        }
+
+        StateHeader header{};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+        if (!file || std::memcmp(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not a state file: " + filename);
+        }
+
+        if (header.version != SNAPSHOT_VERSION || header.size != sizeof(Snapshot))
+        {
+            throw std::runtime_error("Unsupported state file version: " + std::to_string(header.version));
+        }
+
+        Snapshot snapshot{};
+        file.read(reinterpret_cast<char *>(&snapshot), sizeof(snapshot));
+
+        if (!file || snapshot.version != header.version)
+        {
+            throw std::runtime_error("Truncated state file: " + filename);
+        }
+
+        return snapshot;
+    }
+}
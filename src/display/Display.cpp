@@ -1,19 +1,35 @@
+#include <algorithm>
 #include <iostream>
 #include <unordered_map>
-#include <cmath>
-#include <vector>
 
 #include "display/Display.hpp"
 
 namespace
 {
+    constexpr Uint32 PIXEL_ON = 0xFFFFFFFF;
+    constexpr Uint32 PIXEL_OFF = 0xFF000000;
+    constexpr int DEFAULT_REFRESH_RATE = 60;
+
+    constexpr int SAMPLE_RATE = 44100;
+    constexpr double TONE_FREQUENCY = 440.0;
+    constexpr float TONE_AMPLITUDE = 4000.0f;
+
+    /**
+     * @brief Gain change per sample; the tone fades in and out over 2 ms instead of clicking.
+     */
+    constexpr float FADE_STEP = 1.0f / (SAMPLE_RATE / 500);
+
     const std::unordered_map<SDL_Keycode, std::uint8_t> keyMap = {
         {SDLK_1, 0x1}, {SDLK_2, 0x2}, {SDLK_3, 0x3}, {SDLK_4, 0xC}, {SDLK_q, 0x4}, {SDLK_w, 0x5}, {SDLK_e, 0x6}, {SDLK_r, 0xD}, {SDLK_a, 0x7}, {SDLK_s, 0x8}, {SDLK_d, 0x9}, {SDLK_f, 0xE}, {SDLK_z, 0xA}, {SDLK_x, 0x0}, {SDLK_c, 0xB}, {SDLK_v, 0xF}};
+
+    const std::unordered_map<SDL_Keycode, display::Command> hotkeyMap = {
+        {SDLK_F5, display::Command::SaveState}, {SDLK_F9, display::Command::LoadState},
+        {SDLK_F3, display::Command::PrintStats}, {SDLK_TAB, display::Command::Turbo}};
 }
 
 namespace display
 {
-    Display::Display()
+    Display::Display(std::uint16_t audioSamples)
     {
         if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
         {
@@ -21,7 +37,7 @@ namespace display
         }
 
         window = SDL_CreateWindow(
-            "CHIP-8 Emulator",
+            TITLE,
             SDL_WINDOWPOS_CENTERED,
             SDL_WINDOWPOS_CENTERED,
             WIDTH * SCALE,
@@ -42,16 +58,32 @@ namespace display
             throw std::runtime_error(std::string("SDL_CreateRenderer failed: ") + SDL_GetError());
         }
 
-        const int frequency = 440;
-        const int sampleRate = 44100;
-        const int durationMs = 100;
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, WIDTH, HEIGHT);
+        if (!texture)
+        {
+            SDL_DestroyRenderer(renderer);
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            throw std::runtime_error(std::string("SDL_CreateTexture failed: ") + SDL_GetError());
+        }
+
+        // Presents are capped to the refresh rate of the display holding the window
+        SDL_DisplayMode mode{};
+        int refreshRate = DEFAULT_REFRESH_RATE;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) == 0 && mode.refresh_rate > 0)
+        {
+            refreshRate = mode.refresh_rate;
+        }
+
+        presentInterval = SDL_GetPerformanceFrequency() / refreshRate;
 
         SDL_AudioSpec desiredSpec{};
-        desiredSpec.freq = sampleRate;
-        desiredSpec.format = AUDIO_U8;
+        desiredSpec.freq = SAMPLE_RATE;
+        desiredSpec.format = AUDIO_S16SYS;
         desiredSpec.channels = 1;
-        desiredSpec.samples = 4096;
-        desiredSpec.callback = nullptr;
+        desiredSpec.samples = audioSamples;
+        desiredSpec.callback = audioCallback;
+        desiredSpec.userdata = this;
 
         audioDevice = SDL_OpenAudioDevice(nullptr, 0, &desiredSpec, &audioSpec, 0);
 
@@ -60,67 +92,108 @@ namespace display
             throw std::runtime_error(std::string("SDL_OpenAudioDevice failed: ") + SDL_GetError());
         }
 
-        else
-        {
-            int sampleCount = (sampleRate * durationMs) / 1000;
-            audioBuffer.resize(sampleCount);
-
-            for (int i = 0; i < sampleCount; ++i)
-            {
-                double time = static_cast<double>(i) / sampleRate;
-                audioBuffer[i] = static_cast<std::uint8_t>(127 * (std::sin(2.0 * M_PI * frequency * time) + 1));
-            }
-        }
+        // The device plays silence until the sound timer runs
+        SDL_PauseAudioDevice(audioDevice, 0);
     }
 
     Display::~Display()
     {
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-
         if (audioDevice != 0)
         {
             SDL_CloseAudioDevice(audioDevice);
         }
+
+        SDL_DestroyTexture(texture);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
     }
 
     void Display::Clear()
     {
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+        pixels.fill(PIXEL_OFF);
+        SDL_UpdateTexture(texture, nullptr, pixels.data(), WIDTH * sizeof(Uint32));
+        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
         SDL_RenderPresent(renderer);
+        lastPresent = SDL_GetPerformanceCounter();
     }
 
-    void Display::Render(const uint8_t *gfx)
+    bool Display::Render(const std::uint64_t *gfx, std::uint32_t dirtyRows)
     {
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+        const Uint64 now = SDL_GetPerformanceCounter();
+        if (now - lastPresent < presentInterval)
+        {
+            return false;
+        }
+
+        uploadRows(gfx, dirtyRows);
+
+        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+        SDL_RenderPresent(renderer);
+        lastPresent = now;
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        for (int y = 0; y < HEIGHT; ++y)
+        return true;
+    }
+
+    void Display::uploadRows(const std::uint64_t *gfx, std::uint32_t dirtyRows)
+    {
+        int y = 0;
+        while (y < HEIGHT)
         {
-            for (int x = 0; x < WIDTH; ++x)
+            if ((dirtyRows & (1u << y)) == 0)
+            {
+                ++y;
+                continue;
+            }
+
+            // Consecutive dirty rows are uploaded with a single update
+            const int first = y;
+            while (y < HEIGHT && (dirtyRows & (1u << y)) != 0)
             {
-                if (gfx[y * WIDTH + x])
+                const std::uint64_t row = gfx[y];
+                Uint32 *texels = &pixels[y * WIDTH];
+                for (int x = 0; x < WIDTH; ++x)
                 {
-                    SDL_Rect pixel = {x * SCALE, y * SCALE, SCALE, SCALE};
-                    SDL_RenderFillRect(renderer, &pixel);
+                    texels[x] = ((row >> (WIDTH - 1 - x)) & 1) ? PIXEL_ON : PIXEL_OFF;
                 }
+                ++y;
             }
+
+            const SDL_Rect rows = {0, first, WIDTH, y - first};
+            SDL_UpdateTexture(texture, &rows, &pixels[first * WIDTH], WIDTH * sizeof(Uint32));
         }
+    }
 
-        SDL_RenderPresent(renderer);
+    void Display::SetSoundActive(bool active)
+    {
+        soundActive.store(active, std::memory_order_relaxed);
     }
 
-    void Display::Beep()
+    void SDLCALL Display::audioCallback(void *userdata, Uint8 *stream, int length)
     {
-        if (audioDevice != 0)
+        static_cast<Display *>(userdata)->synthesize(reinterpret_cast<Sint16 *>(stream),
+                                                     length / static_cast<int>(sizeof(Sint16)));
+    }
+
+    void Display::synthesize(Sint16 *samples, int count)
+    {
+        const float target = soundActive.load(std::memory_order_relaxed) ? 1.0f : 0.0f;
+        const double phaseStep = TONE_FREQUENCY / audioSpec.freq;
+
+        for (int i = 0; i < count; ++i)
         {
-            SDL_ClearQueuedAudio(audioDevice);
+            toneGain = target > toneGain ? std::min(target, toneGain + FADE_STEP)
+                                         : std::max(target, toneGain - FADE_STEP);
 
-            SDL_QueueAudio(audioDevice, audioBuffer.data(), static_cast<Uint32>(audioBuffer.size()));
-            SDL_PauseAudioDevice(audioDevice, 0);
+            // Square wave
+            const float level = tonePhase < 0.5 ? TONE_AMPLITUDE : -TONE_AMPLITUDE;
+            samples[i] = static_cast<Sint16>(level * toneGain);
+
+            tonePhase += phaseStep;
+            if (tonePhase >= 1.0)
+            {
+                tonePhase -= 1.0;
+            }
         }
     }
 
@@ -134,6 +207,19 @@ namespace display
                 running = false;
             }
 
+            else if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && event.key.keysym.sym == SDLK_BACKSPACE)
+            {
+                rewindHeld = event.type == SDL_KEYDOWN;
+            }
+
+            else if (event.type == SDL_KEYDOWN && hotkeyMap.count(event.key.keysym.sym) != 0)
+            {
+                if (!event.key.repeat)
+                {
+                    commands.push_back(hotkeyMap.at(event.key.keysym.sym));
+                }
+            }
+
             else if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
             {
                 bool isPressed = (event.type == SDL_KEYDOWN);
@@ -146,6 +232,28 @@ namespace display
                 }
             }
         }
+
+        if (rewindHeld)
+        {
+            commands.push_back(Command::Rewind);
+        }
+    }
+
+    Command Display::PollCommand()
+    {
+        if (commands.empty())
+        {
+            return Command::None;
+        }
+
+        const Command command = commands.front();
+        commands.pop_front();
+        return command;
+    }
+
+    void Display::SetTitle(const std::string &title)
+    {
+        SDL_SetWindowTitle(window, title.c_str());
     }
 
     bool Display::IsRunning() const
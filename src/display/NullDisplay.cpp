@@ -0,0 +1,41 @@
+#include "display/NullDisplay.hpp"
+
+namespace display
+{
+    void NullDisplay::Clear()
+    {
+    }
+
+    bool NullDisplay::Render(const std::uint64_t *, std::uint32_t)
+    {
+        ++renderCount;
+        return true;
+    }
+
+    bool NullDisplay::IsRunning() const
+    {
+        return true;
+    }
+
+    void NullDisplay::HandleEvents(std::uint8_t *)
+    {
+    }
+
+    Command NullDisplay::PollCommand()
+    {
+        return Command::None;
+    }
+
+    void NullDisplay::SetSoundActive(bool)
+    {
+    }
+
+    void NullDisplay::SetTitle(const std::string &)
+    {
+    }
+
+    std::uint64_t NullDisplay::GetRenderCount() const
+    {
+        return renderCount;
+    }
+}
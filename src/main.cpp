@@ -1,40 +1,443 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <thread>
 
+#include "Capture.hpp"
 #include "Chip8.hpp"
+#include "Movie.hpp"
+#include "Rewind.hpp"
+#include "Scheduler.hpp"
+#include "TripleBuffer.hpp"
 #include "display/Display.hpp"
 
-inline static int Run(std::unique_ptr<display::IDisplay> display, std::unique_ptr<chip8::IChip> chip)
+/**
+ * @brief Frames stepped back per displayed frame while rewinding.
+ */
+constexpr std::size_t REWIND_SPEED = 2;
+
+/**
+ * @brief Sleep of the display thread when no new frame has been published.
+ */
+constexpr std::chrono::microseconds IDLE_POLL{250};
+
+/**
+ * @brief Sleep of the display thread while the machine waits for a key or the delay timer.
+ * Its frames don't change, so only input has to be picked up in time.
+ */
+constexpr std::chrono::microseconds WAIT_POLL{2000};
+
+/**
+ * @brief Time between updates of the speed shown in the window title in turbo mode.
+ */
+constexpr std::chrono::milliseconds TITLE_INTERVAL{500};
+
+/**
+ * @brief Restores a state but keeps the keys currently held by the player.
+ */
+inline static void RestoreState(chip8::IChip &chip, const chip8::Snapshot &snapshot)
 {
-    const int cycleDelayMs = 4;
+    std::array<std::uint8_t, 16> held;
+    std::copy(chip.GetKeypad(), chip.GetKeypad() + held.size(), held.begin());
+    chip.LoadState(snapshot);
+    std::copy(held.begin(), held.end(), chip.GetKeypad());
+}
+
+/**
+ * @brief Frontend state shared by the main loop and the hotkey commands.
+ */
+struct Session
+{
+    explicit Session(std::size_t rewindBudget) : rewind(rewindBudget) {}
+
+    std::string statePath;
+    chip8::RewindBuffer rewind;
 
-    while (display->IsRunning())
+    /**
+     * @brief Scratch state, reused every frame.
+     */
+    chip8::Snapshot snapshot{};
+
+    /**
+     * @brief Input movie written on exit; empty path when not recording.
+     */
+    std::string moviePath;
+    chip8::Movie movie;
+
+    /**
+     * @brief Screen recording, fed every emulated frame; null when not capturing.
+     */
+    std::unique_ptr<chip8::CaptureWriter> capture;
+    std::string capturePath;
+};
+
+/**
+ * @brief Executes a hotkey command.
+ * @return true if the machine state was replaced and the screen must be redrawn.
+ */
+inline static bool HandleCommand(display::Command command, chip8::IChip &chip, Session &session)
+{
+    // A movie only replays if the machine runs forward uninterrupted
+    if (!session.moviePath.empty() &&
+        (command == display::Command::LoadState || command == display::Command::Rewind))
     {
-        Uint32 frameStart = SDL_GetTicks();
+        // Rewind repeats every frame while held, so only the load reports it
+        if (command == display::Command::LoadState)
+        {
+            std::cerr << "Error: state loads and rewind are disabled while recording" << std::endl;
+        }
 
-        chip->emulateCycle();
+        return false;
+    }
 
-        if (chip->ShouldDraw())
+    try
+    {
+        switch (command)
         {
-            display->Render(chip->GetGfx());
-            chip->ClearDrawFlag();
+        case display::Command::SaveState:
+            chip.SaveState(session.snapshot);
+            chip8::WriteSnapshot(session.statePath, session.snapshot);
+            std::cout << "State saved: " << session.statePath << std::endl;
+            return false;
+
+        case display::Command::LoadState:
+            RestoreState(chip, chip8::ReadSnapshot(session.statePath));
+            std::cout << "State loaded: " << session.statePath << std::endl;
+            return true;
+
+        case display::Command::Rewind:
+            // One frame more than the speed undoes the frame emulated since the last step
+            if (!session.rewind.StepBack(REWIND_SPEED + 1, session.snapshot))
+            {
+                return false;
+            }
+
+            RestoreState(chip, session.snapshot);
+            return true;
+
+        case display::Command::PrintStats:
+            chip8::PrintPerfCounters(std::cout, chip.GetPerfCounters());
+            return false;
+
+        // Handled by the window thread
+        case display::Command::Turbo:
+        case display::Command::None:
+            break;
         }
+    }
+
+    // A missing or stale state file must not end the session
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+
+    return false;
+}
+
+/**
+ * @brief One emulated frame, as handed from the emulation thread to the display.
+ */
+struct Frame
+{
+    chip8::FrameBuffer gfx{};
+    std::uint32_t dirtyRows = 0;   ///< Rows changed since the previous frame.
+    std::uint64_t sequence = 0;    ///< Frame number, consecutive frames differ by one.
+    chip8::Scheduler::Clock::time_point vblank;  ///< Time the frame's cycles were completed.
+};
 
-        display->HandleEvents(chip->GetKeypad());
-        chip->UpdateTimers();
+/**
+ * @brief State shared between the display thread and the emulation thread.
+ * The machine itself is only touched by the emulation thread.
+ */
+struct Link
+{
+    chip8::TripleBuffer<Frame> frames;
 
-        if (chip->GetSoundTimer() > 0)
+    std::atomic<std::uint16_t> keys{0};          ///< PackKeypad of the held keys.
+    std::atomic<std::uint32_t> commands{0};      ///< Pending hotkey commands, bit c for Command c.
+    std::atomic<bool> running{true};
+    std::atomic<bool> waiting{false};            ///< The machine ended its last frame in a wait loop.
+    std::atomic<bool> turbo{false};              ///< Frames run back to back instead of at the frame rate.
+
+    /**
+     * @brief Error that ended the emulation thread, read after joining it.
+     */
+    std::exception_ptr error;
+};
+
+/**
+ * @brief Time from the end of an emulated frame to its present.
+ */
+struct LatencyStats
+{
+    std::uint64_t presents = 0;
+    double totalUs = 0.0;
+    double maxUs = 0.0;
+
+    double MeanUs() const
+    {
+        return presents == 0 ? 0.0 : totalUs / presents;
+    }
+};
+
+/**
+ * @brief Emulation thread: runs the machine at its clock and publishes one frame per vblank.
+ * The tone follows the sound timer through IDisplay::SetSoundActive, the
+ * only display call made from this thread.
+ */
+inline static void Emulate(chip8::IChip &chip, display::IDisplay &display, Session &session,
+                           chip8::Scheduler &scheduler, Link &link)
+{
+    try
+    {
+        bool redraw = false;
+        bool soundActive = false;
+        bool wasTurbo = false;
+        std::uint64_t sequence = 0;
+
+        while (link.running.load(std::memory_order_relaxed))
         {
-            display->Beep();
+            chip8::UnpackKeypad(link.keys.load(std::memory_order_relaxed), chip.GetKeypad());
+            session.movie.Record(chip.GetCycleCount(), chip.GetKeypad());
+
+            chip.emulateCycles(scheduler.CyclesForFrame());
+            link.waiting.store(chip.IsWaiting(), std::memory_order_relaxed);
+
+            // The tone would only chatter at turbo speed
+            const bool turbo = link.turbo.load(std::memory_order_relaxed);
+            if ((chip.GetSoundTimer() > 0 && !turbo) != soundActive)
+            {
+                soundActive = !soundActive;
+                display.SetSoundActive(soundActive);
+            }
+
+            chip.SaveState(session.snapshot);
+            session.rewind.Push(session.snapshot);
+
+            if (session.capture)
+            {
+                session.capture->Push(chip.GetGfx());
+            }
+
+            // After a state load the whole screen differs from what was last published
+            Frame &frame = link.frames.WriteBuffer();
+            std::copy(chip.GetGfx(), chip.GetGfx() + chip8::SCREEN_HEIGHT, frame.gfx.begin());
+            frame.dirtyRows = redraw ? chip8::ALL_ROWS : chip.ShouldDraw() ? chip.GetDirtyRows() : 0;
+            frame.sequence = ++sequence;
+            frame.vblank = chip8::Scheduler::Clock::now();
+            link.frames.Publish();
+
+            if (chip.ShouldDraw())
+            {
+                chip.ClearDrawFlag();
+            }
+
+            redraw = false;
+
+            const std::uint32_t commands = link.commands.exchange(0, std::memory_order_acquire);
+            for (unsigned command = 1; commands >> command != 0; ++command)
+            {
+                if (commands & (1u << command))
+                {
+                    redraw |= HandleCommand(static_cast<display::Command>(command), chip, session);
+                }
+            }
+
+            if (!turbo)
+            {
+                if (wasTurbo)
+                {
+                    scheduler.Restart();
+                }
+
+                scheduler.WaitForNextFrame();
+            }
+
+            wasTurbo = turbo;
         }
+    }
 
-        Uint32 frameTime = SDL_GetTicks() - frameStart;
+    catch (...)
+    {
+        link.error = std::current_exception();
+        link.running.store(false);
+    }
+}
+
+/**
+ * @brief Shows the emulation speed relative to real time in the window title.
+ * @param framesPerSecond Emulated frames per wall-clock second.
+ * @param interval Distance between presented frames.
+ */
+inline static void ShowTurboSpeed(display::IDisplay &display, double framesPerSecond, std::uint64_t interval)
+{
+    std::ostringstream title;
+    title << display::Display::TITLE << " - turbo " << std::fixed << std::setprecision(1)
+          << framesPerSecond / chip8::Scheduler::DEFAULT_FRAME_RATE << "x, 1 of " << interval << " frames shown";
+    display.SetTitle(title.str());
+}
+
+/**
+ * @brief Runs the machine on its own thread and presents its frames on this one.
+ * This thread only polls events and renders, so a present blocking
+ * on vsync never holds back the CPU and CPU bursts never delay input.
+ * In turbo mode the machine runs unpaced and only every Nth frame is
+ * presented, see FrameSkipper.
+ */
+inline static int Run(std::unique_ptr<display::IDisplay> display, std::unique_ptr<chip8::IChip> chip,
+                      Session &session, bool turbo)
+{
+    chip8::Scheduler scheduler(chip->GetClockRate());
+    Link link;
+    LatencyStats latency;
+    chip8::FrameSkipper skipper;
+    link.turbo.store(turbo);
 
-        if (frameTime < cycleDelayMs)
+    std::thread emulation(Emulate, std::ref(*chip), std::ref(*display), std::ref(session), std::ref(scheduler),
+                          std::ref(link));
+
+    std::array<std::uint8_t, 16> keypad{};
+    std::uint64_t lastSequence = 0;
+    std::uint32_t pendingRows = 0;
+
+    // Speed shown in the title, measured over TITLE_INTERVAL
+    std::uint64_t titleSequence = 0;
+    chip8::Scheduler::Clock::time_point titleTime = chip8::Scheduler::Clock::now();
+
+    while (display->IsRunning() && link.running.load(std::memory_order_relaxed))
+    {
+        display->HandleEvents(keypad.data());
+        link.keys.store(chip8::PackKeypad(keypad.data()), std::memory_order_relaxed);
+
+        for (display::Command command = display->PollCommand(); command != display::Command::None;
+             command = display->PollCommand())
+        {
+            // Turbo concerns both threads, the machine doesn't see it
+            if (command == display::Command::Turbo)
+            {
+                turbo = !turbo;
+                link.turbo.store(turbo, std::memory_order_relaxed);
+                skipper.Reset(lastSequence);
+                titleSequence = lastSequence;
+                titleTime = chip8::Scheduler::Clock::now();
+                display->SetTitle(display::Display::TITLE);
+                continue;
+            }
+
+            link.commands.fetch_or(1u << static_cast<unsigned>(command), std::memory_order_release);
+        }
+
+        if (turbo && chip8::Scheduler::Clock::now() - titleTime >= TITLE_INTERVAL)
+        {
+            const chip8::Scheduler::Clock::time_point now = chip8::Scheduler::Clock::now();
+            const double seconds = std::chrono::duration<double>(now - titleTime).count();
+            ShowTurboSpeed(*display, (lastSequence - titleSequence) / seconds, skipper.GetInterval());
+            titleSequence = lastSequence;
+            titleTime = now;
+        }
+
+        if (!link.frames.Update())
         {
-            SDL_Delay(cycleDelayMs - frameTime);
+            // Nothing new to show, give the core a moment before polling again
+            if (pendingRows == 0)
+            {
+                std::this_thread::sleep_for(link.waiting.load(std::memory_order_relaxed) ? WAIT_POLL : IDLE_POLL);
+                continue;
+            }
         }
+        else
+        {
+            const Frame &frame = link.frames.ReadBuffer();
+
+            // Rows of frames replaced before they were taken are unknown
+            pendingRows |= frame.sequence == lastSequence + 1 ? frame.dirtyRows : chip8::ALL_ROWS;
+            lastSequence = frame.sequence;
+        }
+
+        const Frame &frame = link.frames.ReadBuffer();
+
+        // Unpaced frames arrive far faster than they can be shown
+        if (turbo && !skipper.IsDue(frame.sequence))
+        {
+            std::this_thread::sleep_for(IDLE_POLL);
+            continue;
+        }
+
+        if (pendingRows == 0)
+        {
+            continue;
+        }
+
+        const chip8::Scheduler::Clock::time_point renderStart = chip8::Scheduler::Clock::now();
+        if (!display->Render(frame.gfx.data(), pendingRows))
+        {
+            // Presents are throttled to the refresh rate, the rows stay pending until then
+            std::this_thread::sleep_for(IDLE_POLL);
+            continue;
+        }
+
+        const chip8::Scheduler::Clock::time_point presented = chip8::Scheduler::Clock::now();
+        const double us = std::chrono::duration<double, std::micro>(presented - frame.vblank).count();
+        ++latency.presents;
+        latency.totalUs += us;
+        latency.maxUs = std::max(latency.maxUs, us);
+        pendingRows = 0;
+
+        if (turbo)
+        {
+            skipper.Presented(frame.sequence, presented - renderStart);
+        }
+    }
+
+    link.running.store(false);
+    emulation.join();
+
+    if (link.error)
+    {
+        std::rethrow_exception(link.error);
+    }
+
+    std::cout << "Latency: " << latency.presents << " presents, vblank to present mean " << latency.MeanUs()
+              << " us, max " << latency.maxUs << " us" << std::endl;
+
+    const chip8::PacingStats &stats = scheduler.GetStats();
+    std::cout << "Pacing: " << stats.frames << " frames, jitter mean " << stats.MeanJitterUs()
+              << " us, max " << stats.maxJitterUs << " us, " << stats.lateFrames << " late, "
+              << stats.resyncs << " resyncs" << std::endl;
+
+    chip8::PrintPerfCounters(std::cout, chip->GetPerfCounters());
+
+    const chip8::RewindBuffer &rewind = session.rewind;
+    const chip8::RewindStats &rewindStats = rewind.GetStats();
+    std::cout << "Rewind: " << rewind.GetFrameCount() << " frames kept in " << rewind.GetRetainedBytes() / 1024
+              << " KB, " << rewindStats.BytesPerFrame() * chip8::Scheduler::DEFAULT_FRAME_RATE
+              << " bytes/s recorded (" << rewindStats.BytesPerFrame() << " per frame vs " << sizeof(chip8::Snapshot)
+              << " raw)" << std::endl;
+
+    if (session.capture)
+    {
+        session.capture->Close();
+        const chip8::CaptureStats captureStats = session.capture->GetStats();
+        std::cout << "Capture written: " << session.capturePath << " (" << captureStats.frames << " frames, "
+                  << captureStats.BytesPerFrame() << " bytes per frame, " << captureStats.droppedFrames
+                  << " dropped)" << std::endl;
+    }
+
+    if (!session.moviePath.empty())
+    {
+        session.movie.End(*chip);
+        chip8::WriteMovie(session.moviePath, session.movie);
+        std::cout << "Movie written: " << session.moviePath << " (" << session.movie.cycles << " cycles, "
+                  << session.movie.events.size() << " input events)" << std::endl;
     }
 
     return 0;
@@ -42,14 +445,76 @@ inline static int Run(std::unique_ptr<display::IDisplay> display, std::unique_pt
 
 int main(int argc, char *argv[])
 {
+#if CHIP8_TRACE
+    trace::TraceBuffer traceBuffer;
+#endif
+
+    int result = 1;
+
     try
     {
         if (argc < 2)
         {
-            std::cerr << "Usage: " << argv[0] << " <ROM_file>" << std::endl;
+            std::cerr << "Usage: " << argv[0] << " <ROM_file> [--engine interpreter|blocks|jit|aot] [--profile modern|vip|schip] [--ips N] [--rewind-mb N]"
+                      << " [--seed N] [--record MOVIE] [--capture FILE] [--audio-samples N] [--turbo]" << std::endl;
             return 1;
         }
 
+        chip8::Engine engine = chip8::Engine::Interpreter;
+        chip8::Profile profile = chip8::Profile::Modern;
+        std::uint32_t clockRate = chip8::Chip8::DEFAULT_CLOCK_RATE;
+        std::size_t rewindMegabytes = 16;
+        std::uint64_t seed = chip8::DEFAULT_SEED;
+        std::string moviePath;
+        std::string capturePath;
+        std::uint16_t audioSamples = display::Display::DEFAULT_AUDIO_SAMPLES;
+        bool turbo = false;
+        for (int i = 2; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--engine" && i + 1 < argc && chip8::ParseEngine(argv[i + 1], engine))
+            {
+                ++i;
+            }
+            else if (arg == "--profile" && i + 1 < argc && chip8::ParseProfile(argv[i + 1], profile))
+            {
+                ++i;
+            }
+            else if (arg == "--ips" && i + 1 < argc)
+            {
+                clockRate = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--rewind-mb" && i + 1 < argc)
+            {
+                rewindMegabytes = static_cast<std::size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--seed" && i + 1 < argc)
+            {
+                seed = std::stoull(argv[++i], nullptr, 0);
+            }
+            else if (arg == "--record" && i + 1 < argc)
+            {
+                moviePath = argv[++i];
+            }
+            else if (arg == "--capture" && i + 1 < argc)
+            {
+                capturePath = argv[++i];
+            }
+            else if (arg == "--audio-samples" && i + 1 < argc)
+            {
+                audioSamples = static_cast<std::uint16_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--turbo")
+            {
+                turbo = true;
+            }
+            else
+            {
+                std::cerr << "Error: Unknown option: " << arg << std::endl;
+                return 1;
+            }
+        }
+
         std::string romPath = argv[1];
         if (!std::filesystem::exists(romPath))
         {
@@ -57,17 +522,49 @@ int main(int argc, char *argv[])
             return 1;
         }
 
-        auto display = std::make_unique<display::Display>();
-        auto chip = std::make_unique<chip8::Chip8>();
+        auto display = std::make_unique<display::Display>(audioSamples);
+        auto chip = std::make_unique<chip8::Chip8>(profile);
 
         chip->loadROM(romPath);
+        chip->SetEngine(engine);
+        chip->SetClockRate(clockRate);
+        chip->SetSeed(seed);
+
+        Session session(rewindMegabytes << 20);
+        session.statePath = romPath + ".state";
+        session.moviePath = moviePath;
+        session.movie.Begin(*chip, seed);
+
+        if (!capturePath.empty())
+        {
+            session.capture = std::make_unique<chip8::CaptureWriter>(capturePath);
+            session.capturePath = capturePath;
+        }
+
+#if CHIP8_TRACE
+        chip->AttachTrace(&traceBuffer);
+#endif
 
-        return Run(std::move(display), std::move(chip));
+        result = Run(std::move(display), std::move(chip), session, turbo);
     }
 
     catch (const std::exception &e)
     {
         std::cerr << "Fatal error: " << e.what() << std::endl;
-        return 1;
     }
+
+#if CHIP8_TRACE
+    try
+    {
+        trace::WriteDump("chip8.trace", traceBuffer.Snapshot());
+        std::cout << "Trace written: chip8.trace (" << traceBuffer.Total() << " instructions)" << std::endl;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Trace dump failed: " << e.what() << std::endl;
+    }
+#endif
+
+    return result;
 }
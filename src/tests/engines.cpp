@@ -0,0 +1,308 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Chip8.hpp"
+#include "Fuzz.hpp"
+#include "Jit.hpp"
+#include "Random.hpp"
+#include "Snapshot.hpp"
+
+// Runs random and hand-written ROMs on every engine and checks that each
+// ends in the interpreter's state, or fails with the interpreter's error
+namespace
+{
+    constexpr std::size_t RANDOM_ROMS = 500;
+    constexpr std::size_t RANDOM_ROM_WORDS = 32;
+
+    // Uneven slices cut blocks at every kind of boundary
+    constexpr std::uint64_t SLICES[] = {1, 7, 100, 3, 1000};
+    constexpr int SLICE_ROUNDS = 8;
+
+    /**
+     * @brief Assembles a ROM one opcode at a time.
+     */
+    class RomBuilder
+    {
+    public:
+        void Emit(std::uint16_t opcode)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(opcode >> 8));
+            bytes.push_back(static_cast<std::uint8_t>(opcode));
+        }
+
+        std::vector<std::uint8_t> bytes;
+    };
+
+    /**
+     * @brief Final state of one run, or the error that ended it.
+     */
+    struct Outcome
+    {
+        std::uint64_t hash = 0;
+        std::string error;
+
+        bool operator==(const Outcome &other) const
+        {
+            return hash == other.hash && error == other.error;
+        }
+    };
+
+    std::uint64_t TotalCycles()
+    {
+        std::uint64_t total = 0;
+        for (std::uint64_t slice : SLICES)
+        {
+            total += slice;
+        }
+        return total * SLICE_ROUNDS;
+    }
+
+    Outcome Run(const std::vector<std::uint8_t> &rom, chip8::Profile profile, chip8::Engine engine)
+    {
+        chip8::Chip8 chip(profile);
+        chip.loadROM(rom.data(), rom.size());
+        chip.SetEngine(engine);
+
+        Outcome outcome;
+        try
+        {
+            for (int round = 0; round < SLICE_ROUNDS; ++round)
+            {
+                for (std::uint64_t slice : SLICES)
+                {
+                    chip.emulateCycles(slice);
+                }
+            }
+        }
+        catch (const std::runtime_error &e)
+        {
+            outcome.error = e.what();
+        }
+
+        chip8::Snapshot snapshot;
+        chip.SaveState(snapshot);
+        outcome.hash = chip8::HashSnapshot(snapshot);
+        return outcome;
+    }
+
+    /**
+     * @brief Mostly valid opcodes, with jumps, calls and I often aimed at the ROM itself.
+     */
+    std::vector<std::uint8_t> RandomRom(chip8::RandomState &rng)
+    {
+        static const std::uint8_t ALU[] = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE};
+        static const std::uint8_t MISC[] = {0x07, 0x15, 0x18, 0x1E, 0x1E, 0x29, 0x33, 0x55, 0x65};
+
+        RomBuilder rom;
+        for (std::size_t i = 0; i < RANDOM_ROM_WORDS; ++i)
+        {
+            const std::uint32_t bits = chip8::NextRandom(rng);
+            const std::uint16_t x = bits >> 8 & 0xF;
+            const std::uint16_t y = bits >> 12 & 0xF;
+            const std::uint16_t nn = bits >> 16 & 0xFF;
+            const std::uint16_t target = static_cast<std::uint16_t>(0x200 + 2 * ((bits >> 16) % RANDOM_ROM_WORDS));
+
+            switch (bits & 0xF)
+            {
+            // Returns and calls are rarer, most of them would under- or overflow the stack
+            case 0x0:
+                rom.Emit((nn & 7) == 0 ? 0x00EE : 0x00E0);
+                break;
+            case 0x2:
+                rom.Emit(static_cast<std::uint16_t>((nn & 3) == 0 ? 0x2000 | target : 0x6000 | x << 8 | nn));
+                break;
+            case 0x1:
+            case 0xB:
+                rom.Emit(static_cast<std::uint16_t>((bits & 0xF) << 12 | target));
+                break;
+            case 0x3:
+            case 0x4:
+                // Small immediates, so both outcomes of the skip occur
+                rom.Emit(static_cast<std::uint16_t>((bits & 0xF) << 12 | x << 8 | (nn & 7)));
+                break;
+            case 0x5:
+            case 0x9:
+                rom.Emit(static_cast<std::uint16_t>((bits & 0xF) << 12 | x << 8 | y << 4));
+                break;
+            case 0x8:
+                rom.Emit(static_cast<std::uint16_t>(0x8000 | x << 8 | y << 4 | ALU[nn % sizeof(ALU)]));
+                break;
+            case 0xA:
+                // Half of the stores land in the ROM and rewrite code
+                rom.Emit(static_cast<std::uint16_t>(0xA000 | (nn & 1 ? target : (bits >> 20 & 0xFFF))));
+                break;
+            case 0xD:
+                rom.Emit(static_cast<std::uint16_t>(0xD000 | x << 8 | y << 4 | (nn & 0xF)));
+                break;
+            case 0xE:
+                rom.Emit(static_cast<std::uint16_t>(0xE000 | x << 8 | (nn & 1 ? 0x9E : 0xA1)));
+                break;
+            case 0xF:
+                rom.Emit(static_cast<std::uint16_t>(0xF000 | x << 8 | MISC[nn % sizeof(MISC)]));
+                break;
+            default:
+                rom.Emit(static_cast<std::uint16_t>((bits & 0xF) << 12 | x << 8 | nn));
+                break;
+            }
+        }
+
+        return rom.bytes;
+    }
+
+    /**
+     * @brief Loop that patches the immediate of an ADD inside its own block.
+     */
+    std::vector<std::uint8_t> SelfModifyingRom()
+    {
+        RomBuilder rom;
+        rom.Emit(0x6001); // 200: LD V0, 1
+        rom.Emit(0x6100); // 202: LD V1, 0
+        rom.Emit(0xA211); // 204: LD I, 0x211 (immediate of 210)
+        rom.Emit(0x7003); // 206: ADD V0, 3
+        rom.Emit(0xF055); // 208: LD [I], V0
+        rom.Emit(0x8314); // 20A: ADD V3, V1
+        rom.Emit(0x7101); // 20C: ADD V1, 1
+        rom.Emit(0x8E34); // 20E: ADD VE, V3
+        rom.Emit(0x7200); // 210: ADD V2, patched
+        rom.Emit(0x3100); // 212: SE V1, 0
+        rom.Emit(0x1204); // 214: JP 204
+        rom.Emit(0x1216); // 216: JP 216
+        return rom.bytes;
+    }
+
+    /**
+     * @brief Nested calls with work on both sides of each return.
+     */
+    std::vector<std::uint8_t> CallsRom()
+    {
+        RomBuilder rom;
+        rom.Emit(0x2210); // 200: CALL 210
+        rom.Emit(0x7101); // 202: ADD V1, 1
+        rom.Emit(0x3100); // 204: SE V1, 0
+        rom.Emit(0x1200); // 206: JP 200
+        rom.Emit(0x1208); // 208: JP 208
+        rom.Emit(0x0000); // 20A
+        rom.Emit(0x0000); // 20C
+        rom.Emit(0x0000); // 20E
+        rom.Emit(0x8204); // 210: ADD V2, V0
+        rom.Emit(0x2218); // 212: CALL 218
+        rom.Emit(0x7203); // 214: ADD V2, 3
+        rom.Emit(0x00EE); // 216: RET
+        rom.Emit(0x8026); // 218: SHR V0, V2
+        rom.Emit(0x7005); // 21A: ADD V0, 5
+        rom.Emit(0x00EE); // 21C: RET
+        return rom.bytes;
+    }
+
+    std::string ToHexString(const std::vector<std::uint8_t> &rom)
+    {
+        std::ostringstream hex;
+        hex << std::hex << std::uppercase << std::setfill('0');
+        for (std::uint8_t byte : rom)
+        {
+            hex << std::setw(2) << +byte;
+        }
+        return hex.str();
+    }
+
+    /**
+     * @brief Compares every engine with the interpreter on one ROM.
+     * @return Number of engines that disagree.
+     */
+    int Check(const std::vector<std::uint8_t> &rom, chip8::Profile profile, const std::vector<chip8::Engine> &engines)
+    {
+        const Outcome reference = Run(rom, profile, chip8::Engine::Interpreter);
+
+        int mismatches = 0;
+        for (chip8::Engine engine : engines)
+        {
+            const Outcome outcome = Run(rom, profile, engine);
+            if (outcome == reference)
+            {
+                continue;
+            }
+
+            ++mismatches;
+            std::cerr << "Mismatch: " << chip8::EngineName(engine) << " differs from the interpreter with profile "
+                      << chip8::ProfileName(profile) << " on ROM " << ToHexString(rom) << std::endl;
+            if (outcome.error != reference.error)
+            {
+                std::cerr << "  error: \"" << outcome.error << "\" instead of \"" << reference.error << "\"" << std::endl;
+            }
+        }
+
+        return mismatches;
+    }
+}
+
+int main()
+{
+    try
+    {
+        std::vector<chip8::Engine> engines = {chip8::Engine::BlockCache};
+        if (chip8::Jit::IsSupported())
+        {
+            engines.push_back(chip8::Engine::Jit);
+        }
+
+        int mismatches = 0;
+        std::size_t compared = 0;
+        std::size_t skipped = 0;
+
+        for (std::size_t index = 0; index < chip8::PROFILE_COUNT; ++index)
+        {
+            const auto profile = static_cast<chip8::Profile>(index);
+
+            mismatches += Check(SelfModifyingRom(), profile, engines);
+            mismatches += Check(CallsRom(), profile, engines);
+            compared += 2;
+
+            // Stack overflows and out-of-range keys corrupt the machine in
+            // engine-specific ways, the harness finds the ROMs that reach them
+            chip8::FuzzHarness harness(profile, TotalCycles());
+            chip8::RandomState rng = chip8::SeedRandom(chip8::DEFAULT_SEED + index);
+
+            for (std::size_t i = 0; i < RANDOM_ROMS; ++i)
+            {
+                std::vector<std::uint8_t> rom = RandomRom(rng);
+
+                // An empty input script in front of the ROM
+                std::vector<std::uint8_t> input(1, 0);
+                input.insert(input.end(), rom.begin(), rom.end());
+                const chip8::FuzzResult screened = harness.Run(input.data(), input.size());
+
+                if (screened.finding != chip8::Finding::None)
+                {
+                    ++skipped;
+                    continue;
+                }
+
+                mismatches += Check(rom, profile, engines);
+                ++compared;
+            }
+        }
+
+        std::cout << "ROMs: " << compared << " compared on " << engines.size() + 1 << " engines, " << skipped
+                  << " skipped for undefined behaviour" << std::endl;
+
+        // A generator that mostly produces undefined behaviour would pass without testing anything
+        if (compared < skipped)
+        {
+            std::cerr << "Too few ROMs without undefined behaviour" << std::endl;
+            return 1;
+        }
+
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Timing results shared by the benchmark tools.
+ */
+namespace bench
+{
+    /**
+     * @struct Measurement
+     * @brief Repeated timings of one benchmark.
+     */
+    struct Measurement
+    {
+        std::string name;             ///< Workload, e.g. "alu".
+        std::string variant;          ///< How it was run, e.g. the engine.
+        std::string unit;             ///< What one operation is, e.g. "instruction".
+        std::uint64_t operations = 0; ///< Operations per run.
+        std::vector<double> seconds;  ///< Duration of every run.
+    };
+
+    /**
+     * @struct Summary
+     * @brief Statistics of the time per operation over the runs.
+     */
+    struct Summary
+    {
+        double meanNs = 0.0;
+        double stddevNs = 0.0;
+        double minNs = 0.0;
+        double maxNs = 0.0;
+        double perSecond = 0.0; ///< Operations per second at the mean.
+    };
+
+    inline Summary Summarize(const Measurement &measurement)
+    {
+        Summary summary;
+        if (measurement.seconds.empty() || measurement.operations == 0)
+        {
+            return summary;
+        }
+
+        std::vector<double> ns;
+        for (double seconds : measurement.seconds)
+        {
+            ns.push_back(seconds * 1e9 / static_cast<double>(measurement.operations));
+        }
+
+        for (double value : ns)
+        {
+            summary.meanNs += value;
+        }
+        summary.meanNs /= static_cast<double>(ns.size());
+
+        for (double value : ns)
+        {
+            summary.stddevNs += (value - summary.meanNs) * (value - summary.meanNs);
+        }
+        summary.stddevNs = std::sqrt(summary.stddevNs / static_cast<double>(ns.size()));
+
+        summary.minNs = *std::min_element(ns.begin(), ns.end());
+        summary.maxNs = *std::max_element(ns.begin(), ns.end());
+        summary.perSecond = summary.meanNs > 0.0 ? 1e9 / summary.meanNs : 0.0;
+        return summary;
+    }
+
+    /**
+     * @brief Prints one line per measurement.
+     */
+    inline void PrintTable(const std::vector<Measurement> &measurements)
+    {
+        std::cout << std::left << std::setw(10) << "Benchmark" << std::setw(13) << "Variant" << std::right
+                  << std::setw(12) << "ns/op" << std::setw(10) << "stddev" << std::setw(12) << "min"
+                  << std::setw(14) << "ops/s" << "  unit" << '\n';
+
+        for (const Measurement &measurement : measurements)
+        {
+            const Summary summary = Summarize(measurement);
+            std::cout << std::left << std::setw(10) << measurement.name << std::setw(13) << measurement.variant
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(12) << summary.meanNs
+                      << std::setw(10) << summary.stddevNs << std::setw(12) << summary.minNs
+                      << std::setprecision(0) << std::setw(14) << summary.perSecond << "  " << measurement.unit
+                      << '\n';
+        }
+
+        std::cout << std::defaultfloat << std::setprecision(6) << std::flush;
+    }
+
+    /**
+     * @brief Writes the measurements as JSON, one object per measurement.
+     * Names are generated by the tools, so no string escaping is needed.
+     * @param filename Path of the file, overwritten if it exists.
+     * @param tool Name of the producing tool.
+     * @param measurements Results to write.
+     */
+    inline void WriteJson(const std::string &filename, const std::string &tool,
+                          const std::vector<Measurement> &measurements)
+    {
+        std::ofstream file(filename);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Report couldn't be created: " + filename);
+        }
+
+        file << std::setprecision(6) << "{\n  \"tool\": \"" << tool << "\",\n  \"results\": [";
+
+        for (std::size_t i = 0; i < measurements.size(); ++i)
+        {
+            const Measurement &measurement = measurements[i];
+            const Summary summary = Summarize(measurement);
+
+            file << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << measurement.name << "\", \"variant\": \""
+                 << measurement.variant << "\", \"unit\": \"" << measurement.unit
+                 << "\", \"operations\": " << measurement.operations << ", \"runs\": " << measurement.seconds.size()
+                 << ", \"mean_ns\": " << summary.meanNs << ", \"stddev_ns\": " << summary.stddevNs
+                 << ", \"min_ns\": " << summary.minNs << ", \"max_ns\": " << summary.maxNs
+                 << ", \"per_second\": " << summary.perSecond << "}";
+        }
+
+        file << "\n  ]\n}\n";
+
+        if (!file)
+        {
+            throw std::runtime_error("Report couldn't be written: " + filename);
+        }
+    }
+}
@@ -0,0 +1,506 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BlockCache.hpp"
+#include "Decoder.hpp"
+#include "Disassembler.hpp"
+#include "PerfCounters.hpp"
+#include "Quirks.hpp"
+#include "RomLibrary.hpp"
+
+namespace
+{
+    using chip8::Instruction;
+    using chip8::Op;
+
+    constexpr std::uint16_t ROM_START = 0x200;
+
+    /**
+     * @brief Address of the font sprites, see Chip8::FONTSET_START_ADDRESS.
+     */
+    constexpr std::uint16_t FONTSET_START_ADDRESS = 0x050;
+
+    /**
+     * @struct DecodedBlock
+     * @brief Basic block found by the static disassembly.
+     */
+    struct DecodedBlock
+    {
+        std::uint16_t start = 0;
+        std::vector<Instruction> instructions;
+
+        std::uint16_t End() const
+        {
+            return static_cast<std::uint16_t>(start + 2 * instructions.size());
+        }
+    };
+
+    std::string Hex(unsigned value, int digits)
+    {
+        char text[16];
+        std::snprintf(text, sizeof(text), "0x%0*X", digits, value);
+        return text;
+    }
+
+    std::string Label(std::uint16_t address)
+    {
+        char text[16];
+        std::snprintf(text, sizeof(text), "%04X", address);
+        return text;
+    }
+
+    std::string Reg(std::uint8_t index)
+    {
+        return "V[" + Hex(index, 1) + "]";
+    }
+
+    /**
+     * @brief Decodes the block starting at an address, ending where BlockCache ends its blocks.
+     * Instructions reaching past the ROM are left to the interpreter.
+     */
+    DecodedBlock DecodeBlock(const std::vector<std::uint8_t> &rom, std::uint16_t start)
+    {
+        DecodedBlock block;
+        block.start = start;
+
+        std::uint32_t offset = start - ROM_START;
+        while (block.instructions.size() < chip8::BlockCache::MAX_BLOCK_LENGTH && offset + 1 < rom.size())
+        {
+            const Instruction instruction = chip8::Decode(rom[offset] << 8 | rom[offset + 1]);
+            block.instructions.push_back(instruction);
+            offset += 2;
+
+            if (chip8::EndsBlock(instruction.op))
+            {
+                break;
+            }
+        }
+
+        return block;
+    }
+
+    /**
+     * @brief Adds the statically known successors of a block to the work list.
+     * RET and BNNN targets are only known at run time; they are found
+     * through the block table when they land on a compiled block.
+     */
+    void AddSuccessors(const DecodedBlock &block, std::vector<std::uint16_t> &work)
+    {
+        const Instruction &last = block.instructions.back();
+        const std::uint16_t address = static_cast<std::uint16_t>(block.End() - 2);
+
+        switch (last.op)
+        {
+        case Op::JP:
+            work.push_back(last.nnn);
+            break;
+        case Op::CALL:
+            work.push_back(last.nnn);
+            work.push_back(address + 2);
+            break;
+        case Op::SE_VX_NN:
+        case Op::SNE_VX_NN:
+        case Op::SE_VX_VY:
+        case Op::SNE_VX_VY:
+        case Op::SKP_VX:
+        case Op::SKNP_VX:
+            work.push_back(address + 2);
+            work.push_back(address + 4);
+            break;
+        case Op::LD_VX_K:
+            work.push_back(address);
+            work.push_back(address + 2);
+            break;
+        case Op::RET:
+        case Op::JP_V0_NNN:
+        case Op::Invalid:
+            break;
+        default:
+            work.push_back(address + 2);
+            break;
+        }
+    }
+
+    /**
+     * @brief Finds every block reachable from 0x200 through direct control flow.
+     */
+    std::map<std::uint16_t, DecodedBlock> DiscoverBlocks(const std::vector<std::uint8_t> &rom)
+    {
+        std::map<std::uint16_t, DecodedBlock> blocks;
+        std::vector<std::uint16_t> work{ROM_START};
+
+        while (!work.empty())
+        {
+            const std::uint16_t start = work.back();
+            work.pop_back();
+
+            if (start < ROM_START || start + 1u >= ROM_START + rom.size() || blocks.count(start) != 0)
+            {
+                continue;
+            }
+
+            DecodedBlock block = DecodeBlock(rom, start);
+            AddSuccessors(block, work);
+            blocks.emplace(start, std::move(block));
+        }
+
+        return blocks;
+    }
+
+    /**
+     * @brief Returns the C++ statements of a straight-line instruction, empty if it isn't inlined.
+     * The statements mirror the handlers of Chip8::Ops for the profile's quirks.
+     */
+    std::string NativeBody(const Instruction &in, const chip8::Quirks &quirks)
+    {
+        const std::string vx = Reg(in.x);
+        const std::string vy = Reg(in.y);
+        const std::string vf = Reg(0xF);
+        const std::string reset = quirks.vfReset ? " " + vf + " = 0;" : "";
+
+        switch (in.op)
+        {
+        case Op::NOP:
+            return ";";
+        case Op::LD_VX_NN:
+            return vx + " = " + Hex(in.nn, 2) + ";";
+        case Op::ADD_VX_NN:
+            return vx + " += " + Hex(in.nn, 2) + ";";
+        case Op::LD_VX_VY:
+            return vx + " = " + vy + ";";
+        case Op::OR_VX_VY:
+            return vx + " |= " + vy + ";" + reset;
+        case Op::AND_VX_VY:
+            return vx + " &= " + vy + ";" + reset;
+        case Op::XOR_VX_VY:
+            return vx + " ^= " + vy + ";" + reset;
+        case Op::ADD_VX_VY:
+            return "{ const unsigned sum = " + vx + " + " + vy + "; " + vf + " = sum > 0xFF ? 1 : 0; " + vx + " = sum & 0xFF; }";
+        case Op::SUB_VX_VY:
+            return vf + " = " + vx + " > " + vy + " ? 1 : 0; " + vx + " -= " + vy + ";";
+        case Op::SUBN_VX_VY:
+            return vf + " = " + vy + " > " + vx + " ? 1 : 0; " + vy + " -= " + vx + ";";
+        case Op::SHR_VX:
+            if (quirks.shiftVy)
+            {
+                return "{ const std::uint8_t value = " + vy + "; " + vx + " = value >> 1; " + vf + " = value & 0x1; }";
+            }
+            return vf + " = " + vx + " & 0x1; " + vx + " >>= 1;";
+        case Op::SHL_VX:
+            if (quirks.shiftVy)
+            {
+                return "{ const std::uint8_t value = " + vy + "; " + vx + " = value << 1; " + vf + " = value >> 7; }";
+            }
+            return vf + " = (" + vx + " & 0x80) >> 7; " + vx + " <<= 1;";
+        case Op::LD_I_NNN:
+            return "I = " + Hex(in.nnn, 3) + ";";
+        case Op::ADD_I_VX:
+            return "I += " + vx + ";";
+        case Op::LD_F_VX:
+            return "I = " + Hex(FONTSET_START_ADDRESS, 3) + " + " + vx + " * 5;";
+        default:
+            return "";
+        }
+    }
+
+    /**
+     * @brief Returns the pc update of a conditional skip, empty for other operations.
+     */
+    std::string NativeSkip(const Instruction &in, std::uint16_t address)
+    {
+        const std::string taken = Hex(address + 4, 3);
+        const std::string next = Hex(address + 2, 3);
+
+        switch (in.op)
+        {
+        case Op::SE_VX_NN:
+            return "*c.pc = " + Reg(in.x) + " == " + Hex(in.nn, 2) + " ? " + taken + " : " + next + ";";
+        case Op::SNE_VX_NN:
+            return "*c.pc = " + Reg(in.x) + " != " + Hex(in.nn, 2) + " ? " + taken + " : " + next + ";";
+        case Op::SE_VX_VY:
+            return "*c.pc = " + Reg(in.x) + " == " + Reg(in.y) + " ? " + taken + " : " + next + ";";
+        case Op::SNE_VX_VY:
+            return "*c.pc = " + Reg(in.x) + " != " + Reg(in.y) + " ? " + taken + " : " + next + ";";
+        default:
+            return "";
+        }
+    }
+
+    std::string InstructionName(std::uint16_t address)
+    {
+        return "OP_" + Label(address);
+    }
+
+    /**
+     * @brief Writes the pre-decoded instruction passed to the core's handlers.
+     * Blocks may overlap, so each address is only declared once.
+     */
+    void WriteInstruction(std::ostream &out, const Instruction &in, std::uint16_t address, std::set<std::uint16_t> &declared)
+    {
+        if (!declared.insert(address).second)
+        {
+            return;
+        }
+
+        out << "    constexpr chip8::Instruction " << InstructionName(address) << "{static_cast<chip8::Op>("
+            << static_cast<int>(in.op) << "), " << Hex(in.x, 1) << ", " << Hex(in.y, 1) << ", " << Hex(in.n, 1)
+            << ", " << Hex(in.nn, 2) << ", " << Hex(in.nnn, 3) << ", " << Hex(in.opcode, 4) << "};\n";
+    }
+
+    /**
+     * @brief Writes the function of one block.
+     * Straight-line ALU, register and I operations and the register skips
+     * are inlined; drawing, keys, timers, memory and calls run through the
+     * core's handlers. The cycle count is brought up to date before the
+     * last instruction, which is where BlockCache puts timer operations.
+     * @return Number of inlined instructions.
+     */
+    std::size_t WriteBlock(std::ostream &out, const DecodedBlock &block, const chip8::Quirks &quirks,
+                           std::set<std::uint16_t> &declared)
+    {
+        std::size_t inlined = 0;
+        const std::size_t length = block.instructions.size();
+
+        for (std::size_t i = 0; i + 1 < length; ++i)
+        {
+            const Instruction &in = block.instructions[i];
+            if (NativeBody(in, quirks).empty())
+            {
+                WriteInstruction(out, in, static_cast<std::uint16_t>(block.start + 2 * i), declared);
+            }
+        }
+
+        const Instruction &last = block.instructions.back();
+        const std::uint16_t lastAddress = static_cast<std::uint16_t>(block.End() - 2);
+        const bool lastInline = last.op == Op::JP || !NativeSkip(last, lastAddress).empty() || !NativeBody(last, quirks).empty();
+        if (!lastInline)
+        {
+            WriteInstruction(out, last, lastAddress, declared);
+        }
+
+        std::ostringstream body;
+        for (std::size_t i = 0; i + 1 < length; ++i)
+        {
+            const Instruction &in = block.instructions[i];
+            const std::uint16_t address = static_cast<std::uint16_t>(block.start + 2 * i);
+            const std::string native = NativeBody(in, quirks);
+
+            body << "        ";
+            if (native.empty())
+            {
+                body << "chip8::AotCall(c, " << InstructionName(address) << ");";
+            }
+            else
+            {
+                body << native;
+                ++inlined;
+            }
+
+            body << " // " << Label(address) << ": " << chip8::Disassemble(in.opcode) << "\n";
+        }
+
+        const std::string comment = " // " + Label(lastAddress) + ": " + chip8::Disassemble(last.opcode) + "\n";
+
+        if (lastInline)
+        {
+            if (last.op == Op::JP)
+            {
+                body << "        *c.pc = " << Hex(last.nnn, 3) << ";" << comment;
+            }
+            else if (!NativeSkip(last, lastAddress).empty())
+            {
+                body << "        " << NativeSkip(last, lastAddress) << comment;
+            }
+            else
+            {
+                body << "        " << NativeBody(last, quirks) << comment;
+                body << "        *c.pc = " << Hex(lastAddress + 2, 3) << ";\n";
+            }
+
+            body << "        *c.cycles += " << length << ";\n";
+            ++inlined;
+        }
+        else
+        {
+            if (length > 1)
+            {
+                body << "        *c.cycles += " << length - 1 << ";\n";
+            }
+
+            body << "        *c.pc = " << Hex(lastAddress, 3) << ";\n";
+            body << "        chip8::AotStep(c, " << InstructionName(lastAddress) << ");" << comment;
+            body << "        *c.cycles += 1;\n";
+        }
+
+        // Registers and I are only bound when the inlined code uses them
+        const std::string code = body.str();
+        out << "\n    // " << Hex(block.start, 3) << "-" << Hex(block.End(), 3) << "\n";
+        out << "    void Block_" << Label(block.start) << "(chip8::AotContext &c)\n    {\n";
+        if (code.find("V[") != std::string::npos)
+        {
+            out << "        std::uint8_t *const V = c.V;\n";
+        }
+        if (code.find("I =") != std::string::npos || code.find("I +=") != std::string::npos)
+        {
+            out << "        std::uint16_t &I = *c.I;\n";
+        }
+        out << code << "    }\n\n";
+        return inlined;
+    }
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " <ROM_file> <output.cpp> [--profile modern|vip|schip]" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        std::vector<std::string> paths;
+        chip8::Profile profile = chip8::Profile::Modern;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--profile" && i + 1 < argc)
+            {
+                if (!chip8::ParseProfile(argv[++i], profile))
+                {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+            }
+            else
+            {
+                paths.push_back(arg);
+            }
+        }
+
+        if (paths.size() != 2)
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        std::ifstream file(paths[0], std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("ROM couldn't be opened: " + paths[0]);
+        }
+
+        const std::vector<std::uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (rom.empty() || rom.size() > chip8::MAX_ROM_SIZE)
+        {
+            throw std::runtime_error("ROM size must be between 1 and " + std::to_string(chip8::MAX_ROM_SIZE) + " bytes: " + paths[0]);
+        }
+
+        const chip8::Quirks quirks = chip8::GetQuirks(profile);
+        const std::map<std::uint16_t, DecodedBlock> blocks = DiscoverBlocks(rom);
+        const std::string name = std::filesystem::path(paths[0]).filename().string();
+        if (blocks.empty())
+        {
+            throw std::runtime_error("No code found at " + Hex(ROM_START, 3) + ": " + paths[0]);
+        }
+
+        std::ofstream out(paths[1]);
+        if (!out.is_open())
+        {
+            throw std::runtime_error("Output couldn't be created: " + paths[1]);
+        }
+
+        out << "// Generated by chip8_aot from " << name << " (" << chip8::ProfileName(profile) << " profile), do not edit.\n\n";
+        out << "#include \"Aot.hpp\"\n\n";
+        out << "namespace\n{\n";
+
+        out << "    const std::uint8_t ROM[] = {";
+        for (std::size_t i = 0; i < rom.size(); ++i)
+        {
+            out << (i % 16 == 0 ? "\n        " : " ") << Hex(rom[i], 2) << ",";
+        }
+        out << "\n    };\n\n";
+
+        std::size_t instructions = 0;
+        std::size_t inlined = 0;
+        std::set<std::uint16_t> declared;
+        for (const auto &entry : blocks)
+        {
+            instructions += entry.second.instructions.size();
+            inlined += WriteBlock(out, entry.second, quirks, declared);
+        }
+
+        std::vector<chip8::FamilyCount> families;
+        std::vector<std::size_t> firstFamily;
+        std::vector<std::uint8_t> familyCount;
+        for (const auto &entry : blocks)
+        {
+            std::array<std::uint8_t, chip8::OPCODE_FAMILIES> histogram{};
+            for (const Instruction &in : entry.second.instructions)
+            {
+                ++histogram[chip8::OpcodeFamily(in.opcode)];
+            }
+
+            firstFamily.push_back(families.size());
+            familyCount.push_back(chip8::AppendFamilyCounts(histogram, families));
+        }
+
+        out << "    const chip8::FamilyCount FAMILIES[] = {";
+        for (std::size_t i = 0; i < families.size(); ++i)
+        {
+            out << (i % 8 == 0 ? "\n        " : " ") << "{" << +families[i].family << ", " << +families[i].count << "},";
+        }
+        out << "\n    };\n\n";
+
+        out << "    const chip8::AotBlock BLOCKS[] = {\n";
+        std::size_t index = 0;
+        for (const auto &entry : blocks)
+        {
+            const DecodedBlock &block = entry.second;
+            out << "        {&Block_" << Label(block.start) << ", " << Hex(block.start, 3) << ", " << Hex(block.End(), 3)
+                << ", " << block.instructions.size() << ", &FAMILIES[" << firstFamily[index] << "], "
+                << +familyCount[index] << "},\n";
+            ++index;
+        }
+        out << "    };\n\n";
+
+        out << "    const chip8::AotProgram PROGRAM = {\n";
+        out << "        \"" << name << "\",\n";
+        out << "        static_cast<chip8::Profile>(" << static_cast<int>(profile) << "), // " << chip8::ProfileName(profile) << "\n";
+        out << "        0x" << std::hex << std::uppercase << chip8::HashRom(rom.data(), rom.size()) << std::dec << "ull,\n";
+        out << "        ROM,\n";
+        out << "        " << rom.size() << ",\n";
+        out << "        BLOCKS,\n";
+        out << "        " << blocks.size() << ",\n";
+        out << "    };\n\n";
+
+        out << "    [[maybe_unused]] const bool REGISTERED = chip8::RegisterAotProgram(PROGRAM);\n";
+        out << "}\n";
+
+        if (!out)
+        {
+            throw std::runtime_error("Output couldn't be written: " + paths[1]);
+        }
+
+        std::cout << name << ": " << blocks.size() << " blocks, " << instructions << " instructions ("
+                  << inlined << " inlined) -> " << paths[1] << std::endl;
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
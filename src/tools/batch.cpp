@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Batch.hpp"
+#include "Chip8.hpp"
+
+namespace
+{
+    struct Options
+    {
+        std::string romPath;
+        std::size_t lanes = 256;
+        std::uint64_t frames = 600;
+        std::uint64_t cyclesPerFrame = 10;
+        bool randomKeys = false;
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " <ROM_file> [--lanes N] [--frames N] [--cycles-per-frame N]"
+                  << " [--random-keys]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if ((arg == "--lanes" || arg == "--frames" || arg == "--cycles-per-frame") && i + 1 < argc)
+            {
+                const std::uint64_t value = std::stoull(argv[++i]);
+
+                if (arg == "--lanes")
+                    options.lanes = static_cast<std::size_t>(value);
+                else if (arg == "--frames")
+                    options.frames = value;
+                else
+                    options.cyclesPerFrame = value;
+            }
+            else if (arg == "--random-keys")
+            {
+                options.randomKeys = true;
+            }
+            else if (options.romPath.empty() && arg.rfind("--", 0) != 0)
+            {
+                options.romPath = arg;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return !options.romPath.empty() && options.lanes > 0 && options.frames > 0 && options.cyclesPerFrame > 0 &&
+               options.cyclesPerFrame <= std::numeric_limits<std::uint32_t>::max() / chip8::Chip8::TIMER_RATE;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        std::ifstream file(options.romPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: File does not exist: " << options.romPath << std::endl;
+            return 1;
+        }
+
+        const std::vector<std::uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        chip8::BatchChip8 batch(options.lanes);
+        batch.loadROM(rom.data(), rom.size());
+        batch.SetClockRate(static_cast<std::uint32_t>(options.cyclesPerFrame * chip8::Chip8::TIMER_RATE));
+
+        // Lanes differ in their random stream, and with --random-keys in their input
+        for (std::size_t lane = 1; lane < options.lanes; ++lane)
+        {
+            batch.SetLaneSeed(lane, chip8::DEFAULT_SEED + lane);
+        }
+
+        std::uint32_t keyState = 0x12345678;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::uint64_t frame = 0; frame < options.frames; ++frame)
+        {
+            if (options.randomKeys)
+            {
+                for (std::size_t lane = 0; lane < options.lanes; ++lane)
+                {
+                    keyState ^= keyState << 13;
+                    keyState ^= keyState >> 17;
+                    keyState ^= keyState << 5;
+
+                    const bool press = (keyState & 0xF0) == 0;
+                    batch.SetLaneKeys(lane, press ? static_cast<std::uint16_t>(1u << (keyState & 0xF)) : 0);
+                }
+            }
+
+            batch.emulateCycles(options.cyclesPerFrame);
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double seconds = elapsed.count() > 0.0 ? elapsed.count() : 1e-9;
+        const chip8::BatchStats &stats = batch.GetStats();
+
+        std::cout << "Lanes: " << options.lanes << " (" << batch.GetFaultCount() << " faulted)\n"
+                  << "Cycles: " << stats.laneCycles << " (" << stats.steps << " steps)\n"
+                  << "Occupancy: " << stats.Occupancy(options.lanes) * 100.0 << "% ("
+                  << stats.denseSteps << " dense, " << stats.scalarSteps << " scalar steps)\n"
+                  << "Time: " << seconds * 1000.0 << " ms\n"
+                  << "Speed: " << stats.laneCycles / seconds / 1e6 << " MIPS" << std::endl;
+
+        for (std::size_t lane = 0; lane < options.lanes; ++lane)
+        {
+            if (!batch.GetFault(lane).empty())
+            {
+                std::cout << "First fault: lane " << lane << ": " << batch.GetFault(lane) << std::endl;
+                break;
+            }
+        }
+
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,458 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchReport.hpp"
+#include "Capture.hpp"
+#include "Chip8.hpp"
+#include "Decoder.hpp"
+#include "Rewind.hpp"
+#include "display/NullDisplay.hpp"
+
+namespace
+{
+    struct Options
+    {
+        std::uint64_t cycles = 2000000;
+        std::size_t repeats = 10;
+        std::string filter;
+        std::string jsonPath;
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--cycles N] [--repeats N] [--filter NAME] [--json FILE]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--cycles" && i + 1 < argc)
+            {
+                options.cycles = std::stoull(argv[++i]);
+            }
+            else if (arg == "--repeats" && i + 1 < argc)
+            {
+                options.repeats = static_cast<std::size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--filter" && i + 1 < argc)
+            {
+                options.filter = argv[++i];
+            }
+            else if (arg == "--json" && i + 1 < argc)
+            {
+                options.jsonPath = argv[++i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.cycles != 0 && options.repeats != 0;
+    }
+
+    /**
+     * @brief Assembles a ROM one opcode at a time.
+     */
+    class RomBuilder
+    {
+    public:
+        void Emit(std::uint16_t opcode)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(opcode >> 8));
+            bytes.push_back(static_cast<std::uint8_t>(opcode));
+        }
+
+        /**
+         * @brief Address of the next emitted opcode.
+         */
+        std::uint16_t Here() const
+        {
+            return static_cast<std::uint16_t>(0x200 + bytes.size());
+        }
+
+        std::vector<std::uint8_t> bytes;
+    };
+
+    /**
+     * @brief Synthetic ROM that spends nearly all its cycles in one opcode class.
+     */
+    struct Workload
+    {
+        const char *name;
+        const char *description;
+        std::vector<std::uint8_t> (*build)();
+    };
+
+    // Bodies are long straight-line runs, so the closing jump is a small share of the cycles
+
+    std::vector<std::uint8_t> BuildAlu()
+    {
+        RomBuilder rom;
+        for (std::uint16_t x = 0; x < 8; ++x)
+        {
+            rom.Emit(0x6000 | x << 8 | (x * 37 + 11));
+        }
+
+        static const std::uint16_t BODY[] = {0x8014, 0x8125, 0x8231, 0x8342, 0x8453, 0x8566, 0x867E, 0x8707};
+        const std::uint16_t loop = rom.Here();
+        for (int i = 0; i < 128; ++i)
+        {
+            for (std::uint16_t opcode : BODY)
+            {
+                rom.Emit(opcode);
+            }
+        }
+
+        rom.Emit(0x1000 | loop);
+        return rom.bytes;
+    }
+
+    std::vector<std::uint8_t> BuildDraw()
+    {
+        RomBuilder rom;
+        for (std::uint16_t x = 0; x < 8; ++x)
+        {
+            rom.Emit(0x6000 | x << 8 | (x * 9 + 3));
+        }
+
+        // The built-in font, five rows per glyph
+        rom.Emit(0xA000);
+
+        const std::uint16_t loop = rom.Here();
+        for (int i = 0; i < 256; ++i)
+        {
+            const std::uint16_t x = static_cast<std::uint16_t>(i % 8);
+            const std::uint16_t y = static_cast<std::uint16_t>((i + 3) % 8);
+            rom.Emit(0xD005 | x << 8 | y << 4);
+        }
+
+        rom.Emit(0x1000 | loop);
+        return rom.bytes;
+    }
+
+    std::vector<std::uint8_t> BuildMemory()
+    {
+        RomBuilder rom;
+
+        // Above the code, so the stores never invalidate translated blocks
+        rom.Emit(0xAE00);
+
+        const std::uint16_t loop = rom.Here();
+        for (int i = 0; i < 128; ++i)
+        {
+            rom.Emit(0xFF55);
+            rom.Emit(0xFF65);
+            rom.Emit(0xF755);
+            rom.Emit(0xF765);
+        }
+
+        rom.Emit(0x1000 | loop);
+        return rom.bytes;
+    }
+
+    std::vector<std::uint8_t> BuildCalls()
+    {
+        // A chain of nested subroutines, leaving one stack slot for the main loop
+        constexpr std::uint16_t DEPTH = 15;
+
+        RomBuilder rom;
+        const std::uint16_t loop = rom.Here();
+        const std::uint16_t first = static_cast<std::uint16_t>(loop + 4);
+        rom.Emit(0x2000 | first);
+        rom.Emit(0x1000 | loop);
+
+        for (std::uint16_t level = 0; level + 1 < DEPTH; ++level)
+        {
+            rom.Emit(0x2000 | (rom.Here() + 4));
+            rom.Emit(0x00EE);
+        }
+
+        rom.Emit(0x00EE);
+        return rom.bytes;
+    }
+
+    std::vector<std::uint8_t> BuildTimers()
+    {
+        RomBuilder rom;
+        const std::uint16_t loop = rom.Here();
+        rom.Emit(0x6F03);
+        rom.Emit(0xFF15);
+
+        // Busy-wait on the delay timer like most games do; the counter keeps
+        // the loop from matching the wait loop emulateCycles fast-forwards
+        const std::uint16_t poll = rom.Here();
+        rom.Emit(0xFE07);
+        rom.Emit(0x7D01);
+        rom.Emit(0x3E00);
+        rom.Emit(0x1000 | poll);
+        rom.Emit(0x1000 | loop);
+        return rom.bytes;
+    }
+
+    const Workload WORKLOADS[] = {
+        {"alu", "8XYN arithmetic and logic", BuildAlu},
+        {"draw", "DXYN sprites", BuildDraw},
+        {"memory", "FX55/FX65 register stores and loads", BuildMemory},
+        {"calls", "2NNN/00EE call chains", BuildCalls},
+        {"timers", "FX07 delay timer polling, not fast-forwarded", BuildTimers},
+    };
+
+    double Time(const std::function<void()> &body)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    /**
+     * @brief Runs a body once to warm up, then once per repeat.
+     */
+    void Repeat(bench::Measurement &measurement, std::size_t repeats, const std::function<void()> &body)
+    {
+        body();
+
+        for (std::size_t i = 0; i < repeats; ++i)
+        {
+            measurement.seconds.push_back(Time(body));
+        }
+    }
+
+    bench::Measurement BenchDecode(const Options &options)
+    {
+        // Every 16-bit opcode, as often as fits in the requested cycles
+        const std::uint64_t passes = options.cycles / 0x10000 + 1;
+
+        bench::Measurement measurement{"decode", "all-opcodes", "opcode", passes * 0x10000, {}};
+        volatile std::uint32_t sink = 0;
+
+        Repeat(measurement, options.repeats,
+               [&]
+               {
+                   std::uint32_t checksum = 0;
+                   for (std::uint64_t pass = 0; pass < passes; ++pass)
+                   {
+                       for (std::uint32_t opcode = 0; opcode < 0x10000; ++opcode)
+                       {
+                           const chip8::Instruction in = chip8::Decode(static_cast<std::uint16_t>(opcode));
+                           checksum += static_cast<std::uint32_t>(in.op) + in.nnn;
+                       }
+                   }
+
+                   sink = sink + checksum;
+               });
+
+        return measurement;
+    }
+
+    /**
+     * @brief Times a workload with emulateCycle, then with every available engine.
+     */
+    void BenchWorkload(const Workload &workload, const Options &options, std::vector<bench::Measurement> &results)
+    {
+        const std::vector<std::uint8_t> rom = workload.build();
+
+        {
+            chip8::Chip8 chip;
+            chip.loadROM(rom.data(), rom.size());
+
+            bench::Measurement measurement{workload.name, "step", "instruction", options.cycles, {}};
+            Repeat(measurement, options.repeats,
+                   [&]
+                   {
+                       for (std::uint64_t i = 0; i < options.cycles; ++i)
+                       {
+                           chip.emulateCycle();
+                       }
+                   });
+
+            results.push_back(std::move(measurement));
+        }
+
+        for (chip8::Engine engine : {chip8::Engine::Interpreter, chip8::Engine::BlockCache, chip8::Engine::Jit})
+        {
+            chip8::Chip8 chip;
+            chip.loadROM(rom.data(), rom.size());
+
+            try
+            {
+                chip.SetEngine(engine);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Skipping " << workload.name << " on " << chip8::EngineName(engine) << ": " << e.what()
+                          << std::endl;
+                continue;
+            }
+
+            bench::Measurement measurement{workload.name, chip8::EngineName(engine), "instruction", options.cycles, {}};
+            Repeat(measurement, options.repeats, [&] { chip.emulateCycles(options.cycles); });
+
+            // Fast-forwarded wait loops cost nothing, the row would not compare with step
+            const std::uint64_t idle = chip.GetPerfCounters().idleCycles;
+            if (idle != 0)
+            {
+                std::cerr << "Note: " << workload.name << " on " << chip8::EngineName(engine) << " fast-forwarded "
+                          << idle << " of " << options.cycles * (options.repeats + 1) << " cycles" << std::endl;
+            }
+
+            results.push_back(std::move(measurement));
+        }
+    }
+
+    /**
+     * @brief Times the per-frame work of the frontend without SDL:
+     * a frame of cycles, the rewind capture, rendering and input.
+     */
+    bench::Measurement BenchFrame(const Options &options)
+    {
+        const std::vector<std::uint8_t> rom = BuildDraw();
+
+        chip8::Chip8 chip;
+        chip.loadROM(rom.data(), rom.size());
+
+        display::NullDisplay display;
+        chip8::RewindBuffer rewind(16u << 20);
+        chip8::Snapshot snapshot;
+
+        const std::uint64_t cyclesPerFrame = chip.GetClockRate() / chip8::Chip8::TIMER_RATE;
+        const std::uint64_t frames = options.cycles / cyclesPerFrame / 100 + 1;
+
+        bench::Measurement measurement{"frame", "default-clock", "frame", frames, {}};
+        Repeat(measurement, options.repeats,
+               [&]
+               {
+                   for (std::uint64_t frame = 0; frame < frames; ++frame)
+                   {
+                       chip.emulateCycles(cyclesPerFrame);
+
+                       chip.SaveState(snapshot);
+                       rewind.Push(snapshot);
+
+                       if (chip.ShouldDraw() && display.Render(chip.GetGfx(), chip.GetDirtyRows()))
+                       {
+                           chip.ClearDrawFlag();
+                       }
+
+                       display.HandleEvents(chip.GetKeypad());
+                   }
+               });
+
+        return measurement;
+    }
+
+    /**
+     * @brief Times the emulation thread's share of a screen capture: queueing a frame.
+     * Frames change every push, and the queue is sized so none are dropped.
+     */
+    bench::Measurement BenchCapture(const Options &options)
+    {
+        const std::uint64_t frames = 1024;
+        const std::string path = "chip8_bench.capture";
+
+        bench::Measurement measurement{"capture", "push", "frame", frames, {}};
+        chip8::FrameBuffer screen{};
+
+        for (std::size_t i = 0; i <= options.repeats; ++i)
+        {
+            chip8::CaptureWriter capture(path, 2048);
+
+            const double seconds = Time(
+                [&]
+                {
+                    for (std::uint64_t frame = 0; frame < frames; ++frame)
+                    {
+                        screen[frame % chip8::SCREEN_HEIGHT] ^= frame * 0x9E3779B97F4A7C15ull;
+                        capture.Push(screen.data());
+                    }
+                });
+
+            capture.Close();
+
+            // The first run warms up, like Repeat
+            if (i != 0)
+            {
+                measurement.seconds.push_back(seconds);
+            }
+        }
+
+        std::remove(path.c_str());
+        return measurement;
+    }
+
+    bool Selected(const Options &options, const std::string &name)
+    {
+        return options.filter.empty() || options.filter == name;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        std::vector<bench::Measurement> results;
+
+        if (Selected(options, "decode"))
+        {
+            results.push_back(BenchDecode(options));
+        }
+
+        for (const Workload &workload : WORKLOADS)
+        {
+            if (Selected(options, workload.name))
+            {
+                std::cout << "Running " << workload.name << " (" << workload.description << ")" << std::endl;
+                BenchWorkload(workload, options, results);
+            }
+        }
+
+        if (Selected(options, "frame"))
+        {
+            results.push_back(BenchFrame(options));
+        }
+
+        if (Selected(options, "capture"))
+        {
+            results.push_back(BenchCapture(options));
+        }
+
+        if (results.empty())
+        {
+            std::cerr << "Error: No benchmark named " << options.filter << std::endl;
+            return 1;
+        }
+
+        bench::PrintTable(results);
+
+        if (!options.jsonPath.empty())
+        {
+            bench::WriteJson(options.jsonPath, "chip8_bench", results);
+            std::cout << "Report written: " << options.jsonPath << std::endl;
+        }
+
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,130 @@
+#include <SDL.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchReport.hpp"
+#include "FrameBuffer.hpp"
+#include "display/Display.hpp"
+
+namespace
+{
+    struct Options
+    {
+        std::uint64_t frames = 120;
+        std::string jsonPath;
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--frames N] [--json FILE]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--frames" && i + 1 < argc)
+            {
+                options.frames = std::stoull(argv[++i]);
+            }
+            else if (arg == "--json" && i + 1 < argc)
+            {
+                options.jsonPath = argv[++i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.frames != 0;
+    }
+
+    /**
+     * @brief Times the Render calls that present, for frames presents.
+     * Render drops calls made faster than the refresh rate, and those
+     * return immediately, so only the presenting calls are measured.
+     */
+    bench::Measurement BenchRender(display::Display &display, const char *variant, std::uint32_t dirtyRows,
+                                   std::uint64_t frames)
+    {
+        std::array<std::uint64_t, 32> gfx{};
+        std::uint64_t pattern = 0x9E3779B97F4A7C15ull;
+
+        bench::Measurement measurement{"render", variant, "frame", 1, {}};
+
+        while (measurement.seconds.size() < frames)
+        {
+            // A new screen every frame, so the uploads are not of identical data
+            for (std::uint64_t &row : gfx)
+            {
+                pattern ^= pattern << 13;
+                pattern ^= pattern >> 7;
+                pattern ^= pattern << 17;
+                row = pattern;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const bool presented = display.Render(gfx.data(), dirtyRows);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (presented)
+            {
+                measurement.seconds.push_back(elapsed.count());
+            }
+            else
+            {
+                SDL_Delay(1);
+            }
+        }
+
+        return measurement;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        // Offscreen by default, so the numbers do not depend on a desktop or sound card
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+
+        display::Display display;
+
+        std::vector<bench::Measurement> results;
+        results.push_back(BenchRender(display, "all-rows", chip8::ALL_ROWS, options.frames));
+        results.push_back(BenchRender(display, "one-row", 1u << 16, options.frames));
+        results.push_back(BenchRender(display, "no-rows", 0, options.frames));
+
+        bench::PrintTable(results);
+
+        if (!options.jsonPath.empty())
+        {
+            bench::WriteJson(options.jsonPath, "chip8_bench_render", results);
+            std::cout << "Report written: " << options.jsonPath << std::endl;
+        }
+
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Capture.hpp"
+
+namespace
+{
+    struct Options
+    {
+        std::string capturePath;
+        std::string prefix;
+        int scale = 8;
+        bool changesOnly = false;
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " <capture> <output_prefix> [--scale N] [--changes-only]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--scale" && i + 1 < argc)
+            {
+                options.scale = std::stoi(argv[++i]);
+            }
+            else if (arg == "--changes-only")
+            {
+                options.changesOnly = true;
+            }
+            else if (arg.rfind("--", 0) == 0)
+            {
+                return false;
+            }
+            else if (options.capturePath.empty())
+            {
+                options.capturePath = arg;
+            }
+            else if (options.prefix.empty())
+            {
+                options.prefix = arg;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return !options.capturePath.empty() && !options.prefix.empty() && options.scale >= 1 && options.scale <= 64;
+    }
+
+    std::uint32_t Crc32(const std::uint8_t *data, std::size_t size, std::uint32_t crc = 0)
+    {
+        static const std::array<std::uint32_t, 256> TABLE = []
+        {
+            std::array<std::uint32_t, 256> table{};
+            for (std::uint32_t n = 0; n < 256; ++n)
+            {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                table[n] = c;
+            }
+            return table;
+        }();
+
+        crc = ~crc;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            crc = TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    void PutBigEndian(std::vector<std::uint8_t> &out, std::uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void PutChunk(std::vector<std::uint8_t> &png, const char *type, const std::vector<std::uint8_t> &data)
+    {
+        PutBigEndian(png, static_cast<std::uint32_t>(data.size()));
+
+        const std::size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        PutBigEndian(png, Crc32(&png[start], png.size() - start));
+    }
+
+    /**
+     * @brief Wraps raw bytes in a zlib stream of stored deflate blocks.
+     * The images are tiny, so skipping compression costs little and needs no library.
+     */
+    std::vector<std::uint8_t> ZlibStore(const std::vector<std::uint8_t> &raw)
+    {
+        std::vector<std::uint8_t> out = {0x78, 0x01};
+
+        std::size_t pos = 0;
+        do
+        {
+            const std::size_t length = std::min<std::size_t>(raw.size() - pos, 0xFFFF);
+            const bool last = pos + length == raw.size();
+
+            out.push_back(last ? 1 : 0);
+            out.push_back(static_cast<std::uint8_t>(length));
+            out.push_back(static_cast<std::uint8_t>(length >> 8));
+            out.push_back(static_cast<std::uint8_t>(~length));
+            out.push_back(static_cast<std::uint8_t>(~length >> 8));
+            out.insert(out.end(), raw.begin() + pos, raw.begin() + pos + length);
+            pos += length;
+        } while (pos < raw.size());
+
+        std::uint32_t a = 1;
+        std::uint32_t b = 0;
+        for (std::uint8_t byte : raw)
+        {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+
+        PutBigEndian(out, b << 16 | a);
+        return out;
+    }
+
+    /**
+     * @brief Encodes a screen as a 1-bit greyscale PNG, lit pixels white.
+     * @param scale Size of a CHIP-8 pixel in image pixels.
+     */
+    std::vector<std::uint8_t> EncodePng(const chip8::FrameBuffer &frame, int scale)
+    {
+        const int width = chip8::SCREEN_WIDTH * scale;
+        const int height = chip8::SCREEN_HEIGHT * scale;
+        const int rowBytes = (width + 7) / 8;
+
+        // Every image row starts with filter type 0 (none)
+        std::vector<std::uint8_t> raw(static_cast<std::size_t>(height) * (rowBytes + 1), 0);
+        for (int y = 0; y < height; ++y)
+        {
+            std::uint8_t *row = &raw[static_cast<std::size_t>(y) * (rowBytes + 1) + 1];
+            for (int x = 0; x < width; ++x)
+            {
+                if (chip8::GetPixel(frame.data(), x / scale, y / scale))
+                {
+                    row[x / 8] |= static_cast<std::uint8_t>(0x80 >> (x % 8));
+                }
+            }
+        }
+
+        std::vector<std::uint8_t> header;
+        PutBigEndian(header, static_cast<std::uint32_t>(width));
+        PutBigEndian(header, static_cast<std::uint32_t>(height));
+        header.insert(header.end(), {1, 0, 0, 0, 0}); // bit depth 1, greyscale, no interlace
+
+        std::vector<std::uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        PutChunk(png, "IHDR", header);
+        PutChunk(png, "IDAT", ZlibStore(raw));
+        PutChunk(png, "IEND", {});
+        return png;
+    }
+
+    void WriteFile(const std::string &filename, const std::vector<std::uint8_t> &bytes)
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+        if (!file)
+        {
+            throw std::runtime_error("Image couldn't be written: " + filename);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        chip8::CaptureReader reader(options.capturePath);
+
+        // Files are numbered by frame, so skipped frames keep their timing
+        const int digits = static_cast<int>(std::to_string(reader.GetFrameCount()).size());
+
+        chip8::FrameBuffer frame{};
+        chip8::FrameBuffer written{};
+        std::uint64_t frames = 0;
+        std::uint64_t images = 0;
+
+        while (reader.Next(frame))
+        {
+            if (!options.changesOnly || images == 0 || frame != written)
+            {
+                std::ostringstream filename;
+                filename << options.prefix << std::setw(std::max(digits, 6)) << std::setfill('0') << frames << ".png";
+                WriteFile(filename.str(), EncodePng(frame, options.scale));
+
+                written = frame;
+                ++images;
+            }
+
+            ++frames;
+        }
+
+        std::cout << "Frames: " << frames << '\n' << "Images written: " << images << std::endl;
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
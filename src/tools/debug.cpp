@@ -0,0 +1,476 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Chip8.hpp"
+#include "Debugger.hpp"
+#include "Disassembler.hpp"
+#include "Movie.hpp"
+
+namespace
+{
+    struct Options
+    {
+        std::string romPath;
+        chip8::Engine engine = chip8::Engine::Interpreter;
+        chip8::Profile profile = chip8::Profile::Modern;
+        std::uint64_t seed = chip8::DEFAULT_SEED;
+        std::uint64_t runLimit = 10000000;
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " <ROM_file> [--engine interpreter|blocks|jit|aot]"
+                  << " [--profile modern|vip|schip] [--seed N] [--run-limit CYCLES]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--engine" && i + 1 < argc)
+            {
+                if (!chip8::ParseEngine(argv[++i], options.engine))
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--profile" && i + 1 < argc)
+            {
+                if (!chip8::ParseProfile(argv[++i], options.profile))
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--seed" && i + 1 < argc)
+            {
+                options.seed = std::stoull(argv[++i], nullptr, 0);
+            }
+            else if (arg == "--run-limit" && i + 1 < argc)
+            {
+                options.runLimit = std::stoull(argv[++i], nullptr, 0);
+            }
+            else if (options.romPath.empty() && arg.rfind("--", 0) != 0)
+            {
+                options.romPath = arg;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return !options.romPath.empty() && options.runLimit != 0;
+    }
+
+    const char *HELP =
+        "break ADDR [if VX OP NN]   stop before the instruction at ADDR, OP one of == != < <= > >=\n"
+        "break if VX OP NN          stop before any instruction while the condition holds\n"
+        "watch FIRST[-LAST] [r|w|rw] stop after an instruction reads or writes the range (default rw)\n"
+        "delete ID                  remove a breakpoint or watchpoint\n"
+        "info                       list breakpoints and watchpoints\n"
+        "step [N], next, finish     step N instructions, over a call, out of the subroutine\n"
+        "frame [N|+N]               run to frame N, or N frames on (default +1)\n"
+        "continue                   run until something stops the machine\n"
+        "regs, x ADDR [LEN], list [ADDR] [N]\n"
+        "                           show registers, memory, disassembly\n"
+        "keys MASK                  hold keys, bit k for key k\n"
+        "quit\n"
+        "Numbers are decimal or 0x-prefixed hexadecimal.\n";
+
+    std::uint16_t ParseAddress(const std::string &text)
+    {
+        const unsigned long value = std::stoul(text, nullptr, 0);
+        if (value >= chip8::GuestMemory::SIZE)
+        {
+            throw std::invalid_argument("Address out of range: " + text);
+        }
+
+        return static_cast<std::uint16_t>(value);
+    }
+
+    std::uint8_t ParseRegister(const std::string &text)
+    {
+        if (text.size() != 2 || (text[0] != 'V' && text[0] != 'v') || !std::isxdigit(static_cast<unsigned char>(text[1])))
+        {
+            throw std::invalid_argument("Not a register: " + text);
+        }
+
+        return static_cast<std::uint8_t>(std::stoul(text.substr(1), nullptr, 16));
+    }
+
+    std::string Location(const chip8::Snapshot &state, std::uint16_t address)
+    {
+        const std::uint16_t opcode = state.memory[address & 0xFFF] << 8 | state.memory[(address + 1) & 0xFFF];
+        std::ostringstream out;
+        out << chip8::ToHex(address) << ": " << chip8::Disassemble(opcode);
+        return out.str();
+    }
+
+    /**
+     * @brief Console session around one chip and its debugger.
+     */
+    class Console
+    {
+    public:
+        Console(chip8::Chip8 &debugged, const Options &runOptions)
+            : chip(debugged), debugger(debugged), options(runOptions)
+        {
+        }
+
+        /**
+         * @brief Executes one command line.
+         * @return false when the session ends.
+         */
+        bool Execute(const std::string &line)
+        {
+            std::istringstream in(line);
+            std::vector<std::string> words;
+            for (std::string word; in >> word;)
+            {
+                words.push_back(word);
+            }
+
+            if (words.empty())
+            {
+                return true;
+            }
+
+            const std::string &command = words[0];
+
+            if (command == "q" || command == "quit")
+            {
+                return false;
+            }
+            else if (command == "help" || command == "h")
+            {
+                std::cout << HELP;
+            }
+            else if (command == "b" || command == "break")
+            {
+                Break(words);
+            }
+            else if (command == "w" || command == "watch")
+            {
+                Watch(words);
+            }
+            else if ((command == "d" || command == "delete") && words.size() == 2)
+            {
+                if (!debugger.Remove(static_cast<std::uint32_t>(std::stoul(words[1], nullptr, 0))))
+                {
+                    std::cout << "No breakpoint or watchpoint " << words[1] << '\n';
+                }
+            }
+            else if (command == "i" || command == "info")
+            {
+                Info();
+            }
+            else if (command == "s" || command == "step")
+            {
+                debugger.Step(words.size() > 1 ? std::stoull(words[1], nullptr, 0) : 1);
+                Resume();
+            }
+            else if (command == "n" || command == "next")
+            {
+                debugger.StepOver();
+                Resume();
+            }
+            else if (command == "finish")
+            {
+                debugger.StepOut();
+                Resume();
+            }
+            else if (command == "f" || command == "frame")
+            {
+                std::uint64_t frame = debugger.GetFrame() + 1;
+                if (words.size() > 1)
+                {
+                    frame = words[1][0] == '+' ? debugger.GetFrame() + std::stoull(words[1].substr(1), nullptr, 0)
+                                               : std::stoull(words[1], nullptr, 0);
+                }
+
+                debugger.RunToFrame(frame);
+                Resume();
+            }
+            else if (command == "c" || command == "continue")
+            {
+                debugger.Continue();
+                Resume();
+            }
+            else if (command == "r" || command == "regs")
+            {
+                Registers();
+            }
+            else if (command == "x" && words.size() >= 2)
+            {
+                Memory(ParseAddress(words[1]), words.size() > 2 ? std::stoul(words[2], nullptr, 0) : 16);
+            }
+            else if (command == "l" || command == "list")
+            {
+                chip.SaveState(state);
+                const std::uint16_t start = words.size() > 1 ? ParseAddress(words[1]) : state.pc;
+                const unsigned long count = words.size() > 2 ? std::stoul(words[2], nullptr, 0) : 8;
+
+                for (unsigned long i = 0; i < count; ++i)
+                {
+                    const std::uint16_t address = static_cast<std::uint16_t>((start + 2 * i) & 0xFFF);
+                    std::cout << (address == state.pc ? "=> " : "   ") << Location(state, address) << '\n';
+                }
+            }
+            else if (command == "keys" && words.size() == 2)
+            {
+                chip8::UnpackKeypad(static_cast<std::uint16_t>(std::stoul(words[1], nullptr, 0)), chip.GetKeypad());
+            }
+            else
+            {
+                std::cout << "Unknown command: " << line << " (try help)\n";
+            }
+
+            return true;
+        }
+
+    private:
+        void Break(const std::vector<std::string> &words)
+        {
+            // break [ADDR] [if VX OP NN]
+            std::size_t next = 1;
+            std::uint16_t address = chip8::Breakpoint::ANY_ADDRESS;
+
+            if (next < words.size() && words[next] != "if")
+            {
+                address = ParseAddress(words[next++]);
+            }
+
+            std::uint32_t id;
+            if (next < words.size())
+            {
+                chip8::Condition condition;
+                if (words.size() != next + 4 || words[next] != "if" || !chip8::ParseCondition(words[next + 2], condition))
+                {
+                    throw std::invalid_argument("Expected: break [ADDR] if VX OP NN");
+                }
+
+                const unsigned long value = std::stoul(words[next + 3], nullptr, 0);
+                id = debugger.AddBreakpoint(address, ParseRegister(words[next + 1]), condition,
+                                            static_cast<std::uint8_t>(value));
+            }
+            else if (address != chip8::Breakpoint::ANY_ADDRESS)
+            {
+                id = debugger.AddBreakpoint(address);
+            }
+            else
+            {
+                throw std::invalid_argument("Expected: break ADDR [if VX OP NN]");
+            }
+
+            std::cout << "Breakpoint " << id << '\n';
+        }
+
+        void Watch(const std::vector<std::string> &words)
+        {
+            if (words.size() < 2 || words.size() > 3)
+            {
+                throw std::invalid_argument("Expected: watch FIRST[-LAST] [r|w|rw]");
+            }
+
+            const std::size_t dash = words[1].find('-');
+            const std::uint16_t first = ParseAddress(words[1].substr(0, dash));
+            const std::uint16_t last = dash == std::string::npos ? first : ParseAddress(words[1].substr(dash + 1));
+
+            chip8::WatchKind kind = chip8::WatchKind::Access;
+            if (words.size() == 3)
+            {
+                if (words[2] == "r")
+                    kind = chip8::WatchKind::Read;
+                else if (words[2] == "w")
+                    kind = chip8::WatchKind::Write;
+                else if (words[2] != "rw")
+                    throw std::invalid_argument("Watch kind must be r, w or rw");
+            }
+
+            std::cout << "Watchpoint " << debugger.AddWatchpoint(first, last, kind) << '\n';
+        }
+
+        void Info()
+        {
+            for (const chip8::Breakpoint &breakpoint : debugger.GetBreakpoints())
+            {
+                std::cout << breakpoint.id << "  break ";
+                if (breakpoint.address != chip8::Breakpoint::ANY_ADDRESS)
+                {
+                    std::cout << chip8::ToHex(breakpoint.address) << ' ';
+                }
+
+                if (breakpoint.conditional)
+                {
+                    std::cout << "if V" << std::hex << std::uppercase << +breakpoint.reg << std::dec << ' '
+                              << chip8::ConditionName(breakpoint.condition) << ' ' << chip8::ToHex(breakpoint.value) << ' ';
+                }
+
+                std::cout << "(" << breakpoint.hits << " hits)\n";
+            }
+
+            for (const chip8::Watchpoint &watchpoint : debugger.GetWatchpoints())
+            {
+                static const char *KINDS[] = {"", "r", "w", "rw"};
+                std::cout << watchpoint.id << "  watch " << chip8::ToHex(watchpoint.first) << '-'
+                          << chip8::ToHex(watchpoint.last) << ' ' << KINDS[static_cast<int>(watchpoint.kind)] << " ("
+                          << watchpoint.hits << " hits)\n";
+            }
+        }
+
+        void Registers()
+        {
+            chip.SaveState(state);
+
+            for (int i = 0; i < 16; ++i)
+            {
+                std::cout << 'V' << std::hex << std::uppercase << i << '=' << std::setw(2) << std::setfill('0')
+                          << +state.V[i] << std::dec << (i % 8 == 7 ? '\n' : ' ');
+            }
+
+            std::cout << "I=" << chip8::ToHex(state.I) << " PC=" << chip8::ToHex(state.pc) << " SP=" << +state.sp;
+            for (int i = 0; i < state.sp && i < 16; ++i)
+            {
+                std::cout << (i == 0 ? " [" : " ") << chip8::ToHex(state.stack[i]);
+            }
+
+            std::cout << (state.sp > 0 ? "]" : "") << '\n'
+                      << "Cycle " << chip.GetCycleCount() << ", frame " << debugger.GetFrame() << '\n';
+        }
+
+        void Memory(std::uint16_t address, unsigned long length)
+        {
+            chip.SaveState(state);
+
+            for (unsigned long i = 0; i < length; ++i)
+            {
+                if (i % 16 == 0)
+                {
+                    std::cout << (i == 0 ? "" : "\n") << chip8::ToHex(static_cast<std::uint16_t>((address + i) & 0xFFF))
+                              << ':';
+                }
+
+                std::cout << ' ' << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
+                          << +state.memory[(address + i) & 0xFFF] << std::dec;
+            }
+
+            std::cout << '\n';
+        }
+
+        /**
+         * @brief Runs frame by frame until the debugger stops the machine or the run limit is reached.
+         */
+        void Resume()
+        {
+            const std::uint64_t cyclesPerFrame = std::max<std::uint64_t>(1, chip.GetClockRate() / chip8::Chip8::TIMER_RATE);
+            std::uint64_t executed = 0;
+
+            while (!debugger.IsStopped() && executed < options.runLimit)
+            {
+                executed += chip.emulateCycles(std::min(cyclesPerFrame, options.runLimit - executed));
+            }
+
+            if (!debugger.IsStopped())
+            {
+                debugger.Pause();
+                std::cout << "Paused after " << executed << " cycles\n";
+            }
+
+            chip.SaveState(state);
+            const chip8::StopEvent &stop = debugger.GetStop();
+
+            switch (stop.reason)
+            {
+            case chip8::StopReason::Breakpoint:
+                std::cout << "Breakpoint " << stop.id << '\n';
+                break;
+
+            case chip8::StopReason::Watchpoint:
+                std::cout << "Watchpoint " << stop.id << ": " << (stop.write ? "write to " : "read of ")
+                          << chip8::ToHex(stop.address) << " by " << Location(state, stop.at) << '\n';
+                break;
+
+            case chip8::StopReason::Frame:
+                std::cout << "Frame " << debugger.GetFrame() << '\n';
+                break;
+
+            case chip8::StopReason::Step:
+            case chip8::StopReason::None:
+                break;
+            }
+
+            std::cout << "=> " << Location(state, state.pc) << '\n';
+        }
+
+        chip8::Chip8 &chip;
+        chip8::Debugger debugger;
+        const Options &options;
+
+        /**
+         * @brief Scratch state for inspecting the machine.
+         */
+        chip8::Snapshot state{};
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        if (!std::filesystem::exists(options.romPath))
+        {
+            std::cerr << "Error: File does not exist: " << options.romPath << std::endl;
+            return 1;
+        }
+
+        auto chip = std::make_unique<chip8::Chip8>(options.profile);
+        chip->loadROM(options.romPath);
+        chip->SetEngine(options.engine);
+        chip->SetSeed(options.seed);
+
+        Console console(*chip, options);
+        std::cout << "Type help for the commands." << std::endl;
+
+        for (std::string line; std::cout << "(chip8) " << std::flush, std::getline(std::cin, line);)
+        {
+            // A bad command or a guest error must not end the session
+            try
+            {
+                if (!console.Execute(line))
+                {
+                    break;
+                }
+            }
+
+            catch (const std::exception &e)
+            {
+                std::cout << "Error: " << e.what() << '\n';
+            }
+        }
+
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,377 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Fuzz.hpp"
+#include "Random.hpp"
+#include "RomLibrary.hpp"
+
+namespace
+{
+    chip8::Profile fuzzProfile = chip8::Profile::Modern;
+    std::uint64_t fuzzCycles = chip8::FuzzHarness::DEFAULT_CYCLE_BUDGET;
+    bool fuzzReportWraps = false;
+
+    /**
+     * @brief Harness shared by every execution, built on first use so the options apply.
+     */
+    chip8::FuzzHarness &GetHarness()
+    {
+        static chip8::FuzzHarness harness(fuzzProfile, fuzzCycles, fuzzReportWraps);
+        return harness;
+    }
+
+    void PrintFinding(const chip8::FuzzResult &result)
+    {
+        std::cerr << "Finding: " << chip8::FindingName(result.finding) << " at 0x" << std::hex << std::uppercase
+                  << std::setw(3) << std::setfill('0') << result.pc << " (" << std::setw(4) << result.opcode
+                  << ") after " << std::dec << result.cycles << " cycles" << std::endl;
+    }
+}
+
+// libFuzzer entry points; a finding aborts so the fuzzer saves the input
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    for (int i = 1; i < *argc; ++i)
+    {
+        const char *arg = (*argv)[i];
+
+        if (std::strncmp(arg, "--cycles=", 9) == 0)
+        {
+            fuzzCycles = std::strtoull(arg + 9, nullptr, 0);
+        }
+        else if (std::strncmp(arg, "--profile=", 10) == 0 && !chip8::ParseProfile(arg + 10, fuzzProfile))
+        {
+            std::cerr << "Unknown profile: " << arg + 10 << std::endl;
+            std::exit(1);
+        }
+        else if (std::strcmp(arg, "--report-wraps") == 0)
+        {
+            fuzzReportWraps = true;
+        }
+    }
+
+    // The harness is built on first use, where a bad budget could only terminate
+    if (fuzzCycles == 0)
+    {
+        std::cerr << "Cycle budget must be positive" << std::endl;
+        std::exit(1);
+    }
+
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    const chip8::FuzzResult result = GetHarness().Run(data, size);
+
+    if (result.finding != chip8::Finding::None)
+    {
+        PrintFinding(result);
+        std::abort();
+    }
+
+    return 0;
+}
+
+#if !CHIP8_LIBFUZZER
+namespace
+{
+    struct Options
+    {
+        std::vector<std::string> inputs;
+        double seconds = 0.0;   ///< 0 replays the inputs, or fuzzes for 10 s without any.
+        std::uint64_t seed = chip8::DEFAULT_SEED;
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [FILE|DIR...] [--seconds N] [--cycles N] [--profile modern|vip|schip]"
+                  << " [--seed N] [--report-wraps]" << std::endl
+                  << "Replays the inputs, or with --seconds fuzzes with random mutations of them" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--seconds" && i + 1 < argc)
+            {
+                options.seconds = std::stod(argv[++i]);
+                if (options.seconds <= 0)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--cycles" && i + 1 < argc)
+            {
+                fuzzCycles = std::stoull(argv[++i], nullptr, 0);
+            }
+            else if (arg == "--profile" && i + 1 < argc)
+            {
+                if (!chip8::ParseProfile(argv[++i], fuzzProfile))
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--seed" && i + 1 < argc)
+            {
+                options.seed = std::stoull(argv[++i], nullptr, 0);
+            }
+            else if (arg == "--report-wraps")
+            {
+                fuzzReportWraps = true;
+            }
+            else if (arg.rfind("--", 0) != 0)
+            {
+                options.inputs.push_back(arg);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return fuzzCycles != 0;
+    }
+
+    std::vector<std::uint8_t> ReadInput(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Input couldn't be opened: " + path.string());
+        }
+
+        return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    /**
+     * @brief Collects the files given directly or inside the given directories.
+     */
+    std::vector<std::filesystem::path> ListInputs(const std::vector<std::string> &inputs)
+    {
+        std::vector<std::filesystem::path> paths;
+
+        for (const std::string &input : inputs)
+        {
+            if (std::filesystem::is_directory(input))
+            {
+                for (const auto &entry : std::filesystem::directory_iterator(input))
+                {
+                    if (entry.is_regular_file())
+                    {
+                        paths.push_back(entry.path());
+                    }
+                }
+            }
+            else
+            {
+                paths.emplace_back(input);
+            }
+        }
+
+        return paths;
+    }
+
+    int Replay(const std::vector<std::filesystem::path> &paths)
+    {
+        int findings = 0;
+
+        for (const std::filesystem::path &path : paths)
+        {
+            const std::vector<std::uint8_t> input = ReadInput(path);
+            const chip8::FuzzResult result = GetHarness().Run(input.data(), input.size());
+
+            std::cout << path.string() << ": " << result.cycles << " cycles"
+                      << (result.guestError ? ", guest error" : "") << std::endl;
+
+            if (result.finding != chip8::Finding::None)
+            {
+                PrintFinding(result);
+                ++findings;
+            }
+        }
+
+        return findings == 0 ? 0 : 1;
+    }
+
+    /**
+     * @brief Applies one random edit: flip a bit, set a byte, insert, erase or plant an opcode.
+     */
+    void Mutate(std::vector<std::uint8_t> &input, chip8::RandomState &rng)
+    {
+        const std::size_t limit = 1 + 255 * 3 + chip8::MAX_ROM_SIZE;
+        const std::size_t at = input.empty() ? 0 : chip8::NextRandom(rng) % input.size();
+
+        switch (chip8::NextRandom(rng) % 5)
+        {
+        case 0:
+            if (!input.empty())
+            {
+                input[at] ^= static_cast<std::uint8_t>(1u << (chip8::NextRandom(rng) & 7));
+            }
+            break;
+
+        case 1:
+            if (!input.empty())
+            {
+                input[at] = static_cast<std::uint8_t>(chip8::NextRandom(rng));
+            }
+            break;
+
+        case 2:
+            if (input.size() < limit)
+            {
+                input.insert(input.begin() + at, static_cast<std::uint8_t>(chip8::NextRandom(rng)));
+            }
+            break;
+
+        case 3:
+            if (input.size() > 1)
+            {
+                input.erase(input.begin() + at);
+            }
+            break;
+
+        default:
+            // Whole instructions reach the interesting opcodes far sooner than single bytes
+            if (input.size() >= 2 && input.size() < limit)
+            {
+                const std::uint32_t opcode = chip8::NextRandom(rng);
+                input.insert(input.begin() + at,
+                             {static_cast<std::uint8_t>(opcode >> 8), static_cast<std::uint8_t>(opcode)});
+            }
+            break;
+        }
+    }
+
+    std::string HashName(const std::vector<std::uint8_t> &input)
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (std::uint8_t byte : input)
+        {
+            hash = (hash ^ byte) * 0x100000001B3ull;
+        }
+
+        std::ostringstream name;
+        name << "finding-" << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return name.str();
+    }
+
+    int Fuzz(std::vector<std::vector<std::uint8_t>> corpus, double seconds, std::uint64_t seed)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        if (corpus.empty())
+        {
+            // No script, and a ROM of one jump to itself
+            corpus.push_back({0x00, 0x12, 0x00});
+        }
+
+        chip8::RandomState rng = chip8::SeedRandom(seed);
+        chip8::FuzzHarness &harness = GetHarness();
+        std::uint64_t findings = 0;
+        std::uint64_t cycles = 0;
+
+        // One input is saved per kind of finding and instruction, mutations hit the same ones over and over
+        std::set<std::uint64_t> sites;
+
+        const Clock::time_point start = Clock::now();
+        const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(
+                                                  std::chrono::duration<double>(seconds));
+
+        std::vector<std::uint8_t> input;
+        for (Clock::time_point now = start; now < end; now = Clock::now())
+        {
+            // The clock is read once per batch, it would cost more than a short execution
+            for (int batch = 0; batch < 256; ++batch)
+            {
+                input = corpus[chip8::NextRandom(rng) % corpus.size()];
+                for (std::uint32_t edits = 1 + chip8::NextRandom(rng) % 8; edits > 0; --edits)
+                {
+                    Mutate(input, rng);
+                }
+
+                const chip8::FuzzResult result = harness.Run(input.data(), input.size());
+                cycles += result.cycles;
+
+                if (result.finding == chip8::Finding::None)
+                {
+                    continue;
+                }
+
+                ++findings;
+
+                const std::uint64_t site = static_cast<std::uint64_t>(result.finding) << 32 | result.pc << 16 |
+                                           result.opcode;
+                if (sites.insert(site).second)
+                {
+                    const std::string name = HashName(input);
+                    std::ofstream(name, std::ios::binary).write(reinterpret_cast<const char *>(input.data()),
+                                                                static_cast<std::streamsize>(input.size()));
+                    PrintFinding(result);
+                    std::cerr << "Saved " << name << std::endl;
+                }
+            }
+        }
+
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "Executions: " << harness.GetExecutions() << " in " << std::fixed << std::setprecision(1)
+                  << elapsed << " s (" << std::setprecision(0) << harness.GetExecutions() / elapsed << " exec/s, "
+                  << std::setprecision(1) << cycles / elapsed / 1e6 << " M cycles/s)" << std::endl
+                  << "Findings: " << findings << " at " << sites.size() << " distinct instructions" << std::endl;
+
+        return findings == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        const std::vector<std::filesystem::path> paths = ListInputs(options.inputs);
+
+        if (options.seconds == 0 && !paths.empty())
+        {
+            return Replay(paths);
+        }
+
+        std::vector<std::vector<std::uint8_t>> corpus;
+        for (const std::filesystem::path &path : paths)
+        {
+            corpus.push_back(ReadInput(path));
+        }
+
+        return Fuzz(std::move(corpus), options.seconds == 0 ? 10.0 : options.seconds, options.seed);
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+#endif
@@ -0,0 +1,293 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "Capture.hpp"
+#include "Chip8.hpp"
+#include "Movie.hpp"
+#include "display/NullDisplay.hpp"
+
+namespace
+{
+    struct Options
+    {
+        std::string romPath;
+        std::uint64_t cycles = 0;
+        std::uint64_t frames = 0;
+        std::uint64_t cyclesPerFrame = 10;
+        chip8::Engine engine = chip8::Engine::Interpreter;
+        chip8::Profile profile = chip8::Profile::Modern;
+        std::string loadStatePath;
+        std::string saveStatePath;
+        std::string replayPath;
+        std::string capturePath;
+        std::uint64_t seed = chip8::DEFAULT_SEED;
+        bool stats = false;
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " <ROM_file> [--cycles N | --frames N] [--cycles-per-frame N]"
+                  << " [--engine interpreter|blocks|jit|aot] [--profile modern|vip|schip] [--seed N]"
+                  << " [--load-state FILE] [--save-state FILE] [--capture FILE] [--stats]" << std::endl
+                  << "       " << program << " <ROM_file> --replay MOVIE [--engine interpreter|blocks|jit|aot]"
+                  << " [--profile modern|vip|schip] [--stats]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--engine" && i + 1 < argc)
+            {
+                if (!chip8::ParseEngine(argv[++i], options.engine))
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--profile" && i + 1 < argc)
+            {
+                if (!chip8::ParseProfile(argv[++i], options.profile))
+                {
+                    return false;
+                }
+            }
+            else if (arg == "--load-state" && i + 1 < argc)
+            {
+                options.loadStatePath = argv[++i];
+            }
+            else if (arg == "--save-state" && i + 1 < argc)
+            {
+                options.saveStatePath = argv[++i];
+            }
+            else if (arg == "--capture" && i + 1 < argc)
+            {
+                options.capturePath = argv[++i];
+            }
+            else if (arg == "--replay" && i + 1 < argc)
+            {
+                options.replayPath = argv[++i];
+            }
+            else if (arg == "--stats")
+            {
+                options.stats = true;
+            }
+            else if (arg == "--seed" && i + 1 < argc)
+            {
+                options.seed = std::stoull(argv[++i], nullptr, 0);
+            }
+            else if ((arg == "--cycles" || arg == "--frames" || arg == "--cycles-per-frame") && i + 1 < argc)
+            {
+                const std::uint64_t value = std::stoull(argv[++i]);
+
+                if (arg == "--cycles")
+                    options.cycles = value;
+                else if (arg == "--frames")
+                    options.frames = value;
+                else
+                    options.cyclesPerFrame = value;
+            }
+            else if (options.romPath.empty() && arg.rfind("--", 0) != 0)
+            {
+                options.romPath = arg;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        if (options.romPath.empty() || options.cyclesPerFrame == 0 ||
+            options.cyclesPerFrame > std::numeric_limits<std::uint32_t>::max() / chip8::Chip8::TIMER_RATE)
+        {
+            return false;
+        }
+
+        if (options.cycles == 0 && options.frames == 0)
+        {
+            options.frames = 600;
+        }
+
+        if (options.cycles == 0)
+        {
+            options.cycles = options.frames * options.cyclesPerFrame;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Runs the chip at full host speed, cyclesPerFrame cycles per emulated frame.
+     * @param capture Receives the screen of every frame, or nullptr.
+     * @return Number of frames completed.
+     */
+    std::uint64_t Run(display::IDisplay &display, chip8::IChip &chip, const Options &options,
+                      chip8::CaptureWriter *capture)
+    {
+        std::uint64_t frames = 0;
+        std::uint64_t executed = 0;
+
+        while (executed < options.cycles && display.IsRunning())
+        {
+            std::uint64_t batch = options.cycles - executed;
+            if (batch > options.cyclesPerFrame)
+            {
+                batch = options.cyclesPerFrame;
+            }
+
+            executed += chip.emulateCycles(batch);
+
+            if (batch < options.cyclesPerFrame)
+            {
+                break;
+            }
+
+            if (capture != nullptr)
+            {
+                // Nothing paces the run, so the writer paces it instead of dropping frames
+                capture->Push(chip.GetGfx(), true);
+            }
+
+            if (chip.ShouldDraw() && display.Render(chip.GetGfx(), chip.GetDirtyRows()))
+            {
+                chip.ClearDrawFlag();
+            }
+
+            display.HandleEvents(chip.GetKeypad());
+            ++frames;
+        }
+
+        return frames;
+    }
+
+    /**
+     * @brief Replays a movie at full host speed and checks that it ends in the recorded state.
+     * @return Process exit code, 0 if the final state matches.
+     */
+    int Replay(chip8::IChip &chip, const Options &options)
+    {
+        const chip8::Movie movie = chip8::ReadMovie(options.replayPath);
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::uint64_t hash = chip8::ReplayMovie(chip, movie);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const double seconds = elapsed.count() > 0.0 ? elapsed.count() : 1e-9;
+        const bool match = hash == movie.finalHash;
+
+        std::cout << "Engine: " << chip8::EngineName(options.engine) << '\n'
+                  << "Profile: " << chip8::ProfileName(options.profile) << '\n'
+                  << "Cycles: " << movie.cycles << " (" << movie.events.size() << " input events)\n"
+                  << "Time: " << seconds * 1000.0 << " ms\n"
+                  << "Speed: " << movie.cycles / seconds / 1e6 << " MIPS\n"
+                  << "Replay: " << (match ? "match" : "MISMATCH") << " (final state " << std::hex << hash
+                  << ", recorded " << movie.finalHash << std::dec << ")" << std::endl;
+
+        if (options.stats)
+        {
+            chip8::PrintPerfCounters(std::cout, chip.GetPerfCounters());
+        }
+
+        return match ? 0 : 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        if (!std::filesystem::exists(options.romPath))
+        {
+            std::cerr << "Error: File does not exist: " << options.romPath << std::endl;
+            return 1;
+        }
+
+        display::NullDisplay display;
+        auto chip = std::make_unique<chip8::Chip8>(options.profile);
+        chip->loadROM(options.romPath);
+        chip->SetEngine(options.engine);
+
+        if (!options.replayPath.empty())
+        {
+            return Replay(*chip, options);
+        }
+
+        chip->SetSeed(options.seed);
+
+        if (!options.loadStatePath.empty())
+        {
+            chip->LoadState(chip8::ReadSnapshot(options.loadStatePath));
+        }
+
+        // One emulated frame is one timer tick
+        const std::uint32_t clockRate = static_cast<std::uint32_t>(options.cyclesPerFrame * chip8::Chip8::TIMER_RATE);
+        if (chip->GetClockRate() != clockRate)
+        {
+            chip->SetClockRate(clockRate);
+        }
+
+        std::unique_ptr<chip8::CaptureWriter> capture;
+        if (!options.capturePath.empty())
+        {
+            capture = std::make_unique<chip8::CaptureWriter>(options.capturePath);
+        }
+
+        const std::uint64_t startCycles = chip->GetCycleCount();
+        const auto start = std::chrono::steady_clock::now();
+        const std::uint64_t frames = Run(display, *chip, options, capture.get());
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const std::uint64_t cycles = chip->GetCycleCount() - startCycles;
+        const double seconds = elapsed.count() > 0.0 ? elapsed.count() : 1e-9;
+
+        std::cout << "Engine: " << chip8::EngineName(options.engine) << '\n'
+                  << "Profile: " << chip8::ProfileName(options.profile) << '\n'
+                  << "Cycles: " << cycles << '\n'
+                  << "Frames: " << frames << " (" << display.GetRenderCount() << " rendered)\n"
+                  << "Time: " << seconds * 1000.0 << " ms\n"
+                  << "Speed: " << cycles / seconds / 1e6 << " MIPS" << std::endl;
+
+        if (options.stats)
+        {
+            chip8::PrintPerfCounters(std::cout, chip->GetPerfCounters());
+        }
+
+        if (capture)
+        {
+            capture->Close();
+            const chip8::CaptureStats captureStats = capture->GetStats();
+            std::cout << "Capture written: " << options.capturePath << " (" << captureStats.frames << " frames, "
+                      << captureStats.BytesPerFrame() << " bytes per frame, " << captureStats.droppedFrames
+                      << " dropped)" << std::endl;
+        }
+
+        if (!options.saveStatePath.empty())
+        {
+            chip8::Snapshot snapshot;
+            chip->SaveState(snapshot);
+            chip8::WriteSnapshot(options.saveStatePath, snapshot);
+            std::cout << "State saved: " << options.saveStatePath << std::endl;
+        }
+
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
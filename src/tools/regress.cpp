@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Chip8.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct Options
+    {
+        std::vector<fs::path> roms;
+        fs::path goldenDir;
+        std::uint64_t frames = 600;
+        std::uint64_t cyclesPerFrame = 10;
+        chip8::Engine engine = chip8::Engine::Interpreter;
+        unsigned jobs = 0;
+        bool update = false;
+    };
+
+    /**
+     * @brief Scripted key change applied before the given frame runs.
+     */
+    struct KeyEvent
+    {
+        std::uint64_t frame;
+        std::uint8_t key;
+        bool pressed;
+    };
+
+    enum class Status
+    {
+        Pass,
+        Fail,
+        Missing,
+        Updated,
+        Error,
+    };
+
+    struct Result
+    {
+        Status status = Status::Error;
+        std::uint64_t frames = 0;
+        std::uint64_t cycles = 0;
+        std::uint64_t firstDivergence = 0;
+        std::string message;
+    };
+
+    /**
+     * @class WorkStealingPool
+     * @brief Fixed set of workers, each draining its own deque and stealing
+     * from the others once it runs dry.
+     */
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(unsigned workers) : queues(workers)
+        {
+        }
+
+        /**
+         * @brief Runs job(index) for every index below count and waits for all of them.
+         */
+        void Run(std::size_t count, const std::function<void(std::size_t)> &job)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                queues[i % queues.size()].jobs.push_back(i);
+            }
+
+            std::vector<std::thread> threads;
+            for (unsigned worker = 0; worker < queues.size(); ++worker)
+            {
+                threads.emplace_back([this, worker, &job]
+                                     { work(worker, job); });
+            }
+
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        std::uint64_t GetStealCount() const
+        {
+            return steals;
+        }
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::size_t> jobs;
+        };
+
+        void work(unsigned worker, const std::function<void(std::size_t)> &job)
+        {
+            std::size_t index;
+            while (popOwn(worker, index) || steal(worker, index))
+            {
+                job(index);
+            }
+        }
+
+        bool popOwn(unsigned worker, std::size_t &index)
+        {
+            Queue &queue = queues[worker];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.jobs.empty())
+            {
+                return false;
+            }
+
+            index = queue.jobs.back();
+            queue.jobs.pop_back();
+            return true;
+        }
+
+        // No job adds new jobs, so once every queue is empty the work is done
+        bool steal(unsigned worker, std::size_t &index)
+        {
+            for (std::size_t offset = 1; offset < queues.size(); ++offset)
+            {
+                Queue &victim = queues[(worker + offset) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+
+                if (!victim.jobs.empty())
+                {
+                    index = victim.jobs.front();
+                    victim.jobs.pop_front();
+                    ++steals;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        std::vector<Queue> queues;
+        std::atomic<std::uint64_t> steals{0};
+    };
+
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " <ROM_file|directory>... [--frames N] [--cycles-per-frame N]"
+                  << " [--engine interpreter|blocks|jit|aot] [--jobs N] [--golden DIR] [--update]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--engine" && i + 1 < argc)
+            {
+                if (!chip8::ParseEngine(argv[++i], options.engine))
+                {
+                    return false;
+                }
+            }
+            else if ((arg == "--frames" || arg == "--cycles-per-frame" || arg == "--jobs") && i + 1 < argc)
+            {
+                const std::uint64_t value = std::stoull(argv[++i]);
+
+                if (arg == "--frames")
+                    options.frames = value;
+                else if (arg == "--cycles-per-frame")
+                    options.cyclesPerFrame = value;
+                else
+                    options.jobs = static_cast<unsigned>(value);
+            }
+            else if (arg == "--golden" && i + 1 < argc)
+            {
+                options.goldenDir = argv[++i];
+            }
+            else if (arg == "--update")
+            {
+                options.update = true;
+            }
+            else if (arg.rfind("--", 0) != 0)
+            {
+                if (fs::is_directory(arg))
+                {
+                    for (const fs::directory_entry &entry : fs::recursive_directory_iterator(arg))
+                    {
+                        if (entry.is_regular_file() && entry.path().extension() == ".ch8")
+                        {
+                            options.roms.push_back(entry.path());
+                        }
+                    }
+                }
+                else
+                {
+                    options.roms.emplace_back(arg);
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        if (options.roms.empty() || options.frames == 0 || options.cyclesPerFrame == 0 ||
+            options.cyclesPerFrame > std::numeric_limits<std::uint32_t>::max() / chip8::Chip8::TIMER_RATE)
+        {
+            return false;
+        }
+
+        if (options.jobs == 0)
+        {
+            options.jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        std::sort(options.roms.begin(), options.roms.end());
+        return true;
+    }
+
+    fs::path GoldenPath(const fs::path &rom, const Options &options)
+    {
+        if (options.goldenDir.empty())
+        {
+            return fs::path(rom).replace_extension(".golden");
+        }
+
+        return options.goldenDir / rom.filename().replace_extension(".golden");
+    }
+
+    /**
+     * @brief Reads the key script next to a ROM (<rom>.keys), if any.
+     * One event per line: "<frame> <key 0-F> down|up"; '#' starts a comment.
+     */
+    std::vector<KeyEvent> LoadKeyScript(const fs::path &rom)
+    {
+        std::vector<KeyEvent> events;
+        std::ifstream file(fs::path(rom).replace_extension(".keys"));
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line = line.substr(0, line.find('#'));
+            std::istringstream fields(line);
+
+            std::uint64_t frame;
+            std::string key, state;
+            if (!(fields >> frame >> key >> state))
+            {
+                continue;
+            }
+
+            if (key.size() != 1 || !std::isxdigit(static_cast<unsigned char>(key[0])) || (state != "down" && state != "up"))
+            {
+                throw std::runtime_error("Invalid key script line: " + line);
+            }
+
+            events.push_back({frame, static_cast<std::uint8_t>(std::stoi(key, nullptr, 16)), state == "down"});
+        }
+
+        std::stable_sort(events.begin(), events.end(), [](const KeyEvent &a, const KeyEvent &b)
+                         { return a.frame < b.frame; });
+        return events;
+    }
+
+    /**
+     * @brief Reads golden frame hashes, one hex value per line.
+     * The "# cycles-per-frame N" header must match the current run.
+     * @return false if the file does not exist.
+     */
+    bool LoadGolden(const fs::path &path, const Options &options, std::vector<std::uint64_t> &hashes)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty())
+            {
+                continue;
+            }
+
+            if (line[0] == '#')
+            {
+                std::istringstream fields(line.substr(1));
+                std::string key;
+                std::uint64_t value;
+
+                if (fields >> key >> value && key == "cycles-per-frame" && value != options.cyclesPerFrame)
+                {
+                    throw std::runtime_error("golden recorded with --cycles-per-frame " + std::to_string(value));
+                }
+                continue;
+            }
+
+            hashes.push_back(std::stoull(line, nullptr, 16));
+        }
+
+        return true;
+    }
+
+    void WriteGolden(const fs::path &path, const Options &options, const std::vector<std::uint64_t> &hashes)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Golden file couldn't be written: " + path.string());
+        }
+
+        file << "# cycles-per-frame " << options.cyclesPerFrame << '\n';
+        file << std::hex;
+        for (const std::uint64_t hash : hashes)
+        {
+            file << hash << '\n';
+        }
+    }
+
+    /**
+     * @brief Runs one ROM for options.frames frames and checks every frame against its golden hashes.
+     */
+    Result RunRom(const fs::path &rom, const Options &options)
+    {
+        Result result;
+
+        try
+        {
+            std::ifstream file(rom, std::ios::binary);
+            const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (!file.good() && !file.eof())
+            {
+                throw std::runtime_error("ROM couldn't be read");
+            }
+
+            const std::vector<KeyEvent> events = LoadKeyScript(rom);
+
+            std::vector<std::uint64_t> golden;
+            const fs::path goldenPath = GoldenPath(rom, options);
+            const bool hasGolden = LoadGolden(goldenPath, options, golden);
+
+            auto chip = std::make_unique<chip8::Chip8>();
+            chip->loadROM(data.data(), data.size());
+            chip->SetEngine(options.engine);
+            chip->SetClockRate(static_cast<std::uint32_t>(options.cyclesPerFrame * chip8::Chip8::TIMER_RATE));
+
+            std::vector<std::uint64_t> hashes;
+            hashes.reserve(options.frames);
+            bool diverged = false;
+            std::size_t nextEvent = 0;
+
+            for (std::uint64_t frame = 0; frame < options.frames; ++frame)
+            {
+                while (nextEvent < events.size() && events[nextEvent].frame <= frame)
+                {
+                    chip->GetKeypad()[events[nextEvent].key] = events[nextEvent].pressed ? 1 : 0;
+                    ++nextEvent;
+                }
+
+                try
+                {
+                    chip->emulateCycles(options.cyclesPerFrame);
+                }
+                catch (const std::exception &e)
+                {
+                    throw std::runtime_error("frame " + std::to_string(frame) + ": " + e.what());
+                }
+
+                hashes.push_back(chip8::HashFrame(chip->GetGfx()));
+                result.frames = frame + 1;
+
+                if (hasGolden && !diverged && (frame >= golden.size() || golden[frame] != hashes.back()))
+                {
+                    diverged = true;
+                    result.firstDivergence = frame;
+
+                    // Without --update nothing past the first divergence is needed
+                    if (!options.update)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            result.cycles = chip->GetCycleCount();
+
+            if (options.update)
+            {
+                if (!hasGolden || diverged || golden.size() != hashes.size())
+                {
+                    WriteGolden(goldenPath, options, hashes);
+                    result.status = Status::Updated;
+                }
+                else
+                {
+                    result.status = Status::Pass;
+                }
+            }
+            else if (!hasGolden)
+            {
+                result.status = Status::Missing;
+            }
+            else
+            {
+                result.status = diverged ? Status::Fail : Status::Pass;
+            }
+        }
+
+        catch (const std::exception &e)
+        {
+            result.status = Status::Error;
+            result.message = e.what();
+        }
+
+        return result;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+
+    try
+    {
+        if (!ParseOptions(argc, argv, options))
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Result> results(options.roms.size());
+    WorkStealingPool pool(options.jobs);
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.Run(options.roms.size(), [&](std::size_t index)
+             { results[index] = RunRom(options.roms[index], options); });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::uint64_t counts[5] = {};
+    std::uint64_t frames = 0;
+    std::uint64_t cycles = 0;
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &result = results[i];
+        ++counts[static_cast<int>(result.status)];
+        frames += result.frames;
+        cycles += result.cycles;
+
+        switch (result.status)
+        {
+        case Status::Fail:
+            std::cout << "FAIL    " << options.roms[i].string() << ": first diverging frame " << result.firstDivergence << '\n';
+            break;
+        case Status::Missing:
+            std::cout << "MISSING " << options.roms[i].string() << ": no golden file (run with --update)\n";
+            break;
+        case Status::Updated:
+            std::cout << "UPDATED " << options.roms[i].string() << '\n';
+            break;
+        case Status::Error:
+            std::cout << "ERROR   " << options.roms[i].string() << ": " << result.message << '\n';
+            break;
+        case Status::Pass:
+            break;
+        }
+    }
+
+    const double seconds = elapsed.count() > 0.0 ? elapsed.count() : 1e-9;
+
+    std::cout << "ROMs: " << results.size() << " (" << counts[static_cast<int>(Status::Pass)] << " passed, "
+              << counts[static_cast<int>(Status::Fail)] << " failed, "
+              << counts[static_cast<int>(Status::Error)] << " errors, "
+              << counts[static_cast<int>(Status::Missing)] << " missing, "
+              << counts[static_cast<int>(Status::Updated)] << " updated)\n"
+              << "Engine: " << chip8::EngineName(options.engine) << ", " << options.frames << " frames x "
+              << options.cyclesPerFrame << " cycles\n"
+              << "Workers: " << options.jobs << " (" << pool.GetStealCount() << " steals)\n"
+              << "Time: " << seconds * 1000.0 << " ms\n"
+              << "Throughput: " << frames / seconds << " frames/s, " << cycles / seconds / 1e6 << " MIPS, "
+              << cycles / seconds / 1e6 / options.jobs << " MIPS per core" << std::endl;
+
+    const bool failed = counts[static_cast<int>(Status::Fail)] + counts[static_cast<int>(Status::Error)] +
+                            counts[static_cast<int>(Status::Missing)] >
+                        0;
+    return failed ? 1 : 0;
+}
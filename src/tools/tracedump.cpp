@@ -0,0 +1,104 @@
+#include <iostream>
+#include <string>
+
+#include "Disassembler.hpp"
+#include "trace/TraceBuffer.hpp"
+
+namespace
+{
+    /**
+     * @brief Prints a record in the format of the former per-instruction log.
+     */
+    void PrintRecord(const trace::TraceRecord &record, bool verbose)
+    {
+        const std::uint16_t opcode = record.opcode;
+
+        std::cout << "PC: " << std::hex << record.pc << " Opcode: 0x" << opcode << std::dec << '\n';
+
+        if (verbose)
+        {
+            std::cout << "Cycle: " << record.cycle << " I: " << chip8::ToHex(record.I);
+            if (record.reg != trace::NO_REGISTER)
+            {
+                std::cout << " V" << +record.reg << " = " << +record.value;
+            }
+            std::cout << '\n';
+        }
+
+        switch (opcode & 0xF000)
+        {
+        case 0x1000: // jumps were never logged
+            return;
+
+        case 0xB000:
+            std::cout << "Instruction: JP " << chip8::ToHex(opcode & 0x0FFF) << '\n';
+            return;
+
+        case 0xD000:
+            std::cout << chip8::Disassemble(opcode) << " → sprite\n";
+            return;
+
+        case 0xF000:
+            std::cout << "Subcode: " << chip8::ToHex(opcode & 0x00FF) << '\n';
+            break;
+
+        default:
+            break;
+        }
+
+        std::cout << "Instruction: " << chip8::Disassemble(opcode);
+
+        if (opcode == 0x00E0)
+        {
+            std::cout << " (clean the view)";
+        }
+
+        else if ((opcode & 0xF0FF) == 0xF029)
+        {
+            std::cout << " → I = " << chip8::ToHex(record.I);
+        }
+
+        std::cout << '\n';
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bool verbose = false;
+        std::string dumpPath;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "-v" || arg == "--verbose")
+            {
+                verbose = true;
+            }
+            else
+            {
+                dumpPath = arg;
+            }
+        }
+
+        if (dumpPath.empty())
+        {
+            std::cerr << "Usage: " << argv[0] << " [-v] <trace_dump>" << std::endl;
+            return 1;
+        }
+
+        for (const auto &record : trace::ReadDump(dumpPath))
+        {
+            PrintRecord(record, verbose);
+        }
+
+        return 0;
+    }
+
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
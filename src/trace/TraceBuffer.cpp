@@ -0,0 +1,114 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "trace/TraceBuffer.hpp"
+
+namespace
+{
+    constexpr char DUMP_MAGIC[4] = {'C', '8', 'T', 'R'};
+    constexpr std::uint32_t DUMP_VERSION = 1;
+
+    struct DumpHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t recordSize;
+        std::uint32_t reserved;
+        std::uint64_t count;
+    };
+}
+
+namespace trace
+{
+    TraceBuffer::TraceBuffer(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    std::vector<TraceRecord> TraceBuffer::Snapshot() const
+    {
+        const std::uint64_t total = head.load(std::memory_order_acquire);
+        const std::uint64_t count = total < slots.size() ? total : slots.size();
+
+        std::vector<TraceRecord> records;
+        records.reserve(count);
+
+        for (std::uint64_t i = total - count; i < total; ++i)
+        {
+            records.push_back(slots[i & mask]);
+        }
+
+        return records;
+    }
+
+    void WriteDump(const std::string &filename, const std::vector<TraceRecord> &records)
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Trace dump couldn't be created: " + filename);
+        }
+
+        DumpHeader header{};
+        std::memcpy(header.magic, DUMP_MAGIC, sizeof(DUMP_MAGIC));
+        header.version = DUMP_VERSION;
+        header.recordSize = sizeof(TraceRecord);
+        header.count = records.size();
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(records.data()),
+                   static_cast<std::streamsize>(records.size() * sizeof(TraceRecord)));
+    }
+
+    std::vector<TraceRecord> ReadDump(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Trace dump couldn't be opened: " + filename);
+        }
+
+        DumpHeader header{};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+        if (!file || std::memcmp(header.magic, DUMP_MAGIC, sizeof(DUMP_MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not a trace dump: " + filename);
+        }
+
+        if (header.version != DUMP_VERSION || header.recordSize != sizeof(TraceRecord))
+        {
+            throw std::runtime_error("Unsupported trace dump version: " + std::to_string(header.version));
+        }
+
+        // The count is checked against the file before it sizes an allocation
+        const std::streampos start = file.tellg();
+        file.seekg(0, std::ios::end);
+        const std::uint64_t remaining = static_cast<std::uint64_t>(file.tellg() - start);
+        file.seekg(start);
+
+        if (!file || header.count > remaining / sizeof(TraceRecord))
+        {
+            throw std::runtime_error("Truncated trace dump: " + filename);
+        }
+
+        std::vector<TraceRecord> records(header.count);
+        file.read(reinterpret_cast<char *>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(TraceRecord)));
+
+        if (!file)
+        {
+            throw std::runtime_error("Truncated trace dump: " + filename);
+        }
+
+        return records;
+    }
+}